@@ -345,6 +345,14 @@ class ColumnFamilyData {
       const std::unordered_map<std::string, std::string>& options_map);
 #endif  // ROCKSDB_LITE
 
+  // for FEAT
+  // REQUIRES: DB mutex held
+  // Installs already validated mutable options, see DBImpl::ApplyTuningUpdate
+  void SetMutableCFOptions(const MutableCFOptions& mutable_cf_options) {
+    mutable_cf_options_ = mutable_cf_options;
+    mutable_cf_options_.RefreshDerivedOptions(ioptions_);
+  }
+
   InternalStats* internal_stats() { return internal_stats_.get(); }
 
   MemTableList* imm() { return &imm_; }
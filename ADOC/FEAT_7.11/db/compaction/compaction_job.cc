@@ -1984,6 +1984,14 @@ Env::IOPriority CompactionJob::GetRateLimiterPriority() {
       return Env::IO_USER;
     }
   }
+  // for FEAT, a foreground-aware rate limiter throttles IO_LOW by the client
+  // write rate. L0 compactions go as IO_MID so they keep up with the flushes
+  // and only the deeper compactions back off at a load peak.
+  if (db_options_.rate_limiter != nullptr &&
+      db_options_.rate_limiter->IsForegroundAware() &&
+      compact_->compaction->start_level() == 0) {
+    return Env::IO_MID;
+  }
 
   return Env::IO_LOW;
 }
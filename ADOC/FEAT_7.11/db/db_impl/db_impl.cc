@@ -1050,6 +1050,7 @@ void DBImpl::DumpStats() {
   }
 
   TEST_SYNC_POINT("DBImpl::DumpStats:StartRunning");
+  RecordThreadPoolUtilization();
   {
     InstrumentedMutexLock l(&mutex_);
     for (auto cfd : versions_->GetRefedColumnFamilySet()) {
@@ -1397,6 +1398,243 @@ Status DBImpl::SetDBOptions(
 #endif  // ROCKSDB_LITE
 }
 
+// for FEAT
+Status DBImpl::ApplyTuningUpdate(const TuningUpdate& update) {
+  // 先整体检查，任何一项不合法都不改，免得只生效一半
+  if (update.max_background_jobs < 0) {
+    return Status::InvalidArgument("max_background_jobs must be >= 0");
+  }
+  if (update.rate_limiter_bytes_per_sec < 0) {
+    return Status::InvalidArgument("rate_limiter_bytes_per_sec must be >= 0");
+  }
+  // Same range SanitizeOptions() clips write_buffer_size to
+  const uint64_t max_write_buffer_size =
+      sizeof(size_t) == 4 ? 0xffffffff : 64ull << 30;
+  for (const auto& cf_update : update.column_families) {
+    if (cf_update.write_buffer_size != 0 &&
+        (cf_update.write_buffer_size < (64u << 10) ||
+         cf_update.write_buffer_size > max_write_buffer_size)) {
+      return Status::InvalidArgument(
+          "write_buffer_size out of range for column family " +
+          std::to_string(cf_update.cf_id));
+    }
+    if (cf_update.max_bytes_for_level_base != 0 &&
+        cf_update.target_file_size_base > cf_update.max_bytes_for_level_base) {
+      return Status::InvalidArgument(
+          "target_file_size_base larger than max_bytes_for_level_base for "
+          "column family " +
+          std::to_string(cf_update.cf_id));
+    }
+  }
+
+  Status s;
+  // 预留好空间，InstallSuperVersionAndScheduleWork 拿的指针不会失效
+  std::vector<SuperVersionContext> sv_contexts;
+  sv_contexts.reserve(update.column_families.size());
+  {
+    InstrumentedMutexLock l(&mutex_);
+    if (update.max_background_jobs > 0 &&
+        update.max_background_jobs != mutable_db_options_.max_background_jobs) {
+      const BGJobLimits current_bg_job_limits =
+          GetBGJobLimits(mutable_db_options_.max_background_flushes,
+                         mutable_db_options_.max_background_compactions,
+                         mutable_db_options_.max_background_jobs,
+                         /* parallelize_compactions */ true);
+      const BGJobLimits new_bg_job_limits =
+          GetBGJobLimits(mutable_db_options_.max_background_flushes,
+                         mutable_db_options_.max_background_compactions,
+                         update.max_background_jobs,
+                         /* parallelize_compactions */ true);
+      if (new_bg_job_limits.max_flushes > current_bg_job_limits.max_flushes) {
+        env_->IncBackgroundThreadsIfNeeded(new_bg_job_limits.max_flushes,
+                                           Env::Priority::HIGH);
+      }
+      if (new_bg_job_limits.max_compactions >
+          current_bg_job_limits.max_compactions) {
+        env_->IncBackgroundThreadsIfNeeded(new_bg_job_limits.max_compactions,
+                                           Env::Priority::LOW);
+      }
+      mutable_db_options_.max_background_jobs = update.max_background_jobs;
+      ++tuned_options_version_;
+      MaybeScheduleFlushOrCompaction();
+    }
+    // 只影响之后挑出来的 compaction，正在跑的不变
+    if (update.max_subcompactions > 0 &&
+        update.max_subcompactions != mutable_db_options_.max_subcompactions) {
+      mutable_db_options_.max_subcompactions = update.max_subcompactions;
+      ++tuned_options_version_;
+    }
+    if (update.compaction_readahead_size > 0 &&
+        update.compaction_readahead_size !=
+            mutable_db_options_.compaction_readahead_size) {
+      mutable_db_options_.compaction_readahead_size =
+          update.compaction_readahead_size;
+      file_options_for_compaction_.compaction_readahead_size =
+          mutable_db_options_.compaction_readahead_size;
+      ++tuned_options_version_;
+    }
+    if (update.rate_limiter_bytes_per_sec > 0 &&
+        immutable_db_options_.rate_limiter != nullptr) {
+      immutable_db_options_.rate_limiter->SetBytesPerSecond(
+          update.rate_limiter_bytes_per_sec);
+    }
+
+    autovector<ColumnFamilyData*> changed_cfds;
+    // 改了 L1 大小或 SST 大小的列族要追加新 version 重新算 compaction score
+    autovector<ColumnFamilyData*> reshaped_cfds;
+    for (const auto& cf_update : update.column_families) {
+      ColumnFamilyData* cfd =
+          versions_->GetColumnFamilySet()->GetColumnFamily(cf_update.cf_id);
+      if (cfd == nullptr || cfd->IsDropped()) {
+        continue;
+      }
+      MutableCFOptions new_cf_options = *cfd->GetLatestMutableCFOptions();
+      bool cf_changed = false;
+      bool shape_changed = false;
+      if (cf_update.write_buffer_size > 0 &&
+          cf_update.write_buffer_size != new_cf_options.write_buffer_size) {
+        new_cf_options.write_buffer_size = cf_update.write_buffer_size;
+        cf_changed = true;
+      }
+      if (cf_update.target_file_size_base > 0 &&
+          cf_update.target_file_size_base !=
+              new_cf_options.target_file_size_base) {
+        new_cf_options.target_file_size_base = cf_update.target_file_size_base;
+        cf_changed = shape_changed = true;
+      }
+      if (cf_update.max_bytes_for_level_base > 0 &&
+          cf_update.max_bytes_for_level_base !=
+              new_cf_options.max_bytes_for_level_base) {
+        new_cf_options.max_bytes_for_level_base =
+            cf_update.max_bytes_for_level_base;
+        cf_changed = shape_changed = true;
+      }
+      if (!cf_changed) {
+        continue;
+      }
+      cfd->SetMutableCFOptions(new_cf_options);
+      changed_cfds.push_back(cfd);
+      if (shape_changed) {
+        reshaped_cfds.push_back(cfd);
+      }
+    }
+
+    if (!reshaped_cfds.empty()) {
+      // One MANIFEST write for all the reshaped column families
+      autovector<const MutableCFOptions*> mutable_cf_options_list;
+      std::vector<VersionEdit> dummy_edits(reshaped_cfds.size());
+      autovector<autovector<VersionEdit*>> edit_lists;
+      for (size_t i = 0; i < reshaped_cfds.size(); i++) {
+        mutable_cf_options_list.push_back(
+            reshaped_cfds[i]->GetLatestMutableCFOptions());
+        dummy_edits[i].SetColumnFamily(reshaped_cfds[i]->GetID());
+        autovector<VersionEdit*> edit_list;
+        edit_list.push_back(&dummy_edits[i]);
+        edit_lists.push_back(edit_list);
+      }
+      s = versions_->LogAndApply(reshaped_cfds, mutable_cf_options_list,
+                                 edit_lists, &mutex_, directories_.GetDbDir());
+    }
+    for (auto cfd : changed_cfds) {
+      if (cfd->IsDropped()) {
+        continue;
+      }
+      sv_contexts.emplace_back(/* create_superversion */ true);
+      InstallSuperVersionAndScheduleWork(cfd, &sv_contexts.back(),
+                                         *cfd->GetLatestMutableCFOptions());
+    }
+    if (!changed_cfds.empty()) {
+      ++tuned_options_version_;
+    }
+    bg_cv_.SignalAll();
+  }
+  for (auto& sv_context : sv_contexts) {
+    sv_context.Clean();
+  }
+
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "ApplyTuningUpdate() max_background_jobs: %d, "
+                 "max_subcompactions: %" PRIu32
+                 ", compaction_readahead_size: %" ROCKSDB_PRIszt
+                 ", rate_limiter_bytes_per_sec: %" PRId64
+                 ", column families: %" ROCKSDB_PRIszt ", status: %s",
+                 update.max_background_jobs, update.max_subcompactions,
+                 update.compaction_readahead_size,
+                 update.rate_limiter_bytes_per_sec,
+                 update.column_families.size(), s.ToString().c_str());
+  for (const auto& cf_update : update.column_families) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "[%" PRIu32 "] write_buffer_size: %" PRIu64
+                   ", target_file_size_base: %" PRIu64
+                   ", max_bytes_for_level_base: %" PRIu64,
+                   cf_update.cf_id, cf_update.write_buffer_size,
+                   cf_update.target_file_size_base,
+                   cf_update.max_bytes_for_level_base);
+  }
+  return s;
+}
+
+Status DBImpl::PersistTunedOptions() {
+  InstrumentedMutexLock l(&mutex_);
+  const uint64_t tuned_version = tuned_options_version_;
+  if (persisted_tuned_options_version_ >= tuned_version) {
+    return Status::OK();
+  }
+  Status s = WriteOptionsFile(false /*need_mutex_lock*/,
+                              true /*need_enter_write_thread*/);
+  // WriteOptionsFile() swallows the error unless fail_if_options_file_error
+  // is set, the tuner still has to know the values did not make it
+  if (s.ok() && persisted_tuned_options_version_ < tuned_version) {
+    s = Status::IOError("Unable to persist tuned options");
+  }
+  return s;
+}
+
+namespace {
+struct ThreadPoolTickers {
+  Env::Priority pri;
+  Tickers busy;
+  Tickers idle;
+};
+const ThreadPoolTickers kThreadPoolTickers[] = {
+    {Env::HIGH, THREAD_POOL_HIGH_BUSY_NANOS, THREAD_POOL_HIGH_IDLE_NANOS},
+    {Env::LOW, THREAD_POOL_LOW_BUSY_NANOS, THREAD_POOL_LOW_IDLE_NANOS},
+    {Env::BOTTOM, THREAD_POOL_BOTTOM_BUSY_NANOS,
+     THREAD_POOL_BOTTOM_IDLE_NANOS}};
+
+// Moves `recorded` forward to `current` and returns how far it moved, so
+// concurrent callers never count the same nanoseconds twice
+uint64_t AdvanceRecorded(std::atomic<uint64_t>* recorded, uint64_t current) {
+  uint64_t prev = recorded->load(std::memory_order_relaxed);
+  while (current > prev) {
+    if (recorded->compare_exchange_weak(prev, current,
+                                        std::memory_order_relaxed)) {
+      return current - prev;
+    }
+  }
+  return 0;
+}
+}  // namespace
+
+void DBImpl::RecordThreadPoolUtilization() {
+  if (stats_ == nullptr) {
+    return;
+  }
+  size_t i = 0;
+  for (const auto& pool : kThreadPoolTickers) {
+    uint64_t busy_nanos = 0;
+    uint64_t idle_nanos = 0;
+    if (!env_->GetThreadPoolUtilization(pool.pri, &busy_nanos, &idle_nanos)
+             .ok()) {
+      return;
+    }
+    RecordTick(stats_, pool.busy,
+               AdvanceRecorded(&recorded_thread_pool_nanos_[i++], busy_nanos));
+    RecordTick(stats_, pool.idle,
+               AdvanceRecorded(&recorded_thread_pool_nanos_[i++], idle_nanos));
+  }
+}
+
 // return the same level if it cannot be moved
 int DBImpl::FindMinimumEmptyLevelFitting(
     ColumnFamilyData* cfd, const MutableCFOptions& /*mutable_cf_options*/,
@@ -4717,6 +4955,8 @@ Status DBImpl::WriteOptionsFile(bool need_mutex_lock,
   // because the single write thread ensures all new writes get queued.
   DBOptions db_options =
       BuildDBOptions(immutable_db_options_, mutable_db_options_);
+  // for FEAT
+  const uint64_t tuned_version = tuned_options_version_;
   mutex_.Unlock();
 
   TEST_SYNC_POINT("DBImpl::WriteOptionsFile:1");
@@ -4739,6 +4979,11 @@ Status DBImpl::WriteOptionsFile(bool need_mutex_lock,
   if (need_enter_write_thread) {
     write_thread_.ExitUnbatched(&w);
   }
+  // for FEAT, need_mutex_lock 时锁已经放掉了，不能碰这两个计数
+  if (s.ok() && !need_mutex_lock &&
+      tuned_version > persisted_tuned_options_version_) {
+    persisted_tuned_options_version_ = tuned_version;
+  }
   if (!s.ok()) {
     ROCKS_LOG_WARN(immutable_db_options_.info_log,
                    "Unnable to persist options -- %s", s.ToString().c_str());
@@ -402,6 +402,48 @@ class DBImpl : public DB {
   virtual Status SetDBOptions(
       const std::unordered_map<std::string, std::string>& options_map) override;
 
+  // for FEAT
+  // The options the tuner adjusts. Fields left at 0 keep their current value.
+  struct TuningUpdate {
+    struct ColumnFamilyUpdate {
+      uint32_t cf_id = 0;
+      uint64_t write_buffer_size = 0;
+      uint64_t target_file_size_base = 0;
+      uint64_t max_bytes_for_level_base = 0;
+    };
+    int max_background_jobs = 0;
+    uint32_t max_subcompactions = 0;
+    size_t compaction_readahead_size = 0;
+    // Ignored when the DB has no rate limiter
+    int64_t rate_limiter_bytes_per_sec = 0;
+    std::vector<ColumnFamilyUpdate> column_families;
+
+    bool empty() const {
+      return max_background_jobs == 0 && max_subcompactions == 0 &&
+             compaction_readahead_size == 0 &&
+             rate_limiter_bytes_per_sec == 0 && column_families.empty();
+    }
+  };
+
+  // A typed, cheaper SetOptions() + SetDBOptions() for the tuner: applies
+  // `update` to the DB and its column families within one acquisition of the
+  // DB mutex, without parsing strings. Column families dropped in the
+  // meantime are skipped. The OPTIONS file is not rewritten, call
+  // PersistTunedOptions() to do that. Returns InvalidArgument without
+  // applying anything if a field is out of range.
+  Status ApplyTuningUpdate(const TuningUpdate& update);
+
+  // Rewrites the OPTIONS file if ApplyTuningUpdate() changed anything since
+  // the last successful write. Fails if the write does, even when
+  // fail_if_options_file_error is off, and the next call retries it.
+  Status PersistTunedOptions();
+
+  // Adds the busy / idle time the Env's thread pools accumulated since the
+  // last call to the THREAD_POOL_*_NANOS tickers. Called when a background
+  // job starts and when stats are dumped, the tuner may call it before it
+  // reads the tickers.
+  void RecordThreadPoolUtilization();
+
   using DB::NumberLevels;
   virtual int NumberLevels(ColumnFamilyHandle* column_family) override;
   using DB::MaxMemCompactionLevel;
@@ -1250,6 +1292,14 @@ class DBImpl : public DB {
   const ImmutableDBOptions immutable_db_options_;
   FileSystemPtr fs_;
   MutableDBOptions mutable_db_options_;
+  // for FEAT, bumped by every ApplyTuningUpdate() that changed something.
+  // WriteOptionsFile() records the version it wrote only once the write
+  // succeeded, so a failed write leaves the tuned options pending.
+  uint64_t tuned_options_version_ = 0;
+  uint64_t persisted_tuned_options_version_ = 0;
+  // for FEAT, pool counters already added to the tickers, indexed like
+  // kThreadPoolTickers in db_impl.cc
+  std::atomic<uint64_t> recorded_thread_pool_nanos_[6] = {};
   Statistics* stats_;
   std::unordered_map<std::string, RecoveredTransaction*>
       recovered_transactions_;
@@ -1965,6 +2015,15 @@ class DBImpl : public DB {
                     WriteBatch* tmp_batch, WriteBatch** merged_batch,
                     size_t* write_with_wal, WriteBatch** to_be_cached_state);
 
+  // for FEAT, lets a foreground-aware `DBOptions::rate_limiter` measure the
+  // client write rate
+  void ReportForegroundWrite(uint64_t bytes) {
+    if (immutable_db_options_.rate_limiter != nullptr) {
+      immutable_db_options_.rate_limiter->ReportForegroundBytes(
+          static_cast<int64_t>(bytes));
+    }
+  }
+
   // rate_limiter_priority is used to charge `DBOptions::rate_limiter`
   // for automatic WAL flush (`Options::manual_wal_flush` == false)
   // associated with this WriteToWAL
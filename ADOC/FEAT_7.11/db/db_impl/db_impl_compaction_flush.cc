@@ -2847,6 +2847,8 @@ void DBImpl::BackgroundCallFlush(Env::Priority thread_pri) {
   JobContext job_context(next_job_id_.fetch_add(1), true);
 
   TEST_SYNC_POINT_CALLBACK("DBImpl::BackgroundCallFlush:start", nullptr);
+  // for FEAT
+  RecordThreadPoolUtilization();
 
   LogBuffer log_buffer(InfoLogLevel::INFO_LEVEL,
                        immutable_db_options_.info_log.get());
@@ -2929,6 +2931,8 @@ void DBImpl::BackgroundCallCompaction(PrepickedCompaction* prepicked_compaction,
   bool made_progress = false;
   JobContext job_context(next_job_id_.fetch_add(1), true);
   TEST_SYNC_POINT("BackgroundCallCompaction:0");
+  // for FEAT
+  RecordThreadPoolUtilization();
   LogBuffer log_buffer(InfoLogLevel::INFO_LEVEL,
                        immutable_db_options_.info_log.get());
   {
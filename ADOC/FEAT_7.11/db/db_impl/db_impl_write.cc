@@ -448,6 +448,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     stats->AddDBStats(InternalStats::kIntStatsBytesWritten, total_byte_size,
                       concurrent_update);
     RecordTick(stats_, BYTES_WRITTEN, total_byte_size);
+    ReportForegroundWrite(total_byte_size);
     stats->AddDBStats(InternalStats::kIntStatsWriteDoneBySelf, 1,
                       concurrent_update);
     RecordTick(stats_, WRITE_DONE_BY_SELF);
@@ -704,6 +705,7 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     RecordTick(stats_, NUMBER_KEYS_WRITTEN, total_count);
     stats->AddDBStats(InternalStats::kIntStatsBytesWritten, total_byte_size);
     RecordTick(stats_, BYTES_WRITTEN, total_byte_size);
+    ReportForegroundWrite(total_byte_size);
     RecordInHistogram(stats_, BYTES_PER_WRITE, total_byte_size);
 
     PERF_TIMER_STOP(write_pre_and_post_process_time);
@@ -945,6 +947,7 @@ Status DBImpl::WriteImplWALOnly(
   stats->AddDBStats(InternalStats::kIntStatsBytesWritten, total_byte_size,
                     concurrent_update);
   RecordTick(stats_, BYTES_WRITTEN, total_byte_size);
+  ReportForegroundWrite(total_byte_size);
   stats->AddDBStats(InternalStats::kIntStatsWriteDoneBySelf, 1,
                     concurrent_update);
   RecordTick(stats_, WRITE_DONE_BY_SELF);
@@ -19,6 +19,7 @@
 #include "rocksdb/convenience.h"
 #include "rocksdb/rate_limiter.h"
 #include "rocksdb/stats_history.h"
+#include "rocksdb/utilities/options_util.h"
 #include "test_util/sync_point.h"
 #include "test_util/testutil.h"
 #include "util/random.h"
@@ -662,6 +663,122 @@ TEST_F(DBOptionsTest, SetBackgroundJobs) {
   }
 }
 
+// 测试：ApplyTuningUpdate 立即生效，只改指定的列族，OPTIONS 文件要等
+// PersistTunedOptions 才更新
+TEST_F(DBOptionsTest, ApplyTuningUpdate) {
+  // 1. Arrange
+  Options options;
+  options.create_if_missing = true;
+  options.max_background_jobs = 8;
+  options.write_buffer_size = 1 << 20;
+  options.env = env_;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  DBImpl::TuningUpdate update;
+  update.max_background_jobs = 12;
+  DBImpl::TuningUpdate::ColumnFamilyUpdate cf_update;
+  cf_update.cf_id = handles_[1]->GetID();
+  cf_update.write_buffer_size = 2 << 20;
+  cf_update.max_bytes_for_level_base = 8 << 20;
+  update.column_families.push_back(cf_update);
+
+  // 2. Act
+  ASSERT_OK(dbfull()->ApplyTuningUpdate(update));
+  DBOptions persisted_before;
+  std::vector<ColumnFamilyDescriptor> cf_descs_before;
+  ASSERT_OK(LoadLatestOptions(ConfigOptions(), dbname_, &persisted_before,
+                              &cf_descs_before));
+  ASSERT_OK(dbfull()->PersistTunedOptions());
+  DBOptions persisted_after;
+  std::vector<ColumnFamilyDescriptor> cf_descs_after;
+  ASSERT_OK(LoadLatestOptions(ConfigOptions(), dbname_, &persisted_after,
+                              &cf_descs_after));
+
+  // 3. Assert
+  ASSERT_EQ(12, dbfull()->GetDBOptions().max_background_jobs);
+  ASSERT_EQ(3, dbfull()->TEST_BGFlushesAllowed());
+  ASSERT_EQ(1u << 20, dbfull()->GetOptions(handles_[0]).write_buffer_size);
+  ASSERT_EQ(2u << 20, dbfull()->GetOptions(handles_[1]).write_buffer_size);
+  ASSERT_EQ(8u << 20,
+            dbfull()->GetOptions(handles_[1]).max_bytes_for_level_base);
+  ASSERT_EQ(options.target_file_size_base,
+            dbfull()->GetOptions(handles_[1]).target_file_size_base);
+  ASSERT_EQ(8, persisted_before.max_background_jobs);
+  ASSERT_EQ(1u << 20, cf_descs_before[1].options.write_buffer_size);
+  ASSERT_EQ(12, persisted_after.max_background_jobs);
+  ASSERT_EQ(1u << 20, cf_descs_after[0].options.write_buffer_size);
+  ASSERT_EQ(2u << 20, cf_descs_after[1].options.write_buffer_size);
+}
+
+// 测试：任何一项不合法时整个 update 都不生效
+TEST_F(DBOptionsTest, ApplyTuningUpdateRejectsInvalidValues) {
+  // 1. Arrange
+  Options options;
+  options.create_if_missing = true;
+  options.max_background_jobs = 8;
+  options.write_buffer_size = 1 << 20;
+  options.env = env_;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  DBImpl::TuningUpdate too_small;
+  too_small.max_background_jobs = 12;
+  DBImpl::TuningUpdate::ColumnFamilyUpdate cf_update;
+  cf_update.cf_id = handles_[1]->GetID();
+  cf_update.write_buffer_size = 1 << 10;
+  too_small.column_families.push_back(cf_update);
+  DBImpl::TuningUpdate negative;
+  negative.max_background_jobs = -1;
+  DBImpl::TuningUpdate inverted;
+  cf_update.write_buffer_size = 2 << 20;
+  cf_update.target_file_size_base = 16 << 20;
+  cf_update.max_bytes_for_level_base = 8 << 20;
+  inverted.column_families.push_back(cf_update);
+
+  // 2. Act
+  Status too_small_status = dbfull()->ApplyTuningUpdate(too_small);
+  Status negative_status = dbfull()->ApplyTuningUpdate(negative);
+  Status inverted_status = dbfull()->ApplyTuningUpdate(inverted);
+
+  // 3. Assert
+  ASSERT_TRUE(too_small_status.IsInvalidArgument());
+  ASSERT_TRUE(negative_status.IsInvalidArgument());
+  ASSERT_TRUE(inverted_status.IsInvalidArgument());
+  ASSERT_EQ(8, dbfull()->GetDBOptions().max_background_jobs);
+  ASSERT_EQ(1u << 20, dbfull()->GetOptions(handles_[1]).write_buffer_size);
+  ASSERT_EQ(options.target_file_size_base,
+            dbfull()->GetOptions(handles_[1]).target_file_size_base);
+}
+
+// 测试：OPTIONS 文件写失败时调过的值不能丢，下次 PersistTunedOptions 要重写
+TEST_F(DBOptionsTest, PersistTunedOptionsRetriesFailedWrite) {
+  // 1. Arrange
+  Options options;
+  options.create_if_missing = true;
+  options.max_background_jobs = 8;
+  options.env = env_;
+  Reopen(options);
+  DBImpl::TuningUpdate update;
+  update.max_background_jobs = 12;
+  ASSERT_OK(dbfull()->ApplyTuningUpdate(update));
+
+  // 2. Act
+  env_->non_writable_count_ = 1;
+  Status failed = dbfull()->PersistTunedOptions();
+  env_->non_writable_count_ = 0;
+  DBOptions persisted_after_failure;
+  std::vector<ColumnFamilyDescriptor> cf_descs;
+  ASSERT_OK(LoadLatestOptions(ConfigOptions(), dbname_,
+                              &persisted_after_failure, &cf_descs));
+  Status retried = dbfull()->PersistTunedOptions();
+  DBOptions persisted_after_retry;
+  ASSERT_OK(LoadLatestOptions(ConfigOptions(), dbname_,
+                              &persisted_after_retry, &cf_descs));
+
+  // 3. Assert
+  ASSERT_TRUE(failed.IsIOError());
+  ASSERT_EQ(8, persisted_after_failure.max_background_jobs);
+  ASSERT_OK(retried);
+  ASSERT_EQ(12, persisted_after_retry.max_background_jobs);
+}
+
 TEST_F(DBOptionsTest, AvoidFlushDuringShutdown) {
   Options options;
   options.create_if_missing = true;
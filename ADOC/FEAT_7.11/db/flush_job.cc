@@ -1058,7 +1058,7 @@ Status FlushJob::WriteLevel0Table() {
   metrics.memtable_ratio /= mems_.size();
   metrics.write_out_bandwidth = stats.bytes_written / stats.micros;
 
-  db_options_.flush_stats->push_back(metrics);
+  db_options_.flush_stats->Push(metrics);
 
 
   RecordFlushIOStats();
@@ -310,6 +310,7 @@ static const std::string live_blob_file_garbage_size =
 static const std::string blob_cache_capacity = "blob-cache-capacity";
 static const std::string blob_cache_usage = "blob-cache-usage";
 static const std::string blob_cache_pinned_usage = "blob-cache-pinned-usage";
+static const std::string thread_pool_utilization = "thread-pool-utilization";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
     rocksdb_prefix + num_files_at_level_prefix;
@@ -418,6 +419,8 @@ const std::string DB::Properties::kBlobCacheUsage =
     rocksdb_prefix + blob_cache_usage;
 const std::string DB::Properties::kBlobCachePinnedUsage =
     rocksdb_prefix + blob_cache_pinned_usage;
+const std::string DB::Properties::kThreadPoolUtilization =
+    rocksdb_prefix + thread_pool_utilization;
 
 const UnorderedMap<std::string, DBPropertyInfo>
     InternalStats::ppt_name_to_info = {
@@ -588,6 +591,9 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kBlobCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlobCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kThreadPoolUtilization,
+         {false, &InternalStats::HandleThreadPoolUtilization, nullptr,
+          &InternalStats::HandleThreadPoolUtilizationMap, nullptr}},
 };
 
 InternalStats::InternalStats(int num_levels, SystemClock* clock,
@@ -798,6 +804,47 @@ bool InternalStats::HandleNumBlobFiles(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+// for FEAT
+bool InternalStats::HandleThreadPoolUtilization(std::string* value,
+                                                Slice suffix) {
+  std::map<std::string, std::string> values;
+  if (!HandleThreadPoolUtilizationMap(&values, suffix)) {
+    return false;
+  }
+  std::ostringstream oss;
+  for (const auto& pool : {"high", "low", "bottom"}) {
+    uint64_t busy_nanos = ParseUint64(values[std::string(pool) + ".busy-nanos"]);
+    uint64_t idle_nanos = ParseUint64(values[std::string(pool) + ".idle-nanos"]);
+    uint64_t total_nanos = busy_nanos + idle_nanos;
+    oss << pool << " pool: busy " << busy_nanos << " ns, idle " << idle_nanos
+        << " ns, utilization "
+        << (total_nanos == 0 ? 0.0 : 100.0 * busy_nanos / total_nanos)
+        << "%\n";
+  }
+  *value = oss.str();
+  return true;
+}
+
+bool InternalStats::HandleThreadPoolUtilizationMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  Env* env = cfd_->ioptions()->env;
+  const std::pair<Env::Priority, const char*> pools[] = {
+      {Env::HIGH, "high"}, {Env::LOW, "low"}, {Env::BOTTOM, "bottom"}};
+  for (const auto& pool : pools) {
+    uint64_t busy_nanos = 0;
+    uint64_t idle_nanos = 0;
+    if (!env->GetThreadPoolUtilization(pool.first, &busy_nanos, &idle_nanos)
+             .ok()) {
+      return false;
+    }
+    (*values)[std::string(pool.second) + ".busy-nanos"] =
+        std::to_string(busy_nanos);
+    (*values)[std::string(pool.second) + ".idle-nanos"] =
+        std::to_string(idle_nanos);
+  }
+  return true;
+}
+
 bool InternalStats::HandleBlobStats(std::string* value, Slice /*suffix*/) {
   assert(value);
   assert(cfd_);
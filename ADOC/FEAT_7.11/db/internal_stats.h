@@ -796,6 +796,10 @@ class InternalStats {
   bool HandleLiveSstFilesSizeAtTemperature(std::string* value, Slice suffix);
   bool HandleNumBlobFiles(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlobStats(std::string* value, Slice suffix);
+  // for FEAT
+  bool HandleThreadPoolUtilization(std::string* value, Slice suffix);
+  bool HandleThreadPoolUtilizationMap(
+      std::map<std::string, std::string>* values, Slice suffix);
   bool HandleTotalBlobFileSize(uint64_t* value, DBImpl* db, Version* version);
   bool HandleLiveBlobFileSize(uint64_t* value, DBImpl* db, Version* version);
   bool HandleLiveBlobFileGarbageSize(uint64_t* value, DBImpl* db,
@@ -364,6 +364,15 @@ class CompositeEnvWrapper : public CompositeEnv {
     return target_.env->GetThreadList(thread_list);
   }
 
+  // for FEAT
+  std::string GetThreadPoolTimeStateString() override {
+    return target_.env->GetThreadPoolTimeStateString();
+  }
+  Status GetThreadPoolUtilization(Priority pri, uint64_t* busy_nanos,
+                                  uint64_t* idle_nanos) override {
+    return target_.env->GetThreadPoolUtilization(pri, busy_nanos, idle_nanos);
+  }
+
   ThreadStatusUpdater* GetThreadStatusUpdater() const override {
     return target_.env->GetThreadStatusUpdater();
   }
@@ -313,6 +313,39 @@ TEST_F(EnvPosixTest, LowerThreadPoolCpuPriority) {
 }
 #endif
 
+// 测试：线程池的 busy / idle 时间在任务还没结束时就会增长
+TEST_F(EnvPosixTest, ThreadPoolUtilization) {
+  // 1. Arrange
+  const int kSleepMicros = 50 * 1000;
+  const uint64_t kMinNanos = kSleepMicros / 2 * 1000;
+  env_->SetBackgroundThreads(1, Env::Priority::BOTTOM);
+  env_->SleepForMicroseconds(kSleepMicros);
+  uint64_t busy_start = 0;
+  uint64_t idle_start = 0;
+  ASSERT_OK(env_->GetThreadPoolUtilization(Env::Priority::BOTTOM, &busy_start,
+                                           &idle_start));
+  test::SleepingBackgroundTask sleeping_task;
+
+  // 2. Act
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                 Env::Priority::BOTTOM);
+  sleeping_task.WaitUntilSleeping();
+  env_->SleepForMicroseconds(kSleepMicros);
+  uint64_t busy_running = 0;
+  uint64_t idle_running = 0;
+  ASSERT_OK(env_->GetThreadPoolUtilization(Env::Priority::BOTTOM,
+                                           &busy_running, &idle_running));
+  sleeping_task.WakeUp();
+  sleeping_task.WaitUntilDone();
+
+  // 3. Assert
+  // 唯一的线程在 Arrange 阶段一直在等任务
+  ASSERT_GE(idle_start, kMinNanos);
+  // 任务还在跑，busy 已经算进去了，idle 基本不变
+  ASSERT_GE(busy_running - busy_start, kMinNanos);
+  ASSERT_LT(idle_running - idle_start, busy_running - busy_start);
+}
+
 TEST_F(EnvPosixTest, MemoryMappedFileBuffer) {
   const int kFileBytes = 1 << 15;  // 32 KB
   std::string expected_data;
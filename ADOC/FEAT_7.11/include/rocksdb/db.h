@@ -1103,6 +1103,14 @@ class DB {
     // "rocksdb.blob-cache-pinned-usage" - returns the memory size for the
     //      entries being pinned in blob cache.
     static const std::string kBlobCachePinnedUsage;
+
+    // for FEAT
+    //  "rocksdb.thread-pool-utilization" - returns a string or map with the
+    //      cumulative nanoseconds the threads of the Env's HIGH, LOW and
+    //      BOTTOM pools spent running jobs ("<pool>.busy-nanos") and waiting
+    //      for one ("<pool>.idle-nanos"). The pools are shared by all DBs of
+    //      the Env.
+    static const std::string kThreadPoolUtilization;
   };
 #endif /* ROCKSDB_LITE */
 
@@ -682,9 +682,15 @@ class Env : public Customizable {
   virtual std::string GetThreadPoolTimeStateString() {
     return "haven't been implemented";
   }
-  virtual std::vector<std::pair<size_t, uint64_t>>* GetThreadPoolWaitingTime(
-      Env::Priority /*priority*/) {
-    return nullptr;
+  // Cumulative nanoseconds the threads of pool `pri` spent running jobs
+  // (`busy_nanos`) and waiting for one (`idle_nanos`), summed over the
+  // threads. Both only grow, the utilization of a window is the ratio of
+  // their deltas. O(1) and safe to call at any rate.
+  virtual Status GetThreadPoolUtilization(Priority /*pri*/,
+                                          uint64_t* /*busy_nanos*/,
+                                          uint64_t* /*idle_nanos*/) {
+    return Status::NotSupported(
+        "Env::GetThreadPoolUtilization() not supported.");
   }
  protected:
   // The pointer to an internal structure that will update the
@@ -1622,6 +1628,15 @@ class EnvWrapper : public Env {
     return target_.env->GetThreadList(thread_list);
   }
 
+  // for FEAT
+  std::string GetThreadPoolTimeStateString() override {
+    return target_.env->GetThreadPoolTimeStateString();
+  }
+  Status GetThreadPoolUtilization(Priority pri, uint64_t* busy_nanos,
+                                  uint64_t* idle_nanos) override {
+    return target_.env->GetThreadPoolUtilization(pri, busy_nanos, idle_nanos);
+  }
+
   ThreadStatusUpdater* GetThreadStatusUpdater() const override {
     return target_.env->GetThreadStatusUpdater();
   }
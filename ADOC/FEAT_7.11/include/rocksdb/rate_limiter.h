@@ -111,6 +111,14 @@ class RateLimiter {
 
   virtual int64_t GetBytesPerSecond() const = 0;
 
+  // for FEAT, client write bytes fed by the DB so a foreground-aware limiter
+  // can hand the left over device bandwidth to deep compactions.
+  virtual void ReportForegroundBytes(int64_t /*bytes*/) {}
+
+  // True when IO_LOW requests are throttled by the foreground write rate, the
+  // DB then sends L0 compactions as IO_MID to keep them out of the throttle.
+  virtual bool IsForegroundAware() const { return false; }
+
   virtual bool IsRateLimited(OpType op_type) {
     if ((mode_ == RateLimiter::Mode::kWritesOnly &&
          op_type == RateLimiter::OpType::kRead) ||
@@ -156,4 +164,20 @@ extern RateLimiter* NewGenericRateLimiter(
     RateLimiter::Mode mode = RateLimiter::Mode::kWritesOnly,
     bool auto_tuned = false);
 
+// for FEAT
+// Create a SILK-style rate limiter that arbitrates the device bandwidth
+// between client writes and background I/O.
+// @device_bytes_per_sec: the write bandwidth of the device, shared by client
+// writes, flushes and compactions.
+// @min_low_pri_bytes_per_sec: the bandwidth IO_LOW requests (compactions
+// below L0) are guaranteed even when client writes saturate the device.
+// IO_HIGH (flush), IO_MID (L0 compactions) and IO_USER requests are limited
+// only by `device_bytes_per_sec`. IO_LOW requests additionally get whatever
+// is left of `device_bytes_per_sec` after the client write rate reported
+// through ReportForegroundBytes() in the last refill period, but never less
+// than `min_low_pri_bytes_per_sec`.
+extern RateLimiter* NewForegroundAwareRateLimiter(
+    int64_t device_bytes_per_sec, int64_t min_low_pri_bytes_per_sec,
+    int64_t refill_period_us = 100 * 1000, int32_t fairness = 10);
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -448,6 +448,17 @@ enum Tickers : uint32_t {
   // # of bytes written into blob cache.
   BLOB_DB_CACHE_BYTES_WRITE,
 
+  // for FEAT
+  // Nanoseconds the threads of the Env's HIGH (flush), LOW (compaction) and
+  // BOTTOM thread pools spent running jobs (busy) or waiting for one (idle).
+  // Pool wide, so DBs sharing an Env see the same time.
+  THREAD_POOL_HIGH_BUSY_NANOS,
+  THREAD_POOL_HIGH_IDLE_NANOS,
+  THREAD_POOL_LOW_BUSY_NANOS,
+  THREAD_POOL_LOW_IDLE_NANOS,
+  THREAD_POOL_BOTTOM_BUSY_NANOS,
+  THREAD_POOL_BOTTOM_IDLE_NANOS,
+
   TICKER_ENUM_MAX
 };
 
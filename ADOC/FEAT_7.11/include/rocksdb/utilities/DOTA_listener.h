@@ -0,0 +1,102 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "rocksdb/env.h"
+#include "rocksdb/listener.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The share of a TunerEventWindow that belongs to one column family.
+struct ColumnFamilyEventWindow {
+  int flush_numbers = 0;
+  uint64_t flush_bytes = 0;
+  double flush_speed_sum = 0.0;
+  int sealed_memtables = 0;
+  WriteStallCondition stall_condition = WriteStallCondition::kNormal;
+};
+
+// What happened in the DB since the previous TunerEventListener::Drain().
+struct TunerEventWindow {
+  uint64_t start_micros = 0;
+  uint64_t end_micros = 0;
+
+  // Flushes, bandwidth is in bytes per micro (MB/s) like FlushMetrics
+  int flush_numbers = 0;
+  uint64_t flush_bytes = 0;
+  double flush_speed_sum = 0.0;
+  double flush_speed_square_sum = 0.0;
+  double flush_speed_min = 9999999;
+  uint64_t flush_busy_micros = 0;
+
+  // Compactions
+  int compaction_numbers = 0;
+  int l0_compactions = 0;
+  double l0_drop_ratio_sum = 0.0;
+  uint64_t compaction_bytes = 0;
+  uint64_t compaction_busy_micros = 0;
+
+  // Memtables switched to immutable
+  int sealed_memtables = 0;
+  uint64_t sealed_entries = 0;
+
+  // Write stalls, `stall_condition` is the latest one reported
+  int stall_changes = 0;
+  WriteStallCondition stall_condition = WriteStallCondition::kNormal;
+
+  // Keyed by column family name
+  std::map<std::string, ColumnFamilyEventWindow> column_families;
+
+  uint64_t ElapsedMicros() const {
+    return end_micros > start_micros ? end_micros - start_micros : 0;
+  }
+};
+
+// Feeds the DOTA / FEAT tuner from DB events instead of polling the DB every
+// tuning gap. It must be added to DBOptions::listeners before the DB is
+// opened, the tuner then drains the aggregates once per tuning round.
+//
+// A tuning round can also be pulled forward: WaitForTuningRound() returns as
+// soon as a column family enters a write stall, so the tuner reacts within
+// the callback latency rather than at the next tick.
+class TunerEventListener : public EventListener {
+ public:
+  explicit TunerEventListener(Env* env);
+
+  const char* Name() const override { return "TunerEventListener"; }
+
+  void OnFlushBegin(DB* db, const FlushJobInfo& info) override;
+  void OnFlushCompleted(DB* db, const FlushJobInfo& info) override;
+  void OnCompactionCompleted(DB* db, const CompactionJobInfo& info) override;
+  void OnStallConditionsChanged(const WriteStallInfo& info) override;
+  void OnMemTableSealed(const MemTableInfo& info) override;
+
+  // Moves the aggregates into `window` and starts a new one.
+  void Drain(TunerEventWindow* window);
+
+  // Blocks until `timeout_micros` passed, a write stall began or Wake() was
+  // called.
+  void WaitForTuningRound(uint64_t timeout_micros);
+  void Wake();
+
+ private:
+  Env* env_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  TunerEventWindow window_;
+  // (cf_id, job_id) -> begin time of the running flushes
+  std::map<std::pair<uint32_t, int>, uint64_t> running_flushes_;
+  bool wake_up_ = false;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,55 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/db_impl/db_impl.h"
+#include "rocksdb/utilities/DOTA_tuner.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// One tuning round: what the tuner measured, what it chose and the settings
+// that were in effect afterwards.
+struct TunerTraceRecord {
+  int secs_elapsed = 0;
+  SystemScores scores;
+  TuningOP op{kKeep, kKeep};
+  int max_background_jobs = 0;
+  uint64_t write_buffer_size = 0;
+  uint32_t max_subcompactions = 0;
+  size_t compaction_readahead_size = 0;
+  int64_t rate_limiter_bytes_per_sec = 0;
+};
+
+// Binary trace of the tuner, replayed by tools/tuner_replay.
+//   header: "DOTATRC" magic, fixed32 format version
+//   record: fixed32 payload length, payload of fixed-width fields
+// Records are length prefixed, so a reader skips the fields a newer writer
+// appended.
+class TunerTraceWriter {
+ public:
+  static constexpr uint32_t kFormatVersion = 1;
+
+  static Status Create(Env* env, const std::string& fname,
+                       std::unique_ptr<TunerTraceWriter>* writer);
+
+  Status Append(const TunerTraceRecord& record);
+  Status Close();
+
+ private:
+  explicit TunerTraceWriter(std::unique_ptr<WritableFile>&& file)
+      : file_(std::move(file)) {}
+
+  std::unique_ptr<WritableFile> file_;
+};
+
+Status ReadTunerTrace(Env* env, const std::string& fname,
+                      std::vector<TunerTraceRecord>* records);
+
+}  // namespace ROCKSDB_NAMESPACE
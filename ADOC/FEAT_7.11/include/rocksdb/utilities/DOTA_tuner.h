@@ -5,7 +5,16 @@
 #ifndef ROCKSDB_DOTA_TUNER_H
 #define ROCKSDB_DOTA_TUNER_H
 #pragma once
+#include <algorithm>
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rocksdb/rate_limiter.h"
+#include "rocksdb/utilities/DOTA_listener.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -28,6 +37,7 @@ struct SystemScores {
   uint64_t memtable_speed;   // MB per sec
   double active_size_ratio;  // active size / total memtable size
   int immutable_number;      // NonFlush number
+  double memtable_fill;  // (immutable + active) / max_write_buffer_number
   // Flushing
   double flush_speed_avg;
   double flush_min;
@@ -45,11 +55,13 @@ struct SystemScores {
   double compaction_idle_time;  // calculate by idle calculating,flush and
                                 // compaction stats separately
   int flush_numbers;
+  uint64_t timestamp_micros;  // end of the window the scores describe
 
   SystemScores() {
     memtable_speed = 0.0;
     active_size_ratio = 0.0;
     immutable_number = 0;
+    memtable_fill = 0.0;
     flush_speed_avg = 0.0;
     flush_min = 9999999;
     flush_speed_var = 0.0;
@@ -60,11 +72,13 @@ struct SystemScores {
     compaction_idle_time = 0.0;
     flush_numbers = 0;
     flush_gap_time = 0;
+    timestamp_micros = 0;
   }
   void Reset() {
     memtable_speed = 0.0;
     active_size_ratio = 0.0;
     immutable_number = 0;
+    memtable_fill = 0.0;
     flush_speed_avg = 0.0;
     flush_speed_var = 0.0;
     l0_num = 0.0;
@@ -82,76 +96,155 @@ struct SystemScores {
 
 typedef SystemScores ScoreGradient;
 
+// Seconds left until the memtable, L0 and pending-bytes stall triggers are
+// reached if the recent trend holds. Each pressure is a ratio that stalls at
+// 1, the slopes are in ratio per second.
+struct StallForecast {
+  static constexpr double kNoStall = std::numeric_limits<double>::max();
+  double memtable_slope = 0.0;
+  double l0_slope = 0.0;
+  double pending_bytes_slope = 0.0;
+  double memtable_secs = kNoStall;
+  double l0_secs = kNoStall;
+  double pending_bytes_secs = kNoStall;
+
+  double Nearest() const {
+    return std::min(memtable_secs, std::min(l0_secs, pending_bytes_secs));
+  }
+};
+// Fits the trend of the last `samples` entries of `scores`
+StallForecast ForecastStall(const std::deque<SystemScores>& scores,
+                            size_t samples);
+// `current` with the rising pressures moved `horizon_secs` ahead, so the
+// stall areas are entered before the stall itself
+SystemScores ProjectScore(const SystemScores& current,
+                          const StallForecast& forecast, double horizon_secs);
+
 struct ChangePoint {
   std::string opt;
   std::string value;
   int change_timing;
   bool db_width;
 };
+// The options the tuner reads and writes. The tuner is their only writer, so
+// it keeps its own copy instead of fetching the whole Options every round.
+struct TunedOptions {
+  explicit TunedOptions(const Options& opt)
+      : max_background_jobs(opt.max_background_jobs),
+        write_buffer_size(opt.write_buffer_size),
+        level0_file_num_compaction_trigger(
+            opt.level0_file_num_compaction_trigger),
+        level0_slowdown_writes_trigger(opt.level0_slowdown_writes_trigger),
+        min_write_buffer_number_to_merge(opt.min_write_buffer_number_to_merge),
+        soft_pending_compaction_bytes_limit(
+            opt.soft_pending_compaction_bytes_limit),
+        max_subcompactions(opt.max_subcompactions),
+        compaction_readahead_size(opt.compaction_readahead_size),
+        rate_limiter_bytes_per_sec(
+            opt.rate_limiter != nullptr && !opt.rate_limiter->IsForegroundAware()
+                ? opt.rate_limiter->GetBytesPerSecond()
+                : 0) {}
+  int max_background_jobs;
+  uint64_t write_buffer_size;
+  int level0_file_num_compaction_trigger;
+  int level0_slowdown_writes_trigger;
+  int min_write_buffer_number_to_merge;
+  uint64_t soft_pending_compaction_bytes_limit;
+  // 单个 compaction 内部的并行度和读放大，由 CompactionOp 调整
+  uint32_t max_subcompactions;
+  size_t compaction_readahead_size;
+  // 0 when there is no limiter or SILK already owns its rate
+  int64_t rate_limiter_bytes_per_sec;
+};
+// Scores of one column family in one tuning round, plus the settings they
+// were measured under
+struct ColumnFamilyScores {
+  uint32_t id = 0;
+  std::string name;
+  SystemScores scores;
+  int sealed_memtables = 0;
+  uint64_t ingest_bytes = 0;  // bytes written into its memtables this round
+  uint64_t write_buffer_size = 0;
+  int max_write_buffer_number = 0;
+  int level0_file_num_compaction_trigger = 0;
+  int min_write_buffer_number_to_merge = 0;
+};
+// What the tuner remembers about one column family across rounds
+struct ColumnFamilyHistory {
+  uint64_t base_write_buffer_size = 0;  // step of the linear increase
+  uint64_t last_active_bytes = 0;
+  SystemScores max_scores;
+  std::deque<SystemScores> recent;  // the last forecast_samples rounds
+};
 enum OpType : int { kLinearIncrease, kHalf, kKeep };
 struct TuningOP {
   OpType BatchOp;
   OpType ThreadOp;
+  // max_subcompactions, compaction_readahead_size and the rate limiter move
+  // together: they all decide how fast one compaction runs
+  OpType CompactionOp = kKeep;
 };
 class DOTA_Tuner {
  protected:
   const Options default_opts;
   uint64_t tuning_rounds;
-  Options current_opt;
-  Version* version;
-  ColumnFamilyData* cfd;
-  VersionStorageInfo* vfs;
+  TunedOptions current_opt;
   DBImpl* running_db_;
+  std::shared_ptr<TunerEventListener> events_;
   int64_t* last_report_ptr;
   std::atomic<int64_t>* total_ops_done_ptr_;
   std::deque<SystemScores> scores;
   std::vector<ScoreGradient> gradients;
   int current_sec;
-  uint64_t flush_list_accessed, compaction_list_accessed;
   ThreadStallLevels last_thread_states;
   BatchSizeStallLevels last_batch_stat;
-  std::shared_ptr<std::vector<FlushMetrics>> flush_list_from_opt_ptr;
-  std::shared_ptr<std::vector<QuicksandMetrics>> compaction_list_from_opt_ptr;
   SystemScores max_scores;
   SystemScores avg_scores;
-  uint64_t last_flush_thread_len;
-  uint64_t last_compaction_thread_len;
   Env* env_;
   double tuning_gap;
+  // 本轮的测量值和决定，供 tuner trace 记录
+  SystemScores last_score_;
+  TuningOP last_op_{kKeep, kKeep};
+  // 用最近几轮的趋势预测写停顿，提前 forecast_horizon 秒做调整
+  const size_t forecast_samples = 5;
+  const double forecast_horizon = 2 * tuning_gap;
   int double_ratio = 2;
-  uint64_t last_unflushed_bytes = 0;
+  // 每个列族单独打分、单独决定 memtable 大小
+  std::vector<ColumnFamilyScores> cf_scores_;
+  std::map<uint32_t, ColumnFamilyHistory> cf_history_;
   const int score_array_len = 600 / tuning_gap;
   double idle_threshold = 2.5;
   double FEA_gap_threshold = 1;
   double TEA_slow_flush = 0.5;
   uint64_t last_non_zero_flush = 0;
-  void UpdateSystemStats() { UpdateSystemStats(running_db_); }
+  // 线程池的累计空闲时间 (ns)，来自 Env::GetThreadPoolUtilization()，
+  // 每轮只取差值
+  bool pool_idle_valid_ = false;
+  uint64_t last_flush_idle_nanos_ = 0;
+  uint64_t last_compaction_idle_nanos_ = 0;
 
  public:
   DOTA_Tuner(const Options opt, DBImpl* running_db, int64_t* last_report_op_ptr,
              std::atomic<int64_t>* total_ops_done_ptr, Env* env,
-             uint64_t gap_sec)
+             uint64_t gap_sec, std::shared_ptr<TunerEventListener> events)
       : default_opts(opt),
         tuning_rounds(0),
+        current_opt(opt),
         running_db_(running_db),
+        events_(std::move(events)),
         scores(),
         gradients(0),
         current_sec(0),
-        flush_list_accessed(0),
-        compaction_list_accessed(0),
         last_thread_states(kL0Stall),
         last_batch_stat(kTinyMemtable),
-        flush_list_from_opt_ptr(running_db->immutable_db_options().flush_stats),
-        compaction_list_from_opt_ptr(
-            running_db->immutable_db_options().job_stats),
         max_scores(),
-        last_flush_thread_len(0),
-        last_compaction_thread_len(0),
         env_(env),
         tuning_gap(gap_sec),
-        core_num(running_db->immutable_db_options().core_number),
+        core_num(running_db ? running_db->immutable_db_options().core_number
+                            : opt.core_number),
         max_memtable_size(
-            running_db->immutable_db_options().max_memtable_size) {
+            running_db ? running_db->immutable_db_options().max_memtable_size
+                       : opt.max_memtable_size) {
     this->last_report_ptr = last_report_op_ptr;
     this->total_ops_done_ptr_ = total_ops_done_ptr;
   }
@@ -165,6 +258,11 @@ class DOTA_Tuner {
   virtual ~DOTA_Tuner();
 
   inline void UpdateMaxScore(SystemScores& current_score) {
+    UpdateMaxScore(current_score, &max_scores);
+  }
+  static void UpdateMaxScore(const SystemScores& current_score,
+                             SystemScores* max) {
+    SystemScores& max_scores = *max;
     //    if (!scores.empty() &&
     //        current_score.memtable_speed > scores.front().memtable_speed * 2)
     //        {
@@ -214,17 +312,13 @@ class DOTA_Tuner {
   }
 
   void ResetTuner() { tuning_rounds = 0; }
-  void UpdateSystemStats(DBImpl* running_db) {
-    current_opt = running_db->GetOptions();
-    version = running_db->GetVersionSet()
-                  ->GetColumnFamilySet()
-                  ->GetDefault()
-                  ->current();
-    cfd = version->cfd();
-    vfs = version->storage_info();
-  }
+  const TunedOptions& tuned_options() const { return current_opt; }
+  const SystemScores& last_score() const { return last_score_; }
+  // The thread op and the batch op of the default column family
+  const TuningOP& last_op() const { return last_op_; }
+  // Fills the fields of `update` the tuner wants to change this round
   virtual void DetectTuningOperations(int secs_elapsed,
-                                      std::vector<ChangePoint>* change_list);
+                                      DBImpl::TuningUpdate* update);
 
   ScoreGradient CompareWithBefore() { return scores.back() - scores.front(); }
   ScoreGradient CompareWithBefore(SystemScores& past_score) {
@@ -235,30 +329,57 @@ class DOTA_Tuner {
     return current_score - past_score;
   }
   ThreadStallLevels LocateThreadStates(SystemScores& score);
-  BatchSizeStallLevels LocateBatchStates(SystemScores& score);
-
-  const std::string memtable_size = "write_buffer_size";
-  const std::string sst_size = "target_file_size_base";
-  const std::string total_l1_size = "max_bytes_for_level_base";
-  const std::string max_bg_jobs = "max_background_jobs";
-  const std::string memtable_number = "max_write_buffer_number";
+  BatchSizeStallLevels LocateBatchStates(const SystemScores& score,
+                                         const SystemScores& max_score);
 
   const int core_num;
   int max_thread = core_num;
   const int min_thread = 2;
   uint64_t max_memtable_size;
   const uint64_t min_memtable_size = 64 << 20;
+  const uint32_t max_subcompactions = std::max(core_num / 2, 1);
+  const size_t readahead_step = 2 << 20;
+  const size_t max_readahead = 16 << 20;
+  // 限速只在用户配置的速度以下调整，最低降到它的 1/8
+  const int64_t max_rate_limit = current_opt.rate_limiter_bytes_per_sec;
 
-  SystemScores ScoreTheSystem();
-  void AdjustmentTuning(std::vector<ChangePoint>* change_list,
-                        SystemScores& score, ThreadStallLevels levels,
-                        BatchSizeStallLevels stallLevels);
+  // Scores every column family into cf_scores_ and returns the DB wide
+  // aggregate. tools/tuner_replay overrides it to feed a flow model instead
+  // of a DB, the tuner then runs with a null running_db_.
+  virtual SystemScores ScoreTheSystem();
+  // Updates the history of `cf` with its scores of this round
+  void RecordColumnFamily(const ColumnFamilyScores& cf);
+  // Idle micros of the flush and compaction pools since the last call, false
+  // when the Env does not count them or on the first call
+  bool ReadPoolIdleMicros(double* flush_idle, double* compaction_idle);
   TuningOP VoteForOP(SystemScores& current_score, ThreadStallLevels levels,
                      BatchSizeStallLevels stallLevels);
-  void FillUpChangeList(std::vector<ChangePoint>* change_list, TuningOP op);
-  void SetBatchSize(std::vector<ChangePoint>* change_list,
+  // Filters the vote of one column family, a column family without flushes
+  // in this round has no bandwidth sample to vote with. A cold one shrinks
+  // until its memtable just holds one round of writes, an idle one keeps it
+  OpType VoteForColumnFamily(const ColumnFamilyScores& cf, OpType vote) const;
+  // `batch_ops` is indexed like cf_scores_
+  void FillUpChangeList(DBImpl::TuningUpdate* update, OpType thread_op,
+                        const std::vector<OpType>& batch_ops,
+                        OpType compaction_op = kKeep);
+  // Shrinks `targets` so that the memtables fit the WriteBufferManager
+  // budget
+  void FitIntoWriteBufferBudget(std::vector<uint64_t>* targets) const;
+  // Shrinks `targets` to `budget` bytes: every column family keeps its floor,
+  // the rest is shared by ingest rate and what one column family cannot use
+  // goes to the others
+  void ShareWriteBufferBudget(double budget,
+                              std::vector<uint64_t>* targets) const;
+  uint64_t MemtableFloor(const ColumnFamilyScores& cf) const;
+  void SetBatchSize(DBImpl::TuningUpdate* update, const ColumnFamilyScores& cf,
                     uint64_t target_value);
-  void SetThreadNum(std::vector<ChangePoint>* change_list, int target_value);
+  void SetThreadNum(DBImpl::TuningUpdate* update, int target_value);
+  void SetCompactionSpeed(DBImpl::TuningUpdate* update, OpType op);
+  // 调优过程的日志写到 DB 的 info log，不往 stdout 打
+  Logger* info_log() const {
+    return running_db_ ? running_db_->immutable_db_options().info_log.get()
+                       : default_opts.info_log.get();
+  }
 };
 
 enum Stage : int { kSlowStart, kStabilizing };
@@ -266,26 +387,24 @@ class FEAT_Tuner : public DOTA_Tuner {
  public:
   FEAT_Tuner(const Options opt, DBImpl* running_db, int64_t* last_report_op_ptr,
              std::atomic<int64_t>* total_ops_done_ptr, Env* env, int gap_sec,
-             bool triggerTEA, bool triggerFEA)
+             std::shared_ptr<TunerEventListener> events, bool triggerTEA,
+             bool triggerFEA)
       : DOTA_Tuner(opt, running_db, last_report_op_ptr, total_ops_done_ptr, env,
-                   gap_sec),
+                   gap_sec, std::move(events)),
         TEA_enable(triggerTEA),
         FEA_enable(triggerFEA),
         current_stage(kSlowStart) {
-    flush_list_from_opt_ptr =
-        this->running_db_->immutable_db_options().flush_stats;
-
     std::cout << "Using FEAT tuner.\n FEA is "
               << (FEA_enable ? "triggered" : "NOT triggered") << std::endl;
     std::cout << "TEA is " << (TEA_enable ? "triggered" : "NOT triggered")
               << std::endl;
   }
   void DetectTuningOperations(int secs_elapsed,
-                              std::vector<ChangePoint>* change_list) override;
+                              DBImpl::TuningUpdate* update) override;
   ~FEAT_Tuner() override;
 
   TuningOP TuneByTEA();
-  TuningOP TuneByFEA();
+  OpType TuneByFEA(const SystemScores& score, const SystemScores& max_score);
 
  private:
   bool TEA_enable;
@@ -20,6 +20,7 @@
 #include <unordered_map>
 
 #include "db/db_impl/db_impl.h"
+#include "rocksdb/utilities/DOTA_trace.h"
 #include "rocksdb/utilities/DOTA_tuner.h"
 namespace ROCKSDB_NAMESPACE {
 
@@ -78,6 +79,9 @@ class ReporterAgent {
  protected:
   virtual void DetectAndTuning(int secs_elapsed);
   virtual Status ReportLine(int secs_elapsed, int total_ops_done_snapshot);
+  // Stops and joins the reporting thread. Subclasses whose ReportLine() or
+  // DetectAndTuning() use their own members call it in their destructor.
+  void StopReporting();
   Env* env_;
   std::unique_ptr<WritableFile> report_file_;
   std::atomic<int64_t> total_ops_done_;
@@ -126,18 +130,22 @@ class ReporterAgent {
   }
 };
 
+// SILK style bandwidth arbitration is done by the foreground-aware
+// DBOptions::rate_limiter (see NewForegroundAwareRateLimiter), this agent only
+// reports how the bandwidth was shared between flushes, L0 compactions and
+// the deeper compactions.
 class ReporterAgentWithSILK : public ReporterAgent {
  private:
-  bool pausedcompaction = false;
-  long prev_bandwidth_compaction_MBPS = 0;
-  int FLAGS_value_size = 1000;
-  int FLAGS_SILK_bandwidth_limitation = 350;
   DBImpl* running_db_;
+  int64_t last_bytes_through_[Env::IO_TOTAL] = {};
+  static std::string SILKHeader() {
+    return "secs_elapsed,interval_qps,flush_MBPS,l0_compaction_MBPS,"
+           "deep_compaction_MBPS";
+  }
 
  public:
   ReporterAgentWithSILK(DBImpl* running_db, Env* env, const std::string& fname,
-                        uint64_t report_interval_secs, int32_t FLAGS_value_size,
-                        int32_t bandwidth_limitation);
+                        uint64_t report_interval_secs);
   Status ReportLine(int secs_elapsed, int total_ops_done_snapshot) override;
 };
 
@@ -147,11 +155,23 @@ class ReporterAgentWithTuning : public ReporterAgent {
   DBImpl* running_db_;
   const Options options_when_boost;
   uint64_t last_metrics_collect_secs;
-  uint64_t last_compaction_thread_len;
-  uint64_t last_flush_thread_len;
   std::map<std::string, void*> string_to_attributes_map;
+  std::shared_ptr<TunerEventListener> events_;
+  // Guards the tuner and the pending change points, they are used by both the
+  // reporting thread and the tuning thread
+  std::mutex tuner_mutex_;
   std::unique_ptr<DOTA_Tuner> tuner;
-  bool applying_changes;
+  // Records every tuning round when set, see StartTunerTrace()
+  std::unique_ptr<TunerTraceWriter> trace_writer_;
+  uint64_t tuning_started_;
+  // Tuning rounds only change options in memory, the OPTIONS file is
+  // rewritten at most once per kPersistOptionsGapSecs
+  static constexpr int kPersistOptionsGapSecs = 60;
+  int last_persist_secs_;
+  std::atomic<bool> tuning_stopped_;
+  ROCKSDB_NAMESPACE::port::Thread tuning_thread_;
+  // Runs a tuning round every tuning gap, or as soon as a write stall begins
+  void TuneOnEvents();
   static std::string DOTAHeader() {
     return "secs_elapsed,interval_qps,batch_size,thread_num";
   }
@@ -167,11 +187,15 @@ class ReporterAgentWithTuning : public ReporterAgent {
   std::deque<LSM_STATE> shape_list;
   const size_t default_memtable_size = 64 << 20;
   const float threashold = 0.5;
+  // `events` must have been added to the DB's listeners before it was opened
   ReporterAgentWithTuning(DBImpl* running_db, Env* env,
                           const std::string& fname,
                           uint64_t report_interval_secs,
-                          uint64_t dota_tuning_gap_secs = 1);
+                          uint64_t dota_tuning_gap_secs,
+                          std::shared_ptr<TunerEventListener> events);
+  ~ReporterAgentWithTuning() override;
   DOTA_Tuner* GetTuner() { return tuner.get(); }
+  // Applies preset change points through SetDBOptions() / SetOptions()
   void ApplyChangePointsInstantly(std::vector<ChangePoint>* points);
 
   void DetectChangesPoints(int sec_elapsed);
@@ -185,6 +209,9 @@ class ReporterAgentWithTuning : public ReporterAgent {
 
   Status ReportLine(int secs_elapsed, int total_ops_done_snapshot) override;
   void UseFEATTuner(bool TEA_enable, bool FEA_enable);
+  // Records the scores and the decision of every following tuning round into
+  // `fname`, for tools/tuner_replay
+  Status StartTunerTrace(const std::string& fname);
   //  void print_useless_thing(int secs_elapsed);
   void DetectAndTuning(int secs_elapsed) override;
   enum CongestionStatus {
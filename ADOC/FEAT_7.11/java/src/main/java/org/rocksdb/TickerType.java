@@ -836,6 +836,36 @@ public enum TickerType {
      */
     BLOB_DB_CACHE_BYTES_WRITE((byte) -0x34),
 
+    /**
+     * # of nanoseconds the threads of the HIGH priority pool spent running jobs.
+     */
+    THREAD_POOL_HIGH_BUSY_NANOS((byte) -0x35),
+
+    /**
+     * # of nanoseconds the threads of the HIGH priority pool spent waiting for a job.
+     */
+    THREAD_POOL_HIGH_IDLE_NANOS((byte) -0x36),
+
+    /**
+     * # of nanoseconds the threads of the LOW priority pool spent running jobs.
+     */
+    THREAD_POOL_LOW_BUSY_NANOS((byte) -0x37),
+
+    /**
+     * # of nanoseconds the threads of the LOW priority pool spent waiting for a job.
+     */
+    THREAD_POOL_LOW_IDLE_NANOS((byte) -0x38),
+
+    /**
+     * # of nanoseconds the threads of the BOTTOM priority pool spent running jobs.
+     */
+    THREAD_POOL_BOTTOM_BUSY_NANOS((byte) -0x39),
+
+    /**
+     * # of nanoseconds the threads of the BOTTOM priority pool spent waiting for a job.
+     */
+    THREAD_POOL_BOTTOM_IDLE_NANOS((byte) -0x3A),
+
     TICKER_ENUM_MAX((byte) 0x5F);
 
     private final byte value;
@@ -233,7 +233,13 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {BLOB_DB_CACHE_ADD, "rocksdb.blobdb.cache.add"},
     {BLOB_DB_CACHE_ADD_FAILURES, "rocksdb.blobdb.cache.add.failures"},
     {BLOB_DB_CACHE_BYTES_READ, "rocksdb.blobdb.cache.bytes.read"},
-    {BLOB_DB_CACHE_BYTES_WRITE, "rocksdb.blobdb.cache.bytes.write"}};
+    {BLOB_DB_CACHE_BYTES_WRITE, "rocksdb.blobdb.cache.bytes.write"},
+    {THREAD_POOL_HIGH_BUSY_NANOS, "rocksdb.thread.pool.high.busy.nanos"},
+    {THREAD_POOL_HIGH_IDLE_NANOS, "rocksdb.thread.pool.high.idle.nanos"},
+    {THREAD_POOL_LOW_BUSY_NANOS, "rocksdb.thread.pool.low.busy.nanos"},
+    {THREAD_POOL_LOW_IDLE_NANOS, "rocksdb.thread.pool.low.idle.nanos"},
+    {THREAD_POOL_BOTTOM_BUSY_NANOS, "rocksdb.thread.pool.bottom.busy.nanos"},
+    {THREAD_POOL_BOTTOM_IDLE_NANOS, "rocksdb.thread.pool.bottom.idle.nanos"}};
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {DB_GET, "rocksdb.db.get.micros"},
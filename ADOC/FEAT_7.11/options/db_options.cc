@@ -766,8 +766,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
   logger = info_log.get();
   stats = statistics.get();
 
-  job_stats = std::make_shared<std::vector<QuicksandMetrics>>();
-  flush_stats = std::make_shared<std::vector<FlushMetrics>>();
+  job_stats = std::make_shared<MetricsRing<QuicksandMetrics>>();
+  flush_stats = std::make_shared<MetricsRing<FlushMetrics>>();
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
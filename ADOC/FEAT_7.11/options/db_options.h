@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "rocksdb/options.h"
+#include "util/metrics_ring.h"
 
 namespace ROCKSDB_NAMESPACE {
 class SystemClock;
@@ -109,8 +110,9 @@ struct ImmutableDBOptions {
 
   uint64_t core_number;
   uint64_t max_memtable_size;
-  std::shared_ptr<std::vector<QuicksandMetrics>> job_stats;
-  std::shared_ptr<std::vector<FlushMetrics>> flush_stats;
+  // Written by flush / compaction jobs, read by the tuner without locks.
+  std::shared_ptr<MetricsRing<QuicksandMetrics>> job_stats;
+  std::shared_ptr<MetricsRing<FlushMetrics>> flush_stats;
 
   bool IsWalDirSameAsDBPath() const;
   bool IsWalDirSameAsDBPath(const std::string& path) const;
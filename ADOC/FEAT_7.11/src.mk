@@ -148,10 +148,12 @@ LIB_SOURCES =                                                   \
   monitoring/thread_status_util.cc                              \
   monitoring/thread_status_util_debug.cc                        \
   ycsbcore/acknowledged_counter_generator.cc                    		\
+  ycsbcore/arrival_schedule.cc                                  		\
   ycsbcore/basic_db.cc                                          		\
   ycsbcore/core_workload.cc                                    		 	\
   ycsbcore/db_factory.cc                                        		\
   ycsbcore/measurements.cc                                      		\
+  ycsbcore/rocksdb_db.cc                                        		\
   ycsbcore/ycsbc.cc                                             		\
   options/cf_options.cc                                         \
   options/configurable.cc                                       \
@@ -275,6 +277,8 @@ LIB_SOURCES =                                                   \
   utilities/fault_injection_fs.cc                               \
   utilities/fault_injection_secondary_cache.cc                  \
   utilities/leveldb_options/leveldb_options.cc                  \
+  utilities/DOTA/DOTA_listener.cc                               \
+  utilities/DOTA/DOTA_trace.cc                                  \
   utilities/DOTA/report_agent.cc								\
   utilities/DOTA/DOTA_tuner.cc                      			\
   utilities/memory/memory_util.cc                               \
@@ -414,6 +418,9 @@ TOOLS_MAIN_SOURCES =                                                    \
   tools/dump/rocksdb_undump.cc                                          \
   tools/trace_analyzer.cc                                               \
   tools/io_tracer_parser_tool.cc                                        \
+  tools/tuner_replay.cc                                                 \
+  tools/tuner_replay_tool.cc                                            \
+  tools/ycsbc.cc                                                        \
 
 BENCH_MAIN_SOURCES =                                                    \
   cache/cache_bench.cc                                                  \
@@ -565,6 +572,7 @@ TEST_MAIN_SOURCES =                                                     \
   test_util/testutil_test.cc                                            \
   tools/block_cache_analyzer/block_cache_trace_analyzer_test.cc         \
   tools/io_tracer_parser_test.cc                                        \
+  tools/tuner_replay_test.cc                                            \
   tools/ldb_cmd_test.cc                                                 \
   tools/reduce_levels_test.cc                                           \
   tools/sst_dump_test.cc                                                \
@@ -581,6 +589,7 @@ TEST_MAIN_SOURCES =                                                     \
   util/file_reader_writer_test.cc                                       \
   util/hash_test.cc                                                     \
   util/heap_test.cc                                                     \
+  util/metrics_ring_test.cc                                             \
   util/random_test.cc                                                   \
   util/rate_limiter_test.cc                                             \
   util/repeatable_thread_test.cc                                        \
@@ -600,6 +609,8 @@ TEST_MAIN_SOURCES =                                                     \
   utilities/cassandra/cassandra_row_merge_test.cc                       \
   utilities/cassandra/cassandra_serialize_test.cc                       \
   utilities/checkpoint/checkpoint_test.cc                               \
+  utilities/DOTA/DOTA_listener_test.cc                                  \
+  utilities/DOTA/DOTA_tuner_test.cc                                     \
   utilities/env_timed_test.cc                                           \
   utilities/memory/memory_test.cc                                       \
   utilities/merge_operators/string_append/stringappend_test.cc          \
@@ -622,6 +633,8 @@ TEST_MAIN_SOURCES =                                                     \
   utilities/ttl/ttl_test.cc                                             \
   utilities/util_merge_operators_test.cc                                \
   utilities/write_batch_with_index/write_batch_with_index_test.cc       \
+  ycsbcore/arrival_schedule_test.cc                                     \
+  ycsbcore/measurements_test.cc                                         \
 
 TEST_MAIN_SOURCES_C = \
   db/c_test.c                                                           \
@@ -785,12 +785,19 @@ DEFINE_bool(FEA_enable, false, "Trigger FEAT tuner's FEA component");
 DEFINE_bool(TEA_enable, false, "Trigger FEAT tuner's TEA component");
 DEFINE_int32(SILK_bandwidth_limitation, 200, "MBPS of disk limitation");
 DEFINE_bool(SILK_triggered, false, "Whether the SILK tuner is triggered");
+DEFINE_int32(SILK_min_compaction_bandwidth, 10,
+             "MBPS left to deep compactions even at a load peak when SILK is "
+             "triggered");
 DEFINE_double(idle_rate, 1.25,
               "TEA will decide this as the idle rate of the threads");
 DEFINE_double(FEA_gap_threshold, 1.5,
               "The negative feedback loop's threshold");
 DEFINE_double(TEA_slow_flush, 0.5, "The negative feedback loop's threshold");
 DEFINE_double(DOTA_tuning_gap, 1.0, "Tuning gap of the DOTA agent, in secs ");
+DEFINE_string(tuner_trace_file, "",
+              "If set, record the scores and the decision of every tuning "
+              "round into this binary file, it can be replayed by "
+              "tuner_replay");
 DEFINE_int64(random_fill_average, 150,
              "average inputs rate of background write operations");
 DEFINE_bool(detailed_running_stats, false,
@@ -2716,6 +2723,8 @@ class Benchmark {
   };
 
   std::shared_ptr<ErrorHandlerListener> listener_;
+  // for FEAT, feeds the tuner of ReporterAgentWithTuning
+  std::shared_ptr<TunerEventListener> tuner_listener_;
 
   std::unique_ptr<TimestampEmulator> mock_app_clock_;
 
@@ -3125,6 +3134,9 @@ class Benchmark {
     }
 
     listener_.reset(new ErrorHandlerListener());
+    if (FLAGS_DOTA_enabled || FLAGS_TEA_enable || FLAGS_FEA_enable) {
+      tuner_listener_.reset(new TunerEventListener(FLAGS_env));
+    }
     if (user_timestamp_size_ > 0) {
       mock_app_clock_.reset(new TimestampEmulator());
     }
@@ -3859,11 +3871,13 @@ class Benchmark {
         if (FLAGS_DOTA_tuning_gap == 0) {
           reporter_agent.reset(new ReporterAgentWithTuning(
               reinterpret_cast<DBImpl*>(db_.db), FLAGS_env, FLAGS_report_file,
-              FLAGS_report_interval_seconds, FLAGS_report_interval_seconds));
+              FLAGS_report_interval_seconds, FLAGS_report_interval_seconds,
+              tuner_listener_));
         } else {
           reporter_agent.reset(new ReporterAgentWithTuning(
               reinterpret_cast<DBImpl*>(db_.db), FLAGS_env, FLAGS_report_file,
-              FLAGS_report_interval_seconds, FLAGS_DOTA_tuning_gap));
+              FLAGS_report_interval_seconds, FLAGS_DOTA_tuning_gap,
+              tuner_listener_));
         }
         auto tuner_agent =
             reinterpret_cast<ReporterAgentWithTuning*>(reporter_agent.get());
@@ -3871,6 +3885,14 @@ class Benchmark {
         tuner_agent->GetTuner()->set_idle_ratio(FLAGS_idle_rate);
         tuner_agent->GetTuner()->set_gap_threshold(FLAGS_FEA_gap_threshold);
         tuner_agent->GetTuner()->set_slow_flush_threshold(FLAGS_TEA_slow_flush);
+        if (!FLAGS_tuner_trace_file.empty()) {
+          Status s = tuner_agent->StartTunerTrace(FLAGS_tuner_trace_file);
+          if (!s.ok()) {
+            fprintf(stderr, "Can't open %s: %s\n",
+                    FLAGS_tuner_trace_file.c_str(), s.ToString().c_str());
+            exit(1);
+          }
+        }
       } else if (FLAGS_detailed_running_stats) {
         reporter_agent.reset(new ReporterWithMoreDetails(
             reinterpret_cast<DBImpl*>(db_.db), FLAGS_env, FLAGS_report_file,
@@ -3878,8 +3900,7 @@ class Benchmark {
       } else if (FLAGS_SILK_triggered) {
         reporter_agent.reset(new ReporterAgentWithSILK(
             reinterpret_cast<DBImpl*>(db_.db), FLAGS_env, FLAGS_report_file,
-            FLAGS_report_interval_seconds, FLAGS_value_size,
-            FLAGS_SILK_bandwidth_limitation));
+            FLAGS_report_interval_seconds));
       } else {
         reporter_agent.reset(new ReporterAgent(FLAGS_env, FLAGS_report_file,
                                                FLAGS_report_interval_seconds));
@@ -4716,10 +4737,19 @@ class Benchmark {
             FLAGS_rate_limit_bg_reads ? RateLimiter::Mode::kReadsOnly
                                       : RateLimiter::Mode::kWritesOnly,
             FLAGS_rate_limiter_auto_tuned));
+      } else if (FLAGS_SILK_triggered) {
+        // for FEAT, SILK arbitrates the disk bandwidth inside the limiter
+        options.rate_limiter.reset(NewForegroundAwareRateLimiter(
+            static_cast<int64_t>(FLAGS_SILK_bandwidth_limitation) << 20,
+            static_cast<int64_t>(FLAGS_SILK_min_compaction_bandwidth) << 20,
+            FLAGS_rate_limiter_refill_period_us));
       }
     }
 
     options.listeners.emplace_back(listener_);
+    if (tuner_listener_) {
+      options.listeners.emplace_back(tuner_listener_);
+    }
 
     if (options.file_checksum_gen_factory == nullptr) {
       if (FLAGS_file_checksum) {
@@ -5072,6 +5102,8 @@ class Benchmark {
             op_status = db_.db->Delete(w_op, key);
             thread->stats.FinishedOps(nullptr, db, entries_per_batch_, kDelete);
           } break;
+          // BATCHREAD 只是 MultiGet 批次的统计标签，op_chooser_ 不会选中它
+          case ycsbc::BATCHREAD:
           case ycsbc::MAXOPTYPE:
             throw ycsbc::utils::Exception(
                 "Operation request is not recognized!");
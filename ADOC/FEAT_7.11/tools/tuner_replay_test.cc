@@ -0,0 +1,199 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+#include "tools/tuner_replay_tool.h"
+
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class TunerReplayTest : public testing::Test {
+ public:
+  TunerReplayTest() {
+    env_ = Env::Default();
+    test_path_ = test::PerThreadDBPath("tuner_replay_test");
+    EXPECT_OK(env_->CreateDirIfMissing(test_path_));
+    trace_file_path_ = test_path_ + "/tuner_trace";
+  }
+
+  ~TunerReplayTest() override {
+    if (env_->FileExists(trace_file_path_).ok()) {
+      EXPECT_OK(env_->DeleteFile(trace_file_path_));
+    }
+    EXPECT_OK(env_->DeleteDir(test_path_));
+  }
+
+  // 每秒一轮，客户端一直以 `mbps` 写入
+  static std::vector<TunerTraceRecord> SteadyLoad(int rounds, uint64_t mbps) {
+    std::vector<TunerTraceRecord> trace;
+    for (int i = 0; i < rounds; i++) {
+      TunerTraceRecord record;
+      record.secs_elapsed = i;
+      record.scores.timestamp_micros = static_cast<uint64_t>(i) * 1000000;
+      record.scores.memtable_speed = mbps;
+      record.max_background_jobs = 4;
+      record.write_buffer_size = 64 << 20;
+      trace.push_back(record);
+    }
+    return trace;
+  }
+
+  Env* env_;
+  std::string test_path_;
+  std::string trace_file_path_;
+};
+
+// 测试：trace 写入后能原样读回
+TEST_F(TunerReplayTest, TraceRoundTrip) {
+  // 1. Arrange
+  TunerTraceRecord record;
+  record.secs_elapsed = 42;
+  record.scores.timestamp_micros = 123456789;
+  record.scores.memtable_speed = 80;
+  record.scores.l0_num = 0.75;
+  record.scores.memtable_fill = 0.5;
+  record.scores.flush_numbers = 3;
+  record.op = TuningOP{kHalf, kLinearIncrease};
+  record.max_background_jobs = 6;
+  record.write_buffer_size = 128 << 20;
+  record.op.CompactionOp = kLinearIncrease;
+  record.max_subcompactions = 3;
+  record.compaction_readahead_size = 2 << 20;
+  record.rate_limiter_bytes_per_sec = 100 << 20;
+  std::unique_ptr<TunerTraceWriter> writer;
+
+  // 2. Act
+  ASSERT_OK(TunerTraceWriter::Create(env_, trace_file_path_, &writer));
+  ASSERT_OK(writer->Append(record));
+  ASSERT_OK(writer->Append(record));
+  ASSERT_OK(writer->Close());
+  std::vector<TunerTraceRecord> records;
+  ASSERT_OK(ReadTunerTrace(env_, trace_file_path_, &records));
+
+  // 3. Assert
+  ASSERT_EQ(records.size(), 2u);
+  const auto& read = records[1];
+  ASSERT_EQ(read.secs_elapsed, 42);
+  ASSERT_EQ(read.scores.timestamp_micros, 123456789u);
+  ASSERT_EQ(read.scores.memtable_speed, 80u);
+  ASSERT_DOUBLE_EQ(read.scores.l0_num, 0.75);
+  ASSERT_DOUBLE_EQ(read.scores.memtable_fill, 0.5);
+  ASSERT_EQ(read.scores.flush_numbers, 3);
+  ASSERT_EQ(read.op.BatchOp, kHalf);
+  ASSERT_EQ(read.op.ThreadOp, kLinearIncrease);
+  ASSERT_EQ(read.max_background_jobs, 6);
+  ASSERT_EQ(read.write_buffer_size, 128u << 20);
+  ASSERT_EQ(read.op.CompactionOp, kLinearIncrease);
+  ASSERT_EQ(read.max_subcompactions, 3u);
+  ASSERT_EQ(read.compaction_readahead_size, 2u << 20);
+  ASSERT_EQ(read.rate_limiter_bytes_per_sec, 100 << 20);
+}
+
+// 测试：flush 跟不上写入时模型会停写，跟得上时不会
+TEST_F(TunerReplayTest, FlowModelStallsWhenFlushFallsBehind) {
+  // 1. Arrange
+  LsmFlowModelOptions slow;
+  slow.flush_mbps_per_thread = 10;
+  slow.compaction_mbps_per_thread = 10;
+  slow.device_mbps = 10;
+  LsmFlowModelOptions fast = slow;
+  fast.flush_mbps_per_thread = 1000;
+  fast.compaction_mbps_per_thread = 1000;
+  fast.device_mbps = 4000;
+  LsmFlowModel slow_model(slow, 4, 64 << 20);
+  LsmFlowModel fast_model(fast, 4, 64 << 20);
+
+  // 2. Act
+  for (int i = 0; i < 60; i++) {
+    slow_model.Step(1, 100);
+    fast_model.Step(1, 100);
+  }
+
+  // 3. Assert
+  ASSERT_GT(slow_model.stopped_secs(), 0);
+  ASSERT_LT(slow_model.accepted_mb(), 60 * 100);
+  ASSERT_EQ(fast_model.stopped_secs(), 0);
+  ASSERT_NEAR(fast_model.accepted_mb(), 60 * 100, 1e-6);
+}
+
+// 测试：同一份 trace 和阈值回放的结果是确定的，阈值原样带回
+TEST_F(TunerReplayTest, ReplayIsDeterministic) {
+  // 1. Arrange
+  auto trace = SteadyLoad(120, 200);
+  LsmFlowModelOptions model_options;
+  model_options.flush_mbps_per_thread = 50;
+  model_options.Calibrate(trace);
+  TunerThresholds thresholds;
+  thresholds.TEA_slow_flush = 0.7;
+  Options options;
+
+  // 2. Act
+  auto first = ReplayTunerTrace(trace, model_options, options,
+                                ReplayTunerType::kFEAT, true, true, thresholds);
+  auto second = ReplayTunerTrace(trace, model_options, options,
+                                 ReplayTunerType::kFEAT, true, true, thresholds);
+
+  // 3. Assert
+  ASSERT_DOUBLE_EQ(first.thresholds.TEA_slow_flush, 0.7);
+  ASSERT_GT(first.accepted_mb, 0);
+  ASSERT_LE(first.avg_mbps, 200);
+  ASSERT_DOUBLE_EQ(first.accepted_mb, second.accepted_mb);
+  ASSERT_DOUBLE_EQ(first.stopped_secs, second.stopped_secs);
+  ASSERT_EQ(first.thread_changes, second.thread_changes);
+  ASSERT_EQ(first.final_write_buffer_size, second.final_write_buffer_size);
+}
+
+// 测试：一轮打分里的线程池空闲时间会进入 last_score，写进 trace 后能读回
+TEST_F(TunerReplayTest, IdleTimesReachTheTrace) {
+  // 1. Arrange
+  const std::string db_path = test_path_ + "/db";
+  auto events = std::make_shared<TunerEventListener>(env_);
+  Options options;
+  options.create_if_missing = true;
+  options.listeners.push_back(events);
+  DB* db = nullptr;
+  ASSERT_OK(DB::Open(options, db_path, &db));
+  DOTA_Tuner tuner(options, static_cast<DBImpl*>(db->GetRootDB()), nullptr,
+                   nullptr, env_, 1, events);
+  std::unique_ptr<TunerTraceWriter> writer;
+  ASSERT_OK(TunerTraceWriter::Create(env_, trace_file_path_, &writer));
+
+  // 2. Act
+  env_->SleepForMicroseconds(10000);
+  tuner.ScoreTheSystem();
+  TunerTraceRecord record;
+  record.scores = tuner.last_score();
+  ASSERT_OK(writer->Append(record));
+  ASSERT_OK(writer->Close());
+  std::vector<TunerTraceRecord> records;
+  ASSERT_OK(ReadTunerTrace(env_, trace_file_path_, &records));
+  delete db;
+  ASSERT_OK(DestroyDB(db_path, options));
+
+  // 3. Assert
+  // 没有后台任务在跑，两个线程池整轮都是空闲的
+  ASSERT_EQ(records.size(), 1u);
+  ASSERT_GT(records[0].scores.flush_idle_time, 0);
+  ASSERT_GT(records[0].scores.compaction_idle_time, 0);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "tuner_replay_test is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,429 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+#include "tools/tuner_replay_tool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+#include "rocksdb/utilities/report_agent.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// SystemScores use 1e6 bytes as MB, and bytes per micro as MB/s
+const double kMB = 1000000.0;
+
+// Feeds the tuner with the scores of the flow model instead of a DB
+template <class Tuner>
+class ModelDrivenTuner : public Tuner {
+ public:
+  template <class... Args>
+  explicit ModelDrivenTuner(const LsmFlowModel* model, Args&&... args)
+      : Tuner(std::forward<Args>(args)...), model_(model) {}
+
+  SystemScores ScoreTheSystem() override {
+    this->cf_scores_.assign(1, model_->scores());
+    this->RecordColumnFamily(this->cf_scores_[0]);
+    this->last_score_ = model_->scores().scores;
+    return this->last_score_;
+  }
+
+ private:
+  const LsmFlowModel* model_;
+};
+}  // namespace
+
+void LsmFlowModelOptions::Calibrate(const std::vector<TunerTraceRecord>& trace) {
+  double max_flush_mbps = 0;
+  double max_disk_mbps = 0;
+  for (size_t i = 0; i < trace.size(); i++) {
+    const SystemScores& score = trace[i].scores;
+    if (score.flush_numbers > 0) {
+      max_flush_mbps = std::max(max_flush_mbps, score.flush_speed_avg);
+    }
+    if (i > 0 && score.timestamp_micros > trace[i - 1].scores.timestamp_micros) {
+      double secs =
+          (score.timestamp_micros - trace[i - 1].scores.timestamp_micros) /
+          kMB;
+      max_disk_mbps = std::max(max_disk_mbps, score.disk_bandwidth / secs);
+    }
+  }
+  // 空闲设备上单个线程能跑到的最快 flush 速度，就是一个线程的带宽
+  if (flush_mbps_per_thread <= 0) {
+    flush_mbps_per_thread = max_flush_mbps > 0 ? max_flush_mbps : 100;
+  }
+  if (compaction_mbps_per_thread <= 0) {
+    compaction_mbps_per_thread = flush_mbps_per_thread;
+  }
+  if (device_mbps <= 0) {
+    device_mbps = std::max(max_disk_mbps, flush_mbps_per_thread);
+  }
+}
+
+LsmFlowModel::LsmFlowModel(const LsmFlowModelOptions& options,
+                           int max_background_jobs,
+                           uint64_t write_buffer_size)
+    : options_(options),
+      max_background_jobs_(std::max(max_background_jobs, 2)),
+      write_buffer_size_(write_buffer_size) {
+  scores_.name = kDefaultColumnFamilyName;
+  scores_.write_buffer_size = write_buffer_size_;
+  scores_.max_write_buffer_number = options_.max_write_buffer_number;
+  scores_.level0_file_num_compaction_trigger =
+      options_.level0_file_num_compaction_trigger;
+  scores_.min_write_buffer_number_to_merge = 1;
+}
+
+void LsmFlowModel::Apply(const DBImpl::TuningUpdate& update) {
+  if (update.max_background_jobs > 0) {
+    max_background_jobs_ = update.max_background_jobs;
+  }
+  for (const auto& cf : update.column_families) {
+    if (cf.cf_id == 0 && cf.write_buffer_size > 0) {
+      write_buffer_size_ = cf.write_buffer_size;
+    }
+  }
+}
+
+void LsmFlowModel::Step(double secs, double offered_mbps) {
+  const double wbs_mb = write_buffer_size_ / kMB;
+  const size_t max_immutables =
+      static_cast<size_t>(std::max(options_.max_write_buffer_number, 1));
+  // flush threads always get 1/4 of all
+  const int flush_threads = std::max(1, max_background_jobs_ / 4);
+  const int compaction_threads =
+      std::max(1, max_background_jobs_ - flush_threads);
+  now_secs_ += secs;
+
+  // 1. 写入准入，和 WriteController 一样先看 stop 再看 delay
+  const int l0_files = static_cast<int>(l0_files_mb_.size());
+  bool stopped = immutable_mb_.size() >= max_immutables ||
+                 l0_files >= options_.level0_stop_writes_trigger ||
+                 pending_mb_ >= options_.hard_pending_compaction_mb;
+  bool delayed =
+      !stopped && (l0_files >= options_.level0_slowdown_writes_trigger ||
+                   pending_mb_ >= options_.soft_pending_compaction_mb ||
+                   (max_immutables > 3 &&
+                    immutable_mb_.size() >= max_immutables - 1));
+  double accepted = 0;
+  if (stopped) {
+    stopped_secs_ += secs;
+  } else {
+    accepted = offered_mbps * secs;
+    if (delayed) {
+      delayed_secs_ += secs;
+      accepted *= options_.delayed_write_ratio;
+    }
+  }
+
+  // 2. 写满的 memtable 封存成 immutable，immutable 满了就挡住多出来的写入
+  active_mb_ += accepted;
+  int sealed = 0;
+  while (active_mb_ >= wbs_mb && immutable_mb_.size() < max_immutables) {
+    immutable_mb_.push_back(wbs_mb);
+    active_mb_ -= wbs_mb;
+    sealed++;
+  }
+  if (active_mb_ > wbs_mb) {
+    accepted -= active_mb_ - wbs_mb;
+    active_mb_ = wbs_mb;
+  }
+  accepted_mb_ += accepted;
+
+  // 3. 忙着的后台线程平分设备带宽
+  const int flushing = std::min(flush_threads,
+                                static_cast<int>(immutable_mb_.size()));
+  const bool compacting =
+      static_cast<int>(l0_files_mb_.size()) >=
+          options_.level0_file_num_compaction_trigger ||
+      pending_mb_ > 0;
+  const int busy = flushing + (compacting ? compaction_threads : 0);
+  const double share =
+      busy > 0 ? options_.device_mbps / busy : options_.device_mbps;
+  const double flush_rate = std::min(options_.flush_mbps_per_thread, share);
+  const double compaction_rate =
+      std::min(options_.compaction_mbps_per_thread, share);
+
+  // 4. flush 按封存顺序写进 L0，每个 memtable 变成一个 L0 文件
+  int flushes = 0;
+  double flushed_mb = 0;
+  flush_progress_mb_ += flushing * flush_rate * secs;
+  while (!immutable_mb_.empty() && flush_progress_mb_ >= immutable_mb_.front()) {
+    double mb = immutable_mb_.front();
+    immutable_mb_.erase(immutable_mb_.begin());
+    flush_progress_mb_ -= mb;
+    l0_files_mb_.push_back(mb);
+    pending_mb_ += mb * options_.compaction_write_amp;
+    flushed_mb += mb;
+    flushes++;
+  }
+  if (immutable_mb_.empty()) {
+    flush_progress_mb_ = 0;
+  }
+
+  // 5. compaction 先把 L0 合进 L1 (读写 L0 和同样多的 L1)，再还 pending bytes
+  double capacity =
+      compacting ? compaction_threads * compaction_rate * secs : 0;
+  double compacted_mb = 0;
+  if (static_cast<int>(l0_files_mb_.size()) >=
+      options_.level0_file_num_compaction_trigger) {
+    while (!l0_files_mb_.empty() && capacity >= 2 * l0_files_mb_.front()) {
+      double cost = 2 * l0_files_mb_.front();
+      l0_files_mb_.erase(l0_files_mb_.begin());
+      capacity -= cost;
+      compacted_mb += cost;
+    }
+  }
+  compacted_mb += std::min(capacity, std::max(pending_mb_ - compacted_mb, 0.0));
+  pending_mb_ = std::max(pending_mb_ - compacted_mb, 0.0);
+
+  // 6. 按 ScoreTheSystem() 的口径打分
+  SystemScores& score = scores_.scores;
+  score = SystemScores();
+  score.timestamp_micros = static_cast<uint64_t>(now_secs_ * kMB);
+  score.memtable_speed = static_cast<uint64_t>(accepted / secs);
+  score.active_size_ratio = active_mb_ / wbs_mb;
+  score.immutable_number = static_cast<int>(immutable_mb_.size());
+  score.memtable_fill = (score.immutable_number + score.active_size_ratio) /
+                        static_cast<double>(max_immutables);
+  score.flush_numbers = flushes;
+  if (flushes > 0) {
+    score.flush_speed_avg = flush_rate;
+    score.flush_min = flush_rate;
+  }
+  score.l0_num = static_cast<double>(l0_files_mb_.size()) /
+                 options_.level0_slowdown_writes_trigger;
+  score.estimate_compaction_bytes =
+      pending_mb_ / options_.soft_pending_compaction_mb;
+  score.disk_bandwidth = flushed_mb + compacted_mb;
+  double window_micros = secs * kMB;
+  double flush_busy_micros = flush_rate > 0 ? flushed_mb / flush_rate * kMB : 0;
+  double compaction_busy_micros =
+      compaction_rate > 0 ? compacted_mb / compaction_rate * kMB : 0;
+  score.flush_idle_time =
+      std::max(flush_threads * window_micros - flush_busy_micros, 0.0) /
+      (max_background_jobs_ * kMB / 4);
+  score.compaction_idle_time =
+      std::max(compaction_threads * window_micros - compaction_busy_micros,
+               0.0) /
+      (max_background_jobs_ * kMB * 3 / 4);
+
+  scores_.sealed_memtables = sealed;
+  scores_.ingest_bytes = static_cast<uint64_t>(accepted * kMB);
+  scores_.write_buffer_size = write_buffer_size_;
+}
+
+ReplayResult ReplayTunerTrace(const std::vector<TunerTraceRecord>& trace,
+                              const LsmFlowModelOptions& model_options,
+                              const Options& db_options, ReplayTunerType type,
+                              bool TEA_enable, bool FEA_enable,
+                              const TunerThresholds& thresholds) {
+  ReplayResult result;
+  result.thresholds = thresholds;
+  if (trace.size() < 2) {
+    return result;
+  }
+
+  // 从录制开始时的配置出发
+  Options options = db_options;
+  options.max_background_jobs = trace.front().max_background_jobs;
+  options.write_buffer_size = trace.front().write_buffer_size;
+  LsmFlowModel model(model_options, options.max_background_jobs,
+                     options.write_buffer_size);
+
+  double gap_secs = (trace[1].scores.timestamp_micros -
+                     std::min(trace[1].scores.timestamp_micros,
+                              trace[0].scores.timestamp_micros)) /
+                    kMB;
+  uint64_t tuning_gap = std::max<uint64_t>(1, std::llround(gap_secs));
+  int64_t last_report = 0;
+  std::atomic<int64_t> total_ops_done{0};
+  std::unique_ptr<DOTA_Tuner> tuner;
+  if (type == ReplayTunerType::kDOTA) {
+    tuner.reset(new ModelDrivenTuner<DOTA_Tuner>(
+        &model, options, nullptr, &last_report, &total_ops_done,
+        Env::Default(), tuning_gap, nullptr));
+  } else {
+    tuner.reset(new ModelDrivenTuner<FEAT_Tuner>(
+        &model, options, nullptr, &last_report, &total_ops_done,
+        Env::Default(), static_cast<int>(tuning_gap), nullptr, TEA_enable,
+        FEA_enable));
+  }
+  tuner->set_idle_ratio(thresholds.idle_threshold);
+  tuner->set_slow_flush_threshold(thresholds.TEA_slow_flush);
+
+  double elapsed_secs = 0;
+  for (size_t i = 1; i < trace.size(); i++) {
+    const TunerTraceRecord& record = trace[i];
+    const uint64_t prev = trace[i - 1].scores.timestamp_micros;
+    double secs = record.scores.timestamp_micros > prev
+                      ? (record.scores.timestamp_micros - prev) / kMB
+                      : static_cast<double>(tuning_gap);
+    // 录制时真正写进 memtable 的速度作为客户端的写入压力
+    model.Step(secs, static_cast<double>(record.scores.memtable_speed));
+    elapsed_secs += secs;
+
+    DBImpl::TuningUpdate update;
+    tuner->DetectTuningOperations(record.secs_elapsed, &update);
+    if (update.max_background_jobs > 0 &&
+        update.max_background_jobs != model.max_background_jobs()) {
+      result.thread_changes++;
+    }
+    if (!update.column_families.empty()) {
+      result.batch_changes++;
+    }
+    model.Apply(update);
+  }
+
+  result.accepted_mb = model.accepted_mb();
+  result.avg_mbps = elapsed_secs > 0 ? model.accepted_mb() / elapsed_secs : 0;
+  result.stopped_secs = model.stopped_secs();
+  result.delayed_secs = model.delayed_secs();
+  result.final_max_background_jobs = model.max_background_jobs();
+  result.final_write_buffer_size = model.write_buffer_size();
+  return result;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#ifdef GFLAGS
+#include "util/gflags_compat.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+DEFINE_string(tuner_trace_file, "",
+              "The tuner trace recorded by db_bench --tuner_trace_file.");
+DEFINE_string(tuner, "FEAT", "The tuner to replay, DOTA or FEAT.");
+DEFINE_bool(TEA_enable, true, "Trigger FEAT tuner's TEA component");
+DEFINE_bool(FEA_enable, true, "Trigger FEAT tuner's FEA component");
+DEFINE_string(idle_thresholds, "2.5",
+              "Comma separated idle_threshold values to sweep");
+DEFINE_string(TEA_slow_flushes, "0.5",
+              "Comma separated TEA_slow_flush values to sweep");
+DEFINE_int64(core_num, 20, "The limit of thread number");
+DEFINE_int64(max_memtable_size, ROCKSDB_NAMESPACE::Options().max_memtable_size,
+             "The size of Max batch size");
+
+DEFINE_double(flush_mbps_per_thread, 0,
+              "Flush bandwidth of one thread, 0 calibrates it from the trace");
+DEFINE_double(compaction_mbps_per_thread, 0,
+              "Compaction bandwidth of one thread, 0 uses the flush one");
+DEFINE_double(device_mbps, 0,
+              "Bandwidth shared by all threads, 0 calibrates it from the "
+              "trace");
+DEFINE_double(compaction_write_amp, 10,
+              "Compaction bytes caused by every flushed byte");
+DEFINE_int32(max_write_buffer_number, 2, "Same as the column family option");
+DEFINE_int32(level0_file_num_compaction_trigger, 4,
+             "Same as the column family option");
+DEFINE_int32(level0_slowdown_writes_trigger, 20,
+             "Same as the column family option");
+DEFINE_int32(level0_stop_writes_trigger, 36,
+             "Same as the column family option");
+DEFINE_double(soft_pending_compaction_mb, 64 << 10,
+              "soft_pending_compaction_bytes_limit in MB");
+DEFINE_double(hard_pending_compaction_mb, 256 << 10,
+              "hard_pending_compaction_bytes_limit in MB");
+DEFINE_double(delayed_write_ratio, 0.5,
+              "Share of the offered writes accepted while writes are delayed");
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+std::vector<double> ParseValues(const std::string& values) {
+  std::vector<double> result;
+  std::stringstream ss(values);
+  std::string value;
+  while (std::getline(ss, value, ',')) {
+    if (!value.empty()) {
+      result.push_back(std::stod(value));
+    }
+  }
+  return result;
+}
+}  // namespace
+
+int tuner_replay(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " --tuner_trace_file=<trace> [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+
+  std::vector<TunerTraceRecord> trace;
+  Status s = ReadTunerTrace(Env::Default(), FLAGS_tuner_trace_file, &trace);
+  if (!s.ok()) {
+    fprintf(stderr, "Can't read %s: %s\n", FLAGS_tuner_trace_file.c_str(),
+            s.ToString().c_str());
+    return 1;
+  }
+  ReplayTunerType type;
+  if (FLAGS_tuner == "DOTA") {
+    type = ReplayTunerType::kDOTA;
+  } else if (FLAGS_tuner == "FEAT") {
+    type = ReplayTunerType::kFEAT;
+  } else {
+    fprintf(stderr, "Unknown tuner %s\n", FLAGS_tuner.c_str());
+    return 1;
+  }
+
+  LsmFlowModelOptions model_options;
+  model_options.flush_mbps_per_thread = FLAGS_flush_mbps_per_thread;
+  model_options.compaction_mbps_per_thread = FLAGS_compaction_mbps_per_thread;
+  model_options.device_mbps = FLAGS_device_mbps;
+  model_options.compaction_write_amp = FLAGS_compaction_write_amp;
+  model_options.max_write_buffer_number = FLAGS_max_write_buffer_number;
+  model_options.level0_file_num_compaction_trigger =
+      FLAGS_level0_file_num_compaction_trigger;
+  model_options.level0_slowdown_writes_trigger =
+      FLAGS_level0_slowdown_writes_trigger;
+  model_options.level0_stop_writes_trigger = FLAGS_level0_stop_writes_trigger;
+  model_options.soft_pending_compaction_mb = FLAGS_soft_pending_compaction_mb;
+  model_options.hard_pending_compaction_mb = FLAGS_hard_pending_compaction_mb;
+  model_options.delayed_write_ratio = FLAGS_delayed_write_ratio;
+  model_options.Calibrate(trace);
+
+  Options db_options;
+  db_options.core_number = FLAGS_core_num;
+  db_options.max_memtable_size = FLAGS_max_memtable_size;
+
+  std::vector<ReplayResult> results;
+  for (double idle : ParseValues(FLAGS_idle_thresholds)) {
+    for (double slow_flush : ParseValues(FLAGS_TEA_slow_flushes)) {
+      TunerThresholds thresholds;
+      thresholds.idle_threshold = idle;
+      thresholds.TEA_slow_flush = slow_flush;
+      results.push_back(ReplayTunerTrace(trace, model_options, db_options,
+                                         type, FLAGS_TEA_enable,
+                                         FLAGS_FEA_enable, thresholds));
+    }
+  }
+
+  fprintf(stdout,
+          "# %zu rounds, flush %.1f MB/s per thread, compaction %.1f MB/s "
+          "per thread, device %.1f MB/s\n",
+          trace.size(), model_options.flush_mbps_per_thread,
+          model_options.compaction_mbps_per_thread, model_options.device_mbps);
+  fprintf(stdout,
+          "idle_threshold,TEA_slow_flush,avg_mbps,"
+          "stopped_secs,delayed_secs,thread_changes,batch_changes,"
+          "final_thread_num,final_batch_size_mb\n");
+  for (const auto& r : results) {
+    fprintf(stdout, "%g,%g,%.2f,%.1f,%.1f,%d,%d,%d,%" PRIu64 "\n",
+            r.thresholds.idle_threshold, r.thresholds.TEA_slow_flush, r.avg_mbps, r.stopped_secs,
+            r.delayed_secs, r.thread_changes, r.batch_changes,
+            r.final_max_background_jobs, r.final_write_buffer_size >> 20);
+  }
+  return 0;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // GFLAGS
+#endif  // ROCKSDB_LITE
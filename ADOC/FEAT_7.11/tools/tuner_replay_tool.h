@@ -0,0 +1,115 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/utilities/DOTA_trace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Settings of the LSM flow model. Sizes are in MB and rates in MB/s, like the
+// SystemScores they produce.
+struct LsmFlowModelOptions {
+  // Bandwidth of one flush / compaction thread on an idle device, 0 means
+  // calibrate from the trace
+  double flush_mbps_per_thread = 0;
+  double compaction_mbps_per_thread = 0;
+  // Bandwidth shared by all background threads, 0 means calibrate
+  double device_mbps = 0;
+  // Compaction bytes caused by every flushed byte
+  double compaction_write_amp = 10;
+
+  int max_write_buffer_number = 2;
+  int level0_file_num_compaction_trigger = 4;
+  int level0_slowdown_writes_trigger = 20;
+  int level0_stop_writes_trigger = 36;
+  double soft_pending_compaction_mb = 64 << 10;
+  double hard_pending_compaction_mb = 256 << 10;
+  // Share of the offered load accepted while writes are delayed
+  double delayed_write_ratio = 0.5;
+
+  // Fills the rates left at 0 from a recorded trace
+  void Calibrate(const std::vector<TunerTraceRecord>& trace);
+};
+
+// A coarse model of an LSM tree: the clients offer a write rate, memtables
+// are sealed and flushed into L0, and compaction drains L0 and the pending
+// bytes with the threads it gets. Flush and compaction threads share the
+// device bandwidth, so adding threads can slow every one of them down.
+class LsmFlowModel {
+ public:
+  LsmFlowModel(const LsmFlowModelOptions& options, int max_background_jobs,
+               uint64_t write_buffer_size);
+
+  // Advances the model `secs` seconds with `offered_mbps` of client writes
+  void Step(double secs, double offered_mbps);
+  void Apply(const DBImpl::TuningUpdate& update);
+
+  // Scores of the last Step(), as ScoreTheSystem() reports them for one
+  // column family
+  const ColumnFamilyScores& scores() const { return scores_; }
+
+  int max_background_jobs() const { return max_background_jobs_; }
+  uint64_t write_buffer_size() const { return write_buffer_size_; }
+  double accepted_mb() const { return accepted_mb_; }
+  double stopped_secs() const { return stopped_secs_; }
+  double delayed_secs() const { return delayed_secs_; }
+
+ private:
+  LsmFlowModelOptions options_;
+  int max_background_jobs_;
+  uint64_t write_buffer_size_;
+
+  double now_secs_ = 0;
+  double active_mb_ = 0;
+  std::vector<double> immutable_mb_;
+  double flush_progress_mb_ = 0;
+  std::vector<double> l0_files_mb_;
+  double pending_mb_ = 0;
+
+  double accepted_mb_ = 0;
+  double stopped_secs_ = 0;
+  double delayed_secs_ = 0;
+  ColumnFamilyScores scores_;
+};
+
+// Tuner settings swept by the replay. FEA_gap_threshold is not swept, no
+// decision of the tuner reads it
+struct TunerThresholds {
+  double idle_threshold = 2.5;
+  double TEA_slow_flush = 0.5;
+};
+
+struct ReplayResult {
+  TunerThresholds thresholds;
+  double accepted_mb = 0;
+  double avg_mbps = 0;
+  double stopped_secs = 0;
+  double delayed_secs = 0;
+  int thread_changes = 0;
+  int batch_changes = 0;
+  int final_max_background_jobs = 0;
+  uint64_t final_write_buffer_size = 0;
+};
+
+enum class ReplayTunerType { kDOTA, kFEAT };
+
+// Replays the client load of `trace` against the flow model, with a tuner of
+// `type` deciding every round like it does in db_bench.
+ReplayResult ReplayTunerTrace(const std::vector<TunerTraceRecord>& trace,
+                              const LsmFlowModelOptions& model_options,
+                              const Options& db_options, ReplayTunerType type,
+                              bool TEA_enable, bool FEA_enable,
+                              const TunerThresholds& thresholds);
+
+int tuner_replay(int argc, char** argv);
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,20 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// YCSB driver of ycsbcore, e.g.
+//   ycsbc -load -run -db rocksdb -threads 8 -s
+//         -P ycsb_workload/workloada -P ycsb_workload/rocksdb
+#ifndef ROCKSDB_LITE
+int ycsbc_main(const int argc, const char *argv[]);
+int main(int argc, char** argv) {
+  return ycsbc_main(argc, const_cast<const char**>(argv));
+}
+#else   // ROCKSDB_LITE
+#include <stdio.h>
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "Not supported in lite mode.\n");
+  return 1;
+}
+#endif  // ROCKSDB_LITE
@@ -97,4 +97,21 @@ void CompactionJobStats::Add(const CompactionJobStats& /*stats*/) {}
 
 #endif  // !ROCKSDB_LITE
 
+void QuicksandMetrics::Reset() {
+  input_level = 0;
+  output_level = 1;
+  drop_ratio = 0.0;
+  write_out_bandwidth = 0.0;
+  read_in_bandwidth = 0.0;
+  max_bg_compaction = 0;
+  max_bg_flush = 0;
+  cpu_time_ratio = 0.0;
+  total_micros = 0.0;
+  write_amplification = 0.0;
+  total_bytes = 0;
+  current_pending_bytes = 0;
+  immu_num = 0;
+  io_stat.Reset();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,143 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "port/port.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A fixed-capacity ring of metric records, shared between the background
+// threads that produce them (flush / compaction jobs) and the tuner that
+// consumes them.
+//
+// Writers take a ticket from a single atomic counter, so every ticket maps
+// to exactly one slot and one lap of the ring. Each slot carries a sequence
+// number (seqlock style): odd while the record is being written, and
+// 2 * (ticket + 1) once it is published. A writer that laps the ring waits
+// for the previous owner of the slot to publish first, so each slot has a
+// single writer at a time.
+//
+// Records are copied in and out as relaxed atomic words, so a reader racing
+// with a writer reads a torn copy (and throws it away) rather than invoking a
+// data race.
+//
+// Readers keep their own cursor (the next ticket to read) and never block
+// writers. Records overwritten before the reader got to them are counted as
+// dropped. Memory stays at `capacity` records however long the DB runs.
+template <typename T>
+class MetricsRing {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "MetricsRing records are copied as raw words");
+
+ public:
+  // `capacity` is rounded up to a power of two.
+  explicit MetricsRing(size_t capacity = kDefaultCapacity)
+      : capacity_(RoundUpToPowerOfTwo(capacity)),
+        mask_(capacity_ - 1),
+        slots_(new Slot[capacity_]) {}
+
+  MetricsRing(const MetricsRing&) = delete;
+  MetricsRing& operator=(const MetricsRing&) = delete;
+
+  void Push(const T& record) {
+    const uint64_t ticket =
+        next_ticket_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[ticket & mask_];
+    // 上一圈的写者还没写完，等它发布后再覆盖
+    const uint64_t previous =
+        ticket < capacity_ ? 0 : Published(ticket - capacity_);
+    while (slot.seq.load(std::memory_order_acquire) != previous) {
+      port::AsmVolatilePause();
+    }
+    uint64_t words[kWords] = {};
+    memcpy(words, &record, sizeof(T));
+    slot.seq.store(Published(ticket) - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) {
+      slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.seq.store(Published(ticket), std::memory_order_release);
+  }
+
+  // Appends to `out` every record published since `*cursor` and moves the
+  // cursor past them. Stops at the first record still being written, it is
+  // picked up by the next call. Returns the number of records that were
+  // overwritten before they could be read.
+  uint64_t ReadSince(uint64_t* cursor, std::vector<T>* out) const {
+    const uint64_t end = next_ticket_.load(std::memory_order_acquire);
+    uint64_t dropped = 0;
+    uint64_t ticket = *cursor;
+    if (end - ticket > capacity_) {
+      dropped += end - capacity_ - ticket;
+      ticket = end - capacity_;
+    }
+    for (; ticket < end; ticket++) {
+      const Slot& slot = slots_[ticket & mask_];
+      const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+      if (seq < Published(ticket)) {
+        break;
+      }
+      uint64_t words[kWords];
+      for (size_t i = 0; i < kWords; i++) {
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq != Published(ticket) ||
+          slot.seq.load(std::memory_order_relaxed) != seq) {
+        dropped++;
+        continue;
+      }
+      T record;
+      memcpy(&record, words, sizeof(T));
+      out->push_back(record);
+    }
+    *cursor = ticket;
+    return dropped;
+  }
+
+  // Number of records ever pushed, i.e. the cursor of a reader that is
+  // caught up.
+  uint64_t Size() const {
+    return next_ticket_.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const { return capacity_; }
+
+  static constexpr size_t kDefaultCapacity = 4096;
+
+ private:
+  static constexpr size_t kWords = (sizeof(T) + 7) / 8;
+
+  struct Slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<uint64_t> words[kWords] = {};
+  };
+
+  static uint64_t Published(uint64_t ticket) { return 2 * (ticket + 1); }
+
+  static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t result = 1;
+    while (result < n) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> next_ticket_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,129 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/metrics_ring.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "port/stack_trace.h"
+#include "rocksdb/compaction_job_stats.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class MetricsRingTest : public testing::Test {};
+
+// 测试：读者只拿到上次游标之后的记录
+TEST_F(MetricsRingTest, ReadSinceCursor) {
+  // 1. Arrange
+  MetricsRing<FlushMetrics> ring(8);
+  uint64_t cursor = 0;
+  for (int i = 0; i < 3; i++) {
+    FlushMetrics m;
+    m.total_bytes = i;
+    ring.Push(m);
+  }
+
+  // 2. Act
+  std::vector<FlushMetrics> first;
+  ASSERT_EQ(ring.ReadSince(&cursor, &first), 0u);
+  FlushMetrics m;
+  m.total_bytes = 3;
+  ring.Push(m);
+  std::vector<FlushMetrics> second;
+  ASSERT_EQ(ring.ReadSince(&cursor, &second), 0u);
+
+  // 3. Assert
+  ASSERT_EQ(first.size(), 3u);
+  ASSERT_EQ(first[2].total_bytes, 2u);
+  ASSERT_EQ(second.size(), 1u);
+  ASSERT_EQ(second[0].total_bytes, 3u);
+  ASSERT_EQ(cursor, ring.Size());
+}
+
+// 测试：写满一圈以上时，旧记录计为丢弃，内存不增长
+TEST_F(MetricsRingTest, OverwrittenRecordsAreDropped) {
+  // 1. Arrange
+  MetricsRing<QuicksandMetrics> ring(5);
+  ASSERT_EQ(ring.capacity(), 8u);
+  uint64_t cursor = 0;
+  for (int i = 0; i < 20; i++) {
+    QuicksandMetrics m;
+    m.total_bytes = i;
+    ring.Push(m);
+  }
+
+  // 2. Act
+  std::vector<QuicksandMetrics> out;
+  uint64_t dropped = ring.ReadSince(&cursor, &out);
+
+  // 3. Assert
+  ASSERT_EQ(dropped, 12u);
+  ASSERT_EQ(out.size(), 8u);
+  ASSERT_EQ(out.front().total_bytes, 12u);
+  ASSERT_EQ(out.back().total_bytes, 19u);
+  ASSERT_EQ(cursor, 20u);
+}
+
+// 测试：多个写线程并发写，读线程同时读，每条读到的记录都是完整的
+TEST_F(MetricsRingTest, ConcurrentWritersAndReader) {
+  // 1. Arrange
+  constexpr int kWriters = 4;
+  constexpr int kPerWriter = 20000;
+  MetricsRing<FlushMetrics> ring(64);
+  std::atomic<bool> done{false};
+  uint64_t read = 0;
+  uint64_t dropped = 0;
+  bool torn = false;
+
+  // 2. Act
+  std::thread reader([&] {
+    uint64_t cursor = 0;
+    std::vector<FlushMetrics> out;
+    while (true) {
+      bool last = done.load();
+      out.clear();
+      dropped += ring.ReadSince(&cursor, &out);
+      for (const auto& m : out) {
+        // 同一条记录的两个字段由写者一起写入
+        torn |= static_cast<int>(m.total_bytes) != m.l0_files;
+      }
+      read += out.size();
+      if (last && cursor == ring.Size()) {
+        break;
+      }
+    }
+  });
+  std::vector<std::thread> writers;
+  for (int w = 0; w < kWriters; w++) {
+    writers.emplace_back([&, w] {
+      for (int i = 0; i < kPerWriter; i++) {
+        FlushMetrics m;
+        m.l0_files = w * kPerWriter + i;
+        m.total_bytes = static_cast<uint64_t>(m.l0_files);
+        ring.Push(m);
+      }
+    });
+  }
+  for (auto& t : writers) {
+    t.join();
+  }
+  done.store(true);
+  reader.join();
+
+  // 3. Assert
+  ASSERT_FALSE(torn);
+  ASSERT_EQ(read + dropped, static_cast<uint64_t>(kWriters * kPerWriter));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
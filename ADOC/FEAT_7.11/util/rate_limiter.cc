@@ -48,7 +48,7 @@ struct GenericRateLimiter::Req {
 GenericRateLimiter::GenericRateLimiter(
     int64_t rate_bytes_per_sec, int64_t refill_period_us, int32_t fairness,
     RateLimiter::Mode mode, const std::shared_ptr<SystemClock>& clock,
-    bool auto_tuned)
+    bool auto_tuned, bool foreground_aware, int64_t min_low_pri_bytes_per_sec)
     : RateLimiter(mode),
       refill_period_us_(refill_period_us),
       rate_bytes_per_sec_(auto_tuned ? rate_bytes_per_sec / 2
@@ -67,7 +67,13 @@ GenericRateLimiter::GenericRateLimiter(
       auto_tuned_(auto_tuned),
       num_drains_(0),
       max_bytes_per_sec_(rate_bytes_per_sec),
-      tuned_time_(NowMicrosMonotonicLocked()) {
+      tuned_time_(NowMicrosMonotonicLocked()),
+      foreground_aware_(foreground_aware),
+      min_low_pri_bytes_per_sec_(std::max(static_cast<int64_t>(0),
+                                          min_low_pri_bytes_per_sec)),
+      foreground_bytes_(0),
+      low_pri_available_bytes_(0),
+      last_refill_us_(NowMicrosMonotonicLocked()) {
   for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
     total_requests_[i] = 0;
     total_bytes_through_[i] = 0;
@@ -137,11 +143,11 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
 
   ++total_requests_[pri];
 
-  if (available_bytes_ >= bytes) {
+  if (GrantableBytesLocked(pri) >= bytes) {
     // Refill thread assigns quota and notifies requests waiting on
     // the queue under mutex. So if we get here, that means nobody
     // is waiting?
-    available_bytes_ -= bytes;
+    ConsumeBytesLocked(pri, bytes);
     total_bytes_through_[pri] += bytes;
     return;
   }
@@ -268,6 +274,9 @@ void GenericRateLimiter::RefillBytesAndGrantRequestsLocked() {
   if (available_bytes_ < refill_bytes_per_period) {
     available_bytes_ += refill_bytes_per_period;
   }
+  if (foreground_aware_) {
+    RefillLowPriBudgetLocked(refill_bytes_per_period);
+  }
 
   std::vector<Env::IOPriority> pri_iteration_order =
       GeneratePriorityIterationOrderLocked();
@@ -278,16 +287,19 @@ void GenericRateLimiter::RefillBytesAndGrantRequestsLocked() {
     auto* queue = &queue_[current_pri];
     while (!queue->empty()) {
       auto* next_req = queue->front();
-      if (available_bytes_ < next_req->request_bytes) {
+      int64_t grantable_bytes = GrantableBytesLocked(current_pri);
+      if (grantable_bytes < next_req->request_bytes) {
         // Grant partial request_bytes to avoid starvation of requests
         // that become asking for more bytes than available_bytes_
         // due to dynamically reduced rate limiter's bytes_per_second that
-        // leads to reduced refill_bytes_per_period hence available_bytes_
-        next_req->request_bytes -= available_bytes_;
-        available_bytes_ = 0;
+        // leads to reduced refill_bytes_per_period hence available_bytes_.
+        // An IO_LOW request capped by the foreground-aware budget only stops
+        // the IO_LOW queue, the others still get the rest of available_bytes_
+        next_req->request_bytes -= grantable_bytes;
+        ConsumeBytesLocked(current_pri, grantable_bytes);
         break;
       }
-      available_bytes_ -= next_req->request_bytes;
+      ConsumeBytesLocked(current_pri, next_req->request_bytes);
       next_req->request_bytes = 0;
       total_bytes_through_[current_pri] += next_req->bytes;
       queue->pop_front();
@@ -299,6 +311,30 @@ void GenericRateLimiter::RefillBytesAndGrantRequestsLocked() {
   }
 }
 
+// for FEAT
+// SILK: deep compactions only get the device bandwidth the clients left over
+// in the last period, so they back off at a load peak and catch up in the
+// valleys. Flushes and L0 compactions are not limited by this budget, they
+// are what keeps the write path free of stalls.
+void GenericRateLimiter::RefillLowPriBudgetLocked(
+    int64_t refill_bytes_per_period) {
+  int64_t now = static_cast<int64_t>(NowMicrosMonotonicLocked());
+  int64_t elapsed_us = std::max(now - last_refill_us_, refill_period_us_);
+  last_refill_us_ = now;
+  int64_t foreground_bytes =
+      foreground_bytes_.exchange(0, std::memory_order_relaxed);
+  // Scale the client bytes seen since the last refill to one period
+  int64_t foreground_bytes_per_period = static_cast<int64_t>(
+      static_cast<double>(foreground_bytes) * refill_period_us_ / elapsed_us);
+  int64_t min_low_pri_bytes_per_period =
+      min_low_pri_bytes_per_sec_ > 0
+          ? CalculateRefillBytesPerPeriodLocked(min_low_pri_bytes_per_sec_)
+          : 0;
+  low_pri_available_bytes_ =
+      std::max(min_low_pri_bytes_per_period,
+               refill_bytes_per_period - foreground_bytes_per_period);
+}
+
 int64_t GenericRateLimiter::CalculateRefillBytesPerPeriodLocked(
     int64_t rate_bytes_per_sec) {
   if (std::numeric_limits<int64_t>::max() / rate_bytes_per_sec <
@@ -375,4 +411,19 @@ RateLimiter* NewGenericRateLimiter(
   return limiter.release();
 }
 
+RateLimiter* NewForegroundAwareRateLimiter(
+    int64_t device_bytes_per_sec, int64_t min_low_pri_bytes_per_sec,
+    int64_t refill_period_us /* = 100 * 1000 */, int32_t fairness /* = 10 */) {
+  assert(device_bytes_per_sec > 0);
+  assert(min_low_pri_bytes_per_sec >= 0);
+  assert(refill_period_us > 0);
+  assert(fairness > 0);
+  std::unique_ptr<RateLimiter> limiter(new GenericRateLimiter(
+      device_bytes_per_sec, refill_period_us, fairness,
+      RateLimiter::Mode::kWritesOnly, SystemClock::Default(),
+      false /* auto_tuned */, true /* foreground_aware */,
+      min_low_pri_bytes_per_sec));
+  return limiter.release();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
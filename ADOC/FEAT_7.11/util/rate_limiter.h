@@ -29,7 +29,8 @@ class GenericRateLimiter : public RateLimiter {
   GenericRateLimiter(int64_t refill_bytes, int64_t refill_period_us,
                      int32_t fairness, RateLimiter::Mode mode,
                      const std::shared_ptr<SystemClock>& clock,
-                     bool auto_tuned);
+                     bool auto_tuned, bool foreground_aware = false,
+                     int64_t min_low_pri_bytes_per_sec = 0);
 
   virtual ~GenericRateLimiter();
 
@@ -44,6 +45,14 @@ class GenericRateLimiter : public RateLimiter {
   virtual void Request(const int64_t bytes, const Env::IOPriority pri,
                        Statistics* stats) override;
 
+  virtual void ReportForegroundBytes(int64_t bytes) override {
+    if (foreground_aware_ && bytes > 0) {
+      foreground_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+  }
+
+  virtual bool IsForegroundAware() const override { return foreground_aware_; }
+
   virtual int64_t GetSingleBurstBytes() const override {
     return refill_bytes_per_period_.load(std::memory_order_relaxed);
   }
@@ -107,6 +116,20 @@ class GenericRateLimiter : public RateLimiter {
   int64_t CalculateRefillBytesPerPeriodLocked(int64_t rate_bytes_per_sec);
   Status TuneLocked();
   void SetBytesPerSecondLocked(int64_t bytes_per_second);
+  void RefillLowPriBudgetLocked(int64_t refill_bytes_per_period);
+  // Bytes of `pri` that can be granted right now
+  int64_t GrantableBytesLocked(Env::IOPriority pri) const {
+    if (foreground_aware_ && pri == Env::IO_LOW) {
+      return std::min(available_bytes_, low_pri_available_bytes_);
+    }
+    return available_bytes_;
+  }
+  void ConsumeBytesLocked(Env::IOPriority pri, int64_t bytes) {
+    available_bytes_ -= bytes;
+    if (foreground_aware_ && pri == Env::IO_LOW) {
+      low_pri_available_bytes_ -= bytes;
+    }
+  }
 
   uint64_t NowMicrosMonotonicLocked() {
     return clock_->NowNanos() / std::milli::den;
@@ -141,6 +164,14 @@ class GenericRateLimiter : public RateLimiter {
   int64_t num_drains_;
   const int64_t max_bytes_per_sec_;
   std::chrono::microseconds tuned_time_;
+
+  // for FEAT, SILK-style arbitration between client writes and IO_LOW
+  const bool foreground_aware_;
+  const int64_t min_low_pri_bytes_per_sec_;
+  std::atomic<int64_t> foreground_bytes_;
+  // Share of the current refill period left to IO_LOW, not carried over
+  int64_t low_pri_available_bytes_;
+  int64_t last_refill_us_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -466,6 +466,59 @@ TEST_F(RateLimiterTest, AutoTuneIncreaseWhenFull) {
   ASSERT_LT(new_bytes_per_sec, orig_bytes_per_sec);
 }
 
+// 测试：前台写满设备带宽时，IO_LOW 只拿到保底带宽，IO_HIGH 不受影响
+TEST_F(RateLimiterTest, ForegroundAwareThrottlesLowPri) {
+  // 1. Arrange
+  const std::chrono::seconds kTimePerRefill(1);
+  const int64_t kDeviceBytesPerSec = 1000;
+  const int64_t kMinLowPriBytesPerSec = 100;
+  const int kRequests = 10;
+  SpecialEnv special_env(Env::Default(), /*time_elapse_only_sleep*/ true);
+  std::unique_ptr<RateLimiter> rate_limiter(new GenericRateLimiter(
+      kDeviceBytesPerSec, std::chrono::microseconds(kTimePerRefill).count(),
+      10 /* fairness */, RateLimiter::Mode::kWritesOnly,
+      special_env.GetSystemClock(), false /* auto_tuned */,
+      true /* foreground_aware */, kMinLowPriBytesPerSec));
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "GenericRateLimiter::Request:PostTimedWait", [&](void* arg) {
+        int64_t time_waited_us = *static_cast<int64_t*>(arg);
+        special_env.SleepForMicroseconds(static_cast<int>(time_waited_us));
+      });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  // 2. Act
+  // 每个 refill 周期前台都写满设备带宽
+  uint64_t low_start = special_env.NowMicros();
+  for (int i = 0; i < kRequests; ++i) {
+    rate_limiter->ReportForegroundBytes(kDeviceBytesPerSec);
+    rate_limiter->Request(kMinLowPriBytesPerSec, Env::IO_LOW,
+                          nullptr /* stats */, RateLimiter::OpType::kWrite);
+  }
+  uint64_t low_elapsed = special_env.NowMicros() - low_start;
+  uint64_t high_start = special_env.NowMicros();
+  for (int i = 0; i < kRequests; ++i) {
+    rate_limiter->ReportForegroundBytes(kDeviceBytesPerSec);
+    rate_limiter->Request(kMinLowPriBytesPerSec, Env::IO_HIGH,
+                          nullptr /* stats */, RateLimiter::OpType::kWrite);
+  }
+  uint64_t high_elapsed = special_env.NowMicros() - high_start;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearCallBack(
+      "GenericRateLimiter::Request:PostTimedWait");
+
+  // 3. Assert
+  ASSERT_TRUE(rate_limiter->IsForegroundAware());
+  // IO_LOW 每个周期只放行保底的 100 bytes
+  ASSERT_GE(std::chrono::microseconds(low_elapsed),
+            (kRequests - 1) * kTimePerRefill);
+  // IO_HIGH 用的是整个设备带宽，一个周期内就能放行
+  ASSERT_LE(std::chrono::microseconds(high_elapsed), kTimePerRefill);
+  ASSERT_EQ(rate_limiter->GetTotalBytesThrough(Env::IO_LOW),
+            kRequests * kMinLowPriBytesPerSec);
+  ASSERT_EQ(rate_limiter->GetTotalBytesThrough(Env::IO_HIGH),
+            kRequests * kMinLowPriBytesPerSec);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
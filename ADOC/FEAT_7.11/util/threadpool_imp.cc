@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
@@ -36,6 +37,16 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// for FEAT, the pool has no Env of its own (SetHostEnv() is optional)
+uint64_t SteadyNowNanos() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+}  // namespace
+
 void ThreadPoolImpl::PthreadCall(const char* label, int result) {
   if (result != 0) {
     fprintf(stderr, "pthread %s: %s\n", label, errnoStr(result).c_str());
@@ -53,9 +64,6 @@ struct ThreadPoolImpl::Impl {
   void SetBackgroundThreadsInternal(int num, bool allow_reduce);
   int GetBackgroundThreads();
   //for fEAT
-  std::vector<std::pair<size_t, uint64_t>>* GetThreadPoolWaiting() {
-    return &this->thread_waiting_time;
-  };
   std::string GetThreadPoolTiming() {
     std::stringstream ss;
     ss << "timestamp (micros) of each thread creating\n";
@@ -63,12 +71,9 @@ struct ThreadPoolImpl::Impl {
     for (auto pair : thread_creating_time) {
       ss << "" << pair.first << " : " << pair.second << "\n";
     }
-    ss << "micro seconds waiting for next mission"
-       << "\n";
-
-    for (auto pair : thread_waiting_time) {
-      ss << pair.first << " : " << pair.second << "\n";
-    }
+    ss << "nano seconds running jobs : " << GetStateNanos(busy_time_) << "\n";
+    ss << "nano seconds waiting for next mission : "
+       << GetStateNanos(idle_time_) << "\n";
     ss << "\n";
     return ss.str();
   }
@@ -144,7 +149,46 @@ struct ThreadPoolImpl::Impl {
   }
 // for FEAT
 
-  std::vector<std::pair<size_t, uint64_t>> thread_waiting_time;
+  // Time the threads of the pool spent in one state, summed over the threads.
+  // The threads still in the state are counted up to now, so a long
+  // compaction shows up as busy before it finishes.
+  struct StateTime {
+    uint64_t finished_nanos = 0;
+    uint64_t threads = 0;
+    uint64_t since_nanos_sum = 0;
+
+    void Enter(uint64_t now) {
+      threads++;
+      since_nanos_sum += now;
+    }
+    void Leave(uint64_t since, uint64_t now) {
+      threads--;
+      since_nanos_sum -= since;
+      finished_nanos += now - since;
+    }
+    uint64_t Total(uint64_t now) const {
+      return finished_nanos + threads * now - since_nanos_sum;
+    }
+  };
+  // A thread waiting on bgsignal_ is idle, a thread running a job is busy
+  StateTime busy_time_;
+  StateTime idle_time_;
+
+  uint64_t GetStateNanos(const StateTime& state) const {
+    std::lock_guard<std::mutex> lock(state_mu_);
+    return state.Total(SteadyNowNanos());
+  }
+  uint64_t EnterState(StateTime* state) {
+    uint64_t now = SteadyNowNanos();
+    std::lock_guard<std::mutex> lock(state_mu_);
+    state->Enter(now);
+    return now;
+  }
+  void LeaveState(StateTime* state, uint64_t since) {
+    uint64_t now = SteadyNowNanos();
+    std::lock_guard<std::mutex> lock(state_mu_);
+    state->Leave(since, now);
+  }
   std::vector<std::pair<std::string, uint64_t>> thread_creating_time;
 private:
  static void BGThreadWrapper(void* arg);
@@ -180,13 +224,17 @@ private:
   BGQueue       queue_;
 
   std::mutex               mu_;
+  // for FEAT, guards busy_time_ and idle_time_, taken after mu_
+  mutable std::mutex       state_mu_;
   std::condition_variable  bgsignal_;
   std::vector<port::Thread> bgthreads_;
 };
 
-std::vector<std::pair<size_t, uint64_t>>*
-ThreadPoolImpl::GetThreadWaitingTime() {
-  return &impl_->thread_waiting_time;
+uint64_t ThreadPoolImpl::GetBusyNanos() const {
+  return impl_->GetStateNanos(impl_->busy_time_);
+}
+uint64_t ThreadPoolImpl::GetIdleNanos() const {
+  return impl_->GetStateNanos(impl_->idle_time_);
 }
 std::vector<std::pair<std::string, uint64_t>>*
 ThreadPoolImpl::GetThreadCreatingTime() {
@@ -262,6 +310,7 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
     // Stop waiting if the thread needs to do work or needs to terminate.
     // Increase num_waiting_threads_ once this task has started waiting
     num_waiting_threads_++;
+    uint64_t wait_start_nanos = EnterState(&idle_time_);
 
     TEST_SYNC_POINT("ThreadPoolImpl::BGThread::WaitingThreadsInc");
     TEST_IDX_SYNC_POINT("ThreadPoolImpl::BGThread::Start:th", thread_id);
@@ -277,6 +326,7 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
     }
     // Decrease num_waiting_threads_ once the thread is not waiting
     num_waiting_threads_--;
+    LeaveState(&idle_time_, wait_start_nanos);
 
     if (exit_all_threads_) {  // mechanism to let BG threads exit safely
 
@@ -349,7 +399,9 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
     TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::Impl::BGThread:BeforeRun",
                              &priority_);
 
+    uint64_t run_start_nanos = EnterState(&busy_time_);
     func();
+    LeaveState(&busy_time_, run_start_nanos);
   }
 }
 
@@ -100,7 +100,11 @@ class ThreadPoolImpl : public ThreadPool {
 
   struct Impl;
 //for FEAT
-  std::vector<std::pair<size_t, uint64_t>>* GetThreadWaitingTime();
+  // Cumulative nanoseconds the threads of this pool spent running jobs and
+  // waiting for one. Both only grow, so utilization over a window is the
+  // ratio of the deltas.
+  uint64_t GetBusyNanos() const;
+  uint64_t GetIdleNanos() const;
   std::vector<std::pair<std::string,uint64_t>>* GetThreadCreatingTime();
   std::string GetThreadTimingString();
  private:
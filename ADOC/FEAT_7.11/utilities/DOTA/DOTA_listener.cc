@@ -0,0 +1,120 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/utilities/DOTA_listener.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace ROCKSDB_NAMESPACE {
+
+TunerEventListener::TunerEventListener(Env* env) : env_(env) {
+  window_.start_micros = env_->NowMicros();
+}
+
+void TunerEventListener::OnFlushBegin(DB* /*db*/, const FlushJobInfo& info) {
+  uint64_t now = env_->NowMicros();
+  std::lock_guard<std::mutex> lock(mutex_);
+  running_flushes_[{info.cf_id, info.job_id}] = now;
+}
+
+void TunerEventListener::OnFlushCompleted(DB* /*db*/,
+                                          const FlushJobInfo& info) {
+  uint64_t now = env_->NowMicros();
+  const TableProperties& props = info.table_properties;
+  uint64_t bytes = props.data_size + props.index_size + props.filter_size;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t micros = 0;
+  auto it = running_flushes_.find({info.cf_id, info.job_id});
+  if (it != running_flushes_.end()) {
+    micros = now > it->second ? now - it->second : 0;
+    running_flushes_.erase(it);
+  }
+  auto& cf_window = window_.column_families[info.cf_name];
+  window_.flush_numbers++;
+  window_.flush_bytes += bytes;
+  window_.flush_busy_micros += micros;
+  cf_window.flush_numbers++;
+  cf_window.flush_bytes += bytes;
+  if (micros > 0) {
+    double speed = static_cast<double>(bytes) / micros;
+    window_.flush_speed_sum += speed;
+    window_.flush_speed_square_sum += speed * speed;
+    window_.flush_speed_min = std::min(window_.flush_speed_min, speed);
+    cf_window.flush_speed_sum += speed;
+  }
+}
+
+void TunerEventListener::OnCompactionCompleted(DB* /*db*/,
+                                               const CompactionJobInfo& info) {
+  const CompactionJobStats& stats = info.stats;
+  std::lock_guard<std::mutex> lock(mutex_);
+  window_.compaction_numbers++;
+  window_.compaction_bytes += stats.total_output_bytes;
+  window_.compaction_busy_micros += stats.elapsed_micros;
+  if (info.base_input_level == 0 && stats.num_input_records > 0) {
+    window_.l0_compactions++;
+    window_.l0_drop_ratio_sum +=
+        1.0 - static_cast<double>(stats.num_output_records) /
+                  stats.num_input_records;
+  }
+}
+
+void TunerEventListener::OnStallConditionsChanged(const WriteStallInfo& info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_.stall_changes++;
+    window_.stall_condition = info.condition.cur;
+    window_.column_families[info.cf_name].stall_condition = info.condition.cur;
+    if (info.condition.cur == WriteStallCondition::kNormal) {
+      return;
+    }
+    wake_up_ = true;
+  }
+  cv_.notify_all();
+}
+
+void TunerEventListener::OnMemTableSealed(const MemTableInfo& info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  window_.sealed_memtables++;
+  window_.sealed_entries += info.num_entries;
+  window_.column_families[info.cf_name].sealed_memtables++;
+}
+
+void TunerEventListener::Drain(TunerEventWindow* window) {
+  uint64_t now = env_->NowMicros();
+  std::lock_guard<std::mutex> lock(mutex_);
+  window_.end_micros = now;
+  *window = window_;
+  // 写停顿状态要延续到下一个窗口
+  TunerEventWindow next;
+  next.start_micros = now;
+  next.stall_condition = window_.stall_condition;
+  for (const auto& cf : window_.column_families) {
+    if (cf.second.stall_condition != WriteStallCondition::kNormal) {
+      next.column_families[cf.first].stall_condition =
+          cf.second.stall_condition;
+    }
+  }
+  window_ = std::move(next);
+}
+
+void TunerEventListener::WaitForTuningRound(uint64_t timeout_micros) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait_for(lock, std::chrono::microseconds(timeout_micros),
+               [&] { return wake_up_; });
+  wake_up_ = false;
+}
+
+void TunerEventListener::Wake() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_up_ = true;
+  }
+  cv_.notify_all();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
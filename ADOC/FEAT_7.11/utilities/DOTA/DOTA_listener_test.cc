@@ -0,0 +1,153 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/utilities/DOTA_listener.h"
+
+#include "env/composite_env_wrapper.h"
+#include "port/stack_trace.h"
+#include "test_util/mock_time_env.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class TunerEventListenerTest : public testing::Test {
+ public:
+  TunerEventListenerTest()
+      : mock_clock_(std::make_shared<MockSystemClock>(
+            Env::Default()->GetSystemClock())),
+        mock_env_(new CompositeEnvWrapper(Env::Default(), mock_clock_)) {
+    mock_clock_->SetCurrentTime(100);
+    listener_.reset(new TunerEventListener(mock_env_.get()));
+  }
+
+  std::shared_ptr<MockSystemClock> mock_clock_;
+  std::unique_ptr<Env> mock_env_;
+  std::shared_ptr<TunerEventListener> listener_;
+};
+
+// 测试：flush 的耗时和带宽由 begin / completed 两个事件算出
+TEST_F(TunerEventListenerTest, FlushBandwidthFromEvents) {
+  // 1. Arrange
+  FlushJobInfo info;
+  info.cf_id = 0;
+  info.job_id = 7;
+  info.table_properties.data_size = 1000000;
+
+  // 2. Act
+  listener_->OnFlushBegin(nullptr, info);
+  mock_clock_->MockSleepForSeconds(2);
+  listener_->OnFlushCompleted(nullptr, info);
+  TunerEventWindow window;
+  listener_->Drain(&window);
+
+  // 3. Assert
+  ASSERT_EQ(window.flush_numbers, 1);
+  ASSERT_EQ(window.flush_bytes, 1000000u);
+  ASSERT_EQ(window.flush_busy_micros, 2000000u);
+  ASSERT_DOUBLE_EQ(window.flush_speed_sum, 0.5);
+  ASSERT_EQ(window.ElapsedMicros(), 2000000u);
+}
+
+// 测试：Drain 之后开始新窗口，写停顿状态延续下来
+TEST_F(TunerEventListenerTest, DrainStartsNewWindow) {
+  // 1. Arrange
+  CompactionJobInfo compaction;
+  compaction.base_input_level = 0;
+  compaction.stats.num_input_records = 100;
+  compaction.stats.num_output_records = 60;
+  compaction.stats.total_output_bytes = 4096;
+  WriteStallInfo stall;
+  stall.condition.prev = WriteStallCondition::kNormal;
+  stall.condition.cur = WriteStallCondition::kDelayed;
+  MemTableInfo memtable;
+  memtable.num_entries = 10;
+
+  // 2. Act
+  listener_->OnCompactionCompleted(nullptr, compaction);
+  listener_->OnStallConditionsChanged(stall);
+  listener_->OnMemTableSealed(memtable);
+  TunerEventWindow first;
+  listener_->Drain(&first);
+  TunerEventWindow second;
+  listener_->Drain(&second);
+
+  // 3. Assert
+  ASSERT_EQ(first.l0_compactions, 1);
+  ASSERT_DOUBLE_EQ(first.l0_drop_ratio_sum, 0.4);
+  ASSERT_EQ(first.compaction_bytes, 4096u);
+  ASSERT_EQ(first.sealed_memtables, 1);
+  ASSERT_EQ(first.stall_changes, 1);
+  ASSERT_EQ(second.l0_compactions, 0);
+  ASSERT_EQ(second.sealed_memtables, 0);
+  ASSERT_EQ(second.stall_changes, 0);
+  ASSERT_EQ(second.stall_condition, WriteStallCondition::kDelayed);
+}
+
+// 测试：事件按列族分别汇总
+TEST_F(TunerEventListenerTest, PerColumnFamilyWindows) {
+  // 1. Arrange
+  FlushJobInfo hot_flush;
+  hot_flush.cf_id = 1;
+  hot_flush.cf_name = "hot";
+  hot_flush.job_id = 1;
+  hot_flush.table_properties.data_size = 4096;
+  MemTableInfo hot_memtable;
+  hot_memtable.cf_name = "hot";
+  MemTableInfo cold_memtable;
+  cold_memtable.cf_name = "cold";
+  WriteStallInfo stall;
+  stall.cf_name = "hot";
+  stall.condition.prev = WriteStallCondition::kNormal;
+  stall.condition.cur = WriteStallCondition::kDelayed;
+
+  // 2. Act
+  listener_->OnFlushBegin(nullptr, hot_flush);
+  listener_->OnFlushCompleted(nullptr, hot_flush);
+  listener_->OnMemTableSealed(hot_memtable);
+  listener_->OnMemTableSealed(hot_memtable);
+  listener_->OnMemTableSealed(cold_memtable);
+  listener_->OnStallConditionsChanged(stall);
+  TunerEventWindow first;
+  listener_->Drain(&first);
+  TunerEventWindow second;
+  listener_->Drain(&second);
+
+  // 3. Assert
+  ASSERT_EQ(first.sealed_memtables, 3);
+  ASSERT_EQ(first.column_families["hot"].sealed_memtables, 2);
+  ASSERT_EQ(first.column_families["hot"].flush_numbers, 1);
+  ASSERT_EQ(first.column_families["hot"].flush_bytes, 4096u);
+  ASSERT_EQ(first.column_families["cold"].sealed_memtables, 1);
+  ASSERT_EQ(first.column_families["cold"].flush_numbers, 0);
+  ASSERT_EQ(second.column_families.size(), 1u);
+  ASSERT_EQ(second.column_families["hot"].stall_condition,
+            WriteStallCondition::kDelayed);
+  ASSERT_EQ(second.column_families["hot"].sealed_memtables, 0);
+}
+
+// 测试：进入写停顿会提前唤醒等待中的调优线程
+TEST_F(TunerEventListenerTest, StallWakesTuningRound) {
+  // 1. Arrange
+  WriteStallInfo stall;
+  stall.condition.prev = WriteStallCondition::kNormal;
+  stall.condition.cur = WriteStallCondition::kStopped;
+
+  // 2. Act
+  listener_->OnStallConditionsChanged(stall);
+  auto start = Env::Default()->NowMicros();
+  listener_->WaitForTuningRound(60 * 1000000);
+  auto waited = Env::Default()->NowMicros() - start;
+
+  // 3. Assert
+  ASSERT_LT(waited, 10 * 1000000u);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,183 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/utilities/DOTA_trace.h"
+
+#include <cstring>
+
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const char kTunerTraceMagic[] = "DOTATRC";
+const size_t kTunerTraceMagicSize = sizeof(kTunerTraceMagic) - 1;
+
+void PutDouble(std::string* dst, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  PutFixed64(dst, bits);
+}
+
+bool GetDouble(Slice* input, double* value) {
+  uint64_t bits;
+  if (!GetFixed64(input, &bits)) {
+    return false;
+  }
+  memcpy(value, &bits, sizeof(bits));
+  return true;
+}
+
+bool GetInt(Slice* input, int* value) {
+  uint32_t v;
+  if (!GetFixed32(input, &v)) {
+    return false;
+  }
+  *value = static_cast<int>(v);
+  return true;
+}
+
+void EncodeRecord(const TunerTraceRecord& record, std::string* dst) {
+  const SystemScores& s = record.scores;
+  PutFixed32(dst, static_cast<uint32_t>(record.secs_elapsed));
+  PutFixed64(dst, s.timestamp_micros);
+  PutFixed64(dst, s.memtable_speed);
+  PutDouble(dst, s.active_size_ratio);
+  PutFixed32(dst, static_cast<uint32_t>(s.immutable_number));
+  PutDouble(dst, s.memtable_fill);
+  PutDouble(dst, s.flush_speed_avg);
+  PutDouble(dst, s.flush_min);
+  PutDouble(dst, s.flush_speed_var);
+  PutDouble(dst, s.l0_num);
+  PutDouble(dst, s.l0_drop_ratio);
+  PutDouble(dst, s.estimate_compaction_bytes);
+  PutDouble(dst, s.disk_bandwidth);
+  PutDouble(dst, s.flush_idle_time);
+  PutDouble(dst, s.flush_gap_time);
+  PutDouble(dst, s.compaction_idle_time);
+  PutFixed32(dst, static_cast<uint32_t>(s.flush_numbers));
+  dst->push_back(static_cast<char>(record.op.ThreadOp));
+  dst->push_back(static_cast<char>(record.op.BatchOp));
+  PutFixed32(dst, static_cast<uint32_t>(record.max_background_jobs));
+  PutFixed64(dst, record.write_buffer_size);
+  dst->push_back(static_cast<char>(record.op.CompactionOp));
+  PutFixed32(dst, record.max_subcompactions);
+  PutFixed64(dst, record.compaction_readahead_size);
+  PutFixed64(dst, static_cast<uint64_t>(record.rate_limiter_bytes_per_sec));
+}
+
+bool DecodeRecord(Slice input, TunerTraceRecord* record) {
+  SystemScores& s = record->scores;
+  bool ok = GetInt(&input, &record->secs_elapsed) &&
+            GetFixed64(&input, &s.timestamp_micros) &&
+            GetFixed64(&input, &s.memtable_speed) &&
+            GetDouble(&input, &s.active_size_ratio) &&
+            GetInt(&input, &s.immutable_number) &&
+            GetDouble(&input, &s.memtable_fill) &&
+            GetDouble(&input, &s.flush_speed_avg) &&
+            GetDouble(&input, &s.flush_min) &&
+            GetDouble(&input, &s.flush_speed_var) &&
+            GetDouble(&input, &s.l0_num) &&
+            GetDouble(&input, &s.l0_drop_ratio) &&
+            GetDouble(&input, &s.estimate_compaction_bytes) &&
+            GetDouble(&input, &s.disk_bandwidth) &&
+            GetDouble(&input, &s.flush_idle_time) &&
+            GetDouble(&input, &s.flush_gap_time) &&
+            GetDouble(&input, &s.compaction_idle_time) &&
+            GetInt(&input, &s.flush_numbers) && input.size() >= 2;
+  if (!ok) {
+    return false;
+  }
+  record->op.ThreadOp = static_cast<OpType>(input[0]);
+  record->op.BatchOp = static_cast<OpType>(input[1]);
+  input.remove_prefix(2);
+  if (!GetInt(&input, &record->max_background_jobs) ||
+      !GetFixed64(&input, &record->write_buffer_size)) {
+    return false;
+  }
+  // 旧的 trace 没有 compaction 相关的字段
+  if (input.empty()) {
+    return true;
+  }
+  record->op.CompactionOp = static_cast<OpType>(input[0]);
+  input.remove_prefix(1);
+  uint64_t readahead;
+  uint64_t rate;
+  if (!GetFixed32(&input, &record->max_subcompactions) ||
+      !GetFixed64(&input, &readahead) || !GetFixed64(&input, &rate)) {
+    return false;
+  }
+  record->compaction_readahead_size = static_cast<size_t>(readahead);
+  record->rate_limiter_bytes_per_sec = static_cast<int64_t>(rate);
+  return true;
+}
+}  // namespace
+
+Status TunerTraceWriter::Create(Env* env, const std::string& fname,
+                                std::unique_ptr<TunerTraceWriter>* writer) {
+  std::unique_ptr<WritableFile> file;
+  Status s = env->NewWritableFile(fname, &file, EnvOptions());
+  if (!s.ok()) {
+    return s;
+  }
+  std::string header(kTunerTraceMagic, kTunerTraceMagicSize);
+  PutFixed32(&header, kFormatVersion);
+  s = file->Append(header);
+  if (s.ok()) {
+    writer->reset(new TunerTraceWriter(std::move(file)));
+  }
+  return s;
+}
+
+Status TunerTraceWriter::Append(const TunerTraceRecord& record) {
+  std::string payload;
+  EncodeRecord(record, &payload);
+  std::string buf;
+  PutFixed32(&buf, static_cast<uint32_t>(payload.size()));
+  buf.append(payload);
+  Status s = file_->Append(buf);
+  if (s.ok()) {
+    // 每轮只有一条记录，直接 flush，进程异常退出也不丢前面的轮次
+    s = file_->Flush();
+  }
+  return s;
+}
+
+Status TunerTraceWriter::Close() { return file_->Close(); }
+
+Status ReadTunerTrace(Env* env, const std::string& fname,
+                      std::vector<TunerTraceRecord>* records) {
+  std::string data;
+  Status s = ReadFileToString(env, fname, &data);
+  if (!s.ok()) {
+    return s;
+  }
+  Slice input(data);
+  uint32_t version;
+  if (!input.starts_with(Slice(kTunerTraceMagic, kTunerTraceMagicSize))) {
+    return Status::Corruption("not a tuner trace", fname);
+  }
+  input.remove_prefix(kTunerTraceMagicSize);
+  if (!GetFixed32(&input, &version) || version > TunerTraceWriter::kFormatVersion) {
+    return Status::NotSupported("unknown tuner trace version", fname);
+  }
+  records->clear();
+  while (!input.empty()) {
+    uint32_t length;
+    if (!GetFixed32(&input, &length) || input.size() < length) {
+      // 最后一条没有写完整，保留前面的记录
+      break;
+    }
+    TunerTraceRecord record;
+    if (!DecodeRecord(Slice(input.data(), length), &record)) {
+      return Status::Corruption("truncated tuner trace record", fname);
+    }
+    records->push_back(record);
+    input.remove_prefix(length);
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
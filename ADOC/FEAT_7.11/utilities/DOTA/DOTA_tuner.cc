@@ -4,24 +4,126 @@
 
 #include <vector>
 
+#include "logging/logging.h"
 #include "rocksdb/utilities/report_agent.h"
+#include "rocksdb/write_buffer_manager.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// 最小二乘拟合 `field` 在最近几轮上的斜率，单位是每秒
+double TrendPerSec(const std::deque<SystemScores> &scores, size_t first,
+                   double SystemScores::*field) {
+  const double n = static_cast<double>(scores.size() - first);
+  const uint64_t t0 = scores[first].timestamp_micros;
+  double mean_x = 0;
+  double mean_y = 0;
+  for (size_t i = first; i < scores.size(); i++) {
+    mean_x += (scores[i].timestamp_micros - t0) / (double)kMicrosInSecond;
+    mean_y += scores[i].*field;
+  }
+  mean_x /= n;
+  mean_y /= n;
+  double covariance = 0;
+  double variance = 0;
+  for (size_t i = first; i < scores.size(); i++) {
+    double dx =
+        (scores[i].timestamp_micros - t0) / (double)kMicrosInSecond - mean_x;
+    covariance += dx * (scores[i].*field - mean_y);
+    variance += dx * dx;
+  }
+  return variance > 0 ? covariance / variance : 0.0;
+}
+
+double SecondsToStall(double pressure, double slope) {
+  if (pressure >= 1) {
+    return 0;
+  }
+  return slope > 0 ? (1 - pressure) / slope : StallForecast::kNoStall;
+}
+}  // namespace
+
+StallForecast ForecastStall(const std::deque<SystemScores> &scores,
+                            size_t samples) {
+  StallForecast forecast;
+  samples = std::min(samples, scores.size());
+  if (samples < 2) {
+    return forecast;
+  }
+  size_t first = scores.size() - samples;
+  forecast.memtable_slope =
+      TrendPerSec(scores, first, &SystemScores::memtable_fill);
+  forecast.l0_slope = TrendPerSec(scores, first, &SystemScores::l0_num);
+  forecast.pending_bytes_slope =
+      TrendPerSec(scores, first, &SystemScores::estimate_compaction_bytes);
+
+  const SystemScores &last = scores.back();
+  forecast.memtable_secs =
+      SecondsToStall(last.memtable_fill, forecast.memtable_slope);
+  forecast.l0_secs = SecondsToStall(last.l0_num, forecast.l0_slope);
+  forecast.pending_bytes_secs = SecondsToStall(
+      last.estimate_compaction_bytes, forecast.pending_bytes_slope);
+  return forecast;
+}
+
+SystemScores ProjectScore(const SystemScores &current,
+                          const StallForecast &forecast, double horizon_secs) {
+  SystemScores projected = current;
+  // 只外推正在上升的压力，压力下降时等它真的降下来再放松
+  if (forecast.memtable_slope > 0) {
+    projected.memtable_fill += forecast.memtable_slope * horizon_secs;
+  }
+  if (forecast.l0_slope > 0) {
+    projected.l0_num += forecast.l0_slope * horizon_secs;
+  }
+  if (forecast.pending_bytes_slope > 0) {
+    projected.estimate_compaction_bytes +=
+        forecast.pending_bytes_slope * horizon_secs;
+  }
+  if (forecast.memtable_secs <= horizon_secs) {
+    // memtable 预计会写满，当作已经有 immutable memtable 在排队
+    projected.immutable_number = std::max(projected.immutable_number, 1);
+  }
+  return projected;
+}
+
 DOTA_Tuner::~DOTA_Tuner() = default;
 void DOTA_Tuner::DetectTuningOperations(
-    int secs_elapsed, std::vector<ChangePoint> *change_list_ptr) {
+    int secs_elapsed, DBImpl::TuningUpdate *update) {
   current_sec = secs_elapsed;
+  last_op_ = TuningOP{kKeep, kKeep};
   //  UpdateSystemStats();
   SystemScores current_score = ScoreTheSystem();
   UpdateMaxScore(current_score);
   scores.push_back(current_score);
+  if (scores.size() > (size_t)score_array_len) {
+    scores.pop_front();
+  }
   gradients.push_back(current_score - scores.front());
 
-  auto thread_stat = LocateThreadStates(current_score);
-  auto batch_stat = LocateBatchStates(current_score);
-
-  AdjustmentTuning(change_list_ptr, current_score, thread_stat, batch_stat);
+  // 按预测的状态而不是当前状态定位，写停顿之前就开始调整
+  auto forecast = ForecastStall(scores, forecast_samples);
+  if (forecast.Nearest() <= forecast_horizon) {
+    ROCKS_LOG_INFO(info_log(), "[tuner] stall forecast in %.1f secs",
+                   forecast.Nearest());
+  }
+  auto predicted_score = ProjectScore(current_score, forecast, forecast_horizon);
+  auto thread_stat = LocateThreadStates(predicted_score);
+  auto batch_stat = LocateBatchStates(predicted_score, max_scores);
+  auto tuning_op = VoteForOP(predicted_score, thread_stat, batch_stat);
+
+  // memtable 大小按列族各自投票
+  std::vector<OpType> batch_ops;
+  for (const auto &cf : cf_scores_) {
+    auto &history = cf_history_[cf.id];
+    auto cf_score = ProjectScore(
+        cf.scores, ForecastStall(history.recent, forecast_samples),
+        forecast_horizon);
+    auto cf_stat = LocateBatchStates(cf_score, history.max_scores);
+    auto cf_op = VoteForOP(predicted_score, thread_stat, cf_stat);
+    batch_ops.push_back(VoteForColumnFamily(cf, cf_op.BatchOp));
+  }
+  FillUpChangeList(update, tuning_op.ThreadOp, batch_ops);
   // decide the operation based on the best behavior and last behavior
   // update the histories
   last_thread_states = thread_stat;
@@ -50,22 +152,31 @@ ThreadStallLevels DOTA_Tuner::LocateThreadStates(SystemScores &score) {
     } else if (score.estimate_compaction_bytes > 0.5) {
       return kPendingBytes;
     }
-  } else if (score.compaction_idle_time > 2.5) {
+  } else if (score.l0_num >= 1) {
+    // 速度还没有掉下来，但预测的 L0 已经到了 slowdown 触发线
+    return kL0Stall;
+  } else if (score.estimate_compaction_bytes >= 1) {
+    return kPendingBytes;
+  } else if (score.compaction_idle_time > idle_threshold) {
     return kIdle;
   }
   return kGoodArea;
 }
 
-BatchSizeStallLevels DOTA_Tuner::LocateBatchStates(SystemScores &score) {
-  if (score.memtable_speed < max_scores.memtable_speed * 0.7) {
-    if (score.flush_speed_avg < max_scores.flush_speed_avg * 0.5) {
+BatchSizeStallLevels DOTA_Tuner::LocateBatchStates(
+    const SystemScores &score, const SystemScores &max_score) {
+  if (score.memtable_speed < max_score.memtable_speed * 0.7) {
+    if (score.flush_speed_avg < max_score.flush_speed_avg * 0.5) {
       if (score.active_size_ratio > 0.5 && score.immutable_number >= 1) {
         return kTinyMemtable;
       } else if (current_opt.max_background_jobs > 6 || score.l0_num > 0.9) {
         return kTinyMemtable;
       }
     }
-  } else if (score.flush_numbers < max_scores.flush_numbers * 0.3) {
+  } else if (score.memtable_fill >= 1) {
+    // 预测 flush 追不上写入，memtable 会被写满
+    return kTinyMemtable;
+  } else if (score.flush_numbers < max_score.flush_numbers * 0.3) {
     return kOverFrequent;
   }
 
@@ -73,134 +184,286 @@ BatchSizeStallLevels DOTA_Tuner::LocateBatchStates(SystemScores &score) {
 };
 
 SystemScores DOTA_Tuner::ScoreTheSystem() {
-  UpdateSystemStats();
   SystemScores current_score;
 
-  uint64_t total_mem_size = 0;
-  uint64_t active_mem = 0;
-  running_db_->GetIntProperty("rocksdb.size-all-mem-tables", &total_mem_size);
-  running_db_->GetIntProperty("rocksdb.cur-size-active-mem-table", &active_mem);
-
-  current_score.active_size_ratio =
-      (double)active_mem / (double)current_opt.write_buffer_size;
-  current_score.immutable_number =
-      cfd->imm() == nullptr ? 0 : cfd->imm()->NumNotFlushed();
-
-  std::vector<FlushMetrics> flush_metric_list;
-
-  auto flush_result_length =
-      running_db_->immutable_db_options().flush_stats->size();
-
-
-  auto compaction_result_length =
-      running_db_->immutable_db_options().job_stats->size();
-
-  for (uint64_t i = flush_list_accessed; i < flush_result_length; i++) {
-    auto temp = flush_list_from_opt_ptr->at(i);
-    current_score.flush_min =
-        std::min(current_score.flush_speed_avg, current_score.flush_min);
-    flush_metric_list.push_back(temp);
-    current_score.flush_speed_avg += temp.write_out_bandwidth;
-    current_score.disk_bandwidth += temp.total_bytes;
-    last_non_zero_flush = temp.write_out_bandwidth;
-    if (current_score.l0_num > temp.l0_files) {
-      current_score.l0_num = temp.l0_files;
+  // 上次调优之后的 flush / compaction / memtable 事件，由 listener 增量汇总
+  TunerEventWindow window;
+  events_->Drain(&window);
+  double elapsed_secs =
+      std::max(window.ElapsedMicros(), uint64_t{1}) / (double)kMicrosInSecond;
+
+  // 只有少量瞬时值需要在 DB mutex 下读取
+  struct Gauges {
+    uint64_t active_mem;
+    int l0_files;
+    uint64_t pending_bytes;
+    int level0_slowdown_writes_trigger;
+    uint64_t soft_pending_compaction_bytes_limit;
+  };
+  std::vector<Gauges> gauges;
+  cf_scores_.clear();
+  {
+    InstrumentedMutexLock l(running_db_->mutex());
+    for (auto cfd : *running_db_->GetVersionSet()->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || !cfd->initialized()) {
+        continue;
+      }
+      const MutableCFOptions &mopt = *cfd->GetLatestMutableCFOptions();
+      auto vfs = cfd->current()->storage_info();
+      ColumnFamilyScores cf;
+      cf.id = cfd->GetID();
+      cf.name = cfd->GetName();
+      cf.scores.immutable_number = cfd->imm()->NumNotFlushed();
+      cf.write_buffer_size = mopt.write_buffer_size;
+      cf.max_write_buffer_number = mopt.max_write_buffer_number;
+      cf.level0_file_num_compaction_trigger =
+          mopt.level0_file_num_compaction_trigger;
+      cf.min_write_buffer_number_to_merge =
+          cfd->ioptions()->min_write_buffer_number_to_merge;
+      cf_scores_.push_back(cf);
+      gauges.push_back({cfd->mem()->ApproximateMemoryUsage(),
+                        vfs->NumLevelFiles(vfs->base_level()),
+                        vfs->estimated_compaction_needed_bytes(),
+                        mopt.level0_slowdown_writes_trigger,
+                        mopt.soft_pending_compaction_bytes_limit});
     }
   }
-  int l0_compaction = 0;
-  auto num_new_flushes = (flush_result_length - flush_list_accessed);
-  current_score.flush_numbers = num_new_flushes;
-
-  while (total_mem_size < last_unflushed_bytes) {
-    total_mem_size += current_opt.write_buffer_size;
-  }
-  current_score.memtable_speed += (total_mem_size - last_unflushed_bytes);
 
-  current_score.memtable_speed /= tuning_gap;
-  current_score.memtable_speed /= kMicrosInSecond;  // we use MiB to calculate
-
-  uint64_t max_pending_bytes = 0;
-
-  last_unflushed_bytes = total_mem_size;
-  for (uint64_t i = compaction_list_accessed; i < compaction_result_length;
-       i++) {
-    auto temp = compaction_list_from_opt_ptr->at(i);
-    if (temp.input_level == 0) {
-      current_score.l0_drop_ratio += temp.drop_ratio;
-      l0_compaction++;
-    }
-    if (temp.current_pending_bytes > max_pending_bytes) {
-      max_pending_bytes = temp.current_pending_bytes;
+  // 每个列族单独打分，全局分数取写入量之和、各项压力的最大值
+  uint64_t memtable_bytes = 0;
+  for (size_t i = 0; i < cf_scores_.size(); i++) {
+    auto &cf = cf_scores_[i];
+    const auto &g = gauges[i];
+    auto &history = cf_history_[cf.id];
+    SystemScores &score = cf.scores;
+    auto cf_window = window.column_families.find(cf.name);
+    if (cf_window != window.column_families.end()) {
+      cf.sealed_memtables = cf_window->second.sealed_memtables;
+      score.flush_numbers = cf_window->second.flush_numbers;
+      if (score.flush_numbers != 0) {
+        score.flush_speed_avg =
+            cf_window->second.flush_speed_sum / score.flush_numbers;
+      }
     }
-    current_score.disk_bandwidth += temp.total_bytes;
+    score.active_size_ratio =
+        (double)g.active_mem / (double)std::max(cf.write_buffer_size,
+                                                uint64_t{1});
+    score.memtable_fill =
+        (score.immutable_number + score.active_size_ratio) /
+        std::max(cf.max_write_buffer_number, 1);
+    score.l0_num = (double)g.l0_files /
+                   std::max(g.level0_slowdown_writes_trigger, 1);
+    score.estimate_compaction_bytes =
+        g.soft_pending_compaction_bytes_limit == 0
+            ? 0.0
+            : (double)g.pending_bytes / g.soft_pending_compaction_bytes_limit;
+
+    // 写入 memtable 的字节数：封存的 memtable 加上 active memtable 的增量
+    uint64_t cf_bytes = cf.sealed_memtables * cf.write_buffer_size + g.active_mem;
+    cf.ingest_bytes = cf_bytes > history.last_active_bytes
+                          ? cf_bytes - history.last_active_bytes
+                          : 0;
+    history.last_active_bytes = g.active_mem;
+    score.memtable_speed =
+        cf.ingest_bytes / elapsed_secs / kMicrosInSecond;  // we use MiB
+    score.timestamp_micros = window.end_micros;
+    RecordColumnFamily(cf);
+
+    memtable_bytes += cf.ingest_bytes;
+    current_score.active_size_ratio =
+        std::max(current_score.active_size_ratio, score.active_size_ratio);
+    current_score.immutable_number =
+        std::max(current_score.immutable_number, score.immutable_number);
+    current_score.memtable_fill =
+        std::max(current_score.memtable_fill, score.memtable_fill);
+    current_score.l0_num = std::max(current_score.l0_num, score.l0_num);
+    current_score.estimate_compaction_bytes =
+        std::max(current_score.estimate_compaction_bytes,
+                 score.estimate_compaction_bytes);
   }
-
-  // flush_speed_avg,flush_speed_var,l0_drop_ratio
-  if (num_new_flushes != 0) {
-    auto avg_flush = current_score.flush_speed_avg / num_new_flushes;
-    current_score.flush_speed_avg /= num_new_flushes;
-    for (auto item : flush_metric_list) {
-      current_score.flush_speed_var += (item.write_out_bandwidth - avg_flush) *
-                                       (item.write_out_bandwidth - avg_flush);
+  // 已删除的列族不再保留历史
+  for (auto it = cf_history_.begin(); it != cf_history_.end();) {
+    bool alive = false;
+    for (const auto &cf : cf_scores_) {
+      alive = alive || cf.id == it->first;
     }
-    current_score.flush_speed_var /= num_new_flushes;
-    current_score.flush_gap_time /= (kMicrosInSecond * num_new_flushes);
+    it = alive ? std::next(it) : cf_history_.erase(it);
   }
 
-  if (l0_compaction != 0) {
-    current_score.l0_drop_ratio /= l0_compaction;
+  current_score.flush_numbers = window.flush_numbers;
+  current_score.disk_bandwidth =
+      (double)(window.flush_bytes + window.compaction_bytes);
+  if (window.flush_numbers != 0) {
+    auto avg_flush = window.flush_speed_sum / window.flush_numbers;
+    current_score.flush_speed_avg = avg_flush;
+    current_score.flush_min = window.flush_speed_min;
+    current_score.flush_speed_var =
+        std::max(window.flush_speed_square_sum / window.flush_numbers -
+                     avg_flush * avg_flush,
+                 0.0);
+    last_non_zero_flush = avg_flush;
+  }
+  if (window.l0_compactions != 0) {
+    current_score.l0_drop_ratio =
+        window.l0_drop_ratio_sum / window.l0_compactions;
   }
-  // l0_num
 
-  current_score.l0_num = (double)(vfs->NumLevelFiles(vfs->base_level())) /
-                         current_opt.level0_slowdown_writes_trigger;
-  //std::cout << "currenct score, l0 number" << current_score.l0_num <<std::endl;
-  //  current_score.l0_num = l0_compaction == 0 ? current_score.l0_num : 0;
-  // disk bandwidth,estimate_pending_bytes ratio
+  current_score.memtable_speed =
+      memtable_bytes / elapsed_secs / kMicrosInSecond;  // we use MiB
   current_score.disk_bandwidth /= kMicrosInSecond;
-
-  current_score.estimate_compaction_bytes =
-      (double)vfs->estimated_compaction_needed_bytes() /
-      current_opt.soft_pending_compaction_bytes_limit;
-
-  auto flush_thread_idle_list = *env_->GetThreadPoolWaitingTime(Env::HIGH);
-  auto compaction_thread_idle_list = *env_->GetThreadPoolWaitingTime(Env::LOW);
-  std::unordered_map<int, uint64_t> thread_idle_time;
-  uint64_t temp = flush_thread_idle_list.size();
-  for (uint64_t i = last_flush_thread_len; i < temp; i++) {
-    auto temp_entry = flush_thread_idle_list[i];
-    auto value = temp_entry.second;
-    current_score.flush_idle_time += value;
-  }
-  temp = compaction_thread_idle_list.size();
-  for (uint64_t i = last_compaction_thread_len; i < temp; i++) {
-    auto temp_entry = compaction_thread_idle_list[i];
-    auto value = temp_entry.second;
-    current_score.compaction_idle_time += value;
+  current_score.timestamp_micros = window.end_micros;
+
+  // 优先用线程池自己记的空闲时间；Env 不支持时才用
+  // 线程池容量 - 窗口内完成的任务耗时 估算。估算时长任务的耗时全部记在它
+  // 完成的那个窗口里，所以这里截到 0
+  double flush_idle;
+  double compaction_idle;
+  if (!ReadPoolIdleMicros(&flush_idle, &compaction_idle)) {
+    double window_micros = elapsed_secs * kMicrosInSecond;
+    flush_idle = env_->GetBackgroundThreads(Env::HIGH) * window_micros -
+                 (double)window.flush_busy_micros;
+    compaction_idle = env_->GetBackgroundThreads(Env::LOW) * window_micros -
+                      (double)window.compaction_busy_micros;
   }
+  current_score.flush_idle_time = std::max(flush_idle, 0.0);
+  current_score.compaction_idle_time = std::max(compaction_idle, 0.0);
   current_score.flush_idle_time /=
       (current_opt.max_background_jobs * kMicrosInSecond / 4);
   // flush threads always get 1/4 of all
   current_score.compaction_idle_time /=
       (current_opt.max_background_jobs * kMicrosInSecond * 3 / 4);
+  // 要在所有分数都算完之后再保存，trace 记录的就是它
+  last_score_ = current_score;
 
-  // clean up
-  flush_list_accessed = flush_result_length;
-  compaction_list_accessed = compaction_result_length;
-  last_compaction_thread_len = compaction_thread_idle_list.size();
-  last_flush_thread_len = flush_thread_idle_list.size();
   return current_score;
 }
 
-void DOTA_Tuner::AdjustmentTuning(std::vector<ChangePoint> *change_list,
-                                  SystemScores &score,
-                                  ThreadStallLevels thread_levels,
-                                  BatchSizeStallLevels batch_levels) {
-  // tune for thread number
-  auto tuning_op = VoteForOP(score, thread_levels, batch_levels);
-  // tune for memtable
-  FillUpChangeList(change_list, tuning_op);
+bool DOTA_Tuner::ReadPoolIdleMicros(double* flush_idle,
+                                    double* compaction_idle) {
+  uint64_t busy_nanos;
+  uint64_t flush_idle_nanos;
+  uint64_t compaction_idle_nanos;
+  if (!env_->GetThreadPoolUtilization(Env::HIGH, &busy_nanos,
+                                      &flush_idle_nanos)
+           .ok() ||
+      !env_->GetThreadPoolUtilization(Env::LOW, &busy_nanos,
+                                      &compaction_idle_nanos)
+           .ok()) {
+    return false;
+  }
+  bool valid = pool_idle_valid_;
+  *flush_idle = (flush_idle_nanos - last_flush_idle_nanos_) / 1000.0;
+  *compaction_idle =
+      (compaction_idle_nanos - last_compaction_idle_nanos_) / 1000.0;
+  last_flush_idle_nanos_ = flush_idle_nanos;
+  last_compaction_idle_nanos_ = compaction_idle_nanos;
+  pool_idle_valid_ = true;
+  return valid;
 }
+
+OpType DOTA_Tuner::VoteForColumnFamily(const ColumnFamilyScores &cf,
+                                       OpType vote) const {
+  if (cf.scores.flush_numbers != 0) {
+    return vote;
+  }
+  // 有多个列族时，这一轮没有写满 memtable 的冷列族把内存让给热列族，
+  // 但只缩到还装得下一轮的写入。完全没有写入的列族 memtable 本来就不占
+  // 多少内存，每轮都减半只会让它重新有写入时从最小的 memtable 开始
+  if (cf_scores_.size() > 1 && cf.sealed_memtables == 0 &&
+      cf.scores.immutable_number == 0 && cf.ingest_bytes > 0 &&
+      cf.ingest_bytes <= cf.write_buffer_size / 2) {
+    return kHalf;
+  }
+  return kKeep;
+}
+
+void DOTA_Tuner::RecordColumnFamily(const ColumnFamilyScores &cf) {
+  auto &history = cf_history_[cf.id];
+  if (history.base_write_buffer_size == 0) {
+    history.base_write_buffer_size = cf.write_buffer_size;
+  }
+  UpdateMaxScore(cf.scores, &history.max_scores);
+  history.recent.push_back(cf.scores);
+  if (history.recent.size() > forecast_samples) {
+    history.recent.pop_front();
+  }
+}
+
+uint64_t DOTA_Tuner::MemtableFloor(const ColumnFamilyScores &cf) const {
+  auto history = cf_history_.find(cf.id);
+  uint64_t base = history == cf_history_.end()
+                      ? cf.write_buffer_size
+                      : history->second.base_write_buffer_size;
+  return std::min(min_memtable_size, base);
+}
+
+void DOTA_Tuner::FitIntoWriteBufferBudget(
+    std::vector<uint64_t> *targets) const {
+  if (running_db_ == nullptr) {
+    return;
+  }
+  const auto &wbm = running_db_->immutable_db_options().write_buffer_manager;
+  if (wbm == nullptr || !wbm->enabled()) {
+    return;
+  }
+  ShareWriteBufferBudget(static_cast<double>(wbm->buffer_size()), targets);
+}
+
+void DOTA_Tuner::ShareWriteBufferBudget(double budget,
+                                        std::vector<uint64_t> *targets) const {
+  const size_t n = cf_scores_.size();
+  double demand = 0;
+  double floors = 0;
+  std::vector<uint64_t> floor(n);
+  std::vector<double> slots(n);
+  std::vector<double> want(n);
+  for (size_t i = 0; i < n; i++) {
+    const auto &cf = cf_scores_[i];
+    slots[i] = std::max(cf.max_write_buffer_number, 1);
+    floor[i] = std::min((*targets)[i], MemtableFloor(cf));
+    want[i] = ((*targets)[i] - floor[i]) * slots[i];
+    demand += (*targets)[i] * slots[i];
+    floors += floor[i] * slots[i];
+  }
+  if (demand <= budget) {
+    return;
+  }
+  // 先保证每个列族的下限，剩下的预算按写入量分给各列族。
+  // 分到的超过自己想要的部分不能浪费，再按同样的规则分给没分够的列族，
+  // 每一轮至少有一个列族分够或者预算分完，最多 n + 1 轮
+  std::vector<double> grant(n, 0.0);
+  double spare = std::max(budget - floors, 0.0);
+  for (size_t round = 0; round <= n && spare >= 1.0; round++) {
+    double ingest = 0;
+    double wanted = 0;
+    for (size_t i = 0; i < n; i++) {
+      if (grant[i] < want[i]) {
+        ingest += cf_scores_[i].ingest_bytes;
+        wanted += want[i] - grant[i];
+      }
+    }
+    if (wanted <= 0) {
+      break;
+    }
+    double handed = 0;
+    for (size_t i = 0; i < n; i++) {
+      if (grant[i] >= want[i]) {
+        continue;
+      }
+      double missing = want[i] - grant[i];
+      double share = ingest > 0 ? cf_scores_[i].ingest_bytes / ingest
+                                : missing / wanted;
+      double more = std::min(missing, spare * share);
+      grant[i] += more;
+      handed += more;
+    }
+    spare -= handed;
+  }
+  for (size_t i = 0; i < n; i++) {
+    (*targets)[i] = floor[i] + static_cast<uint64_t>(grant[i] / slots[i]);
+  }
+}
+
 TuningOP DOTA_Tuner::VoteForOP(SystemScores & /*current_score*/,
                                ThreadStallLevels thread_level,
                                BatchSizeStallLevels batch_level) {
@@ -237,77 +500,120 @@ TuningOP DOTA_Tuner::VoteForOP(SystemScores & /*current_score*/,
   return op;
 }
 
-inline void DOTA_Tuner::SetThreadNum(std::vector<ChangePoint> *change_list,
+inline void DOTA_Tuner::SetThreadNum(DBImpl::TuningUpdate *update,
                                      int target_value) {
-  ChangePoint thread_num_cp;
-  thread_num_cp.opt = max_bg_jobs;
-  thread_num_cp.db_width = true;
   target_value = std::max(target_value, min_thread);
   target_value = std::min(target_value, max_thread);
-  thread_num_cp.value = std::to_string(target_value);
-  change_list->push_back(thread_num_cp);
+  update->max_background_jobs = target_value;
+  current_opt.max_background_jobs = target_value;
 }
 
-inline void DOTA_Tuner::SetBatchSize(std::vector<ChangePoint> *change_list,
+inline void DOTA_Tuner::SetBatchSize(DBImpl::TuningUpdate *update,
+                                     const ColumnFamilyScores &cf,
                                      uint64_t target_value) {
-  ChangePoint memtable_size_cp;
-  ChangePoint L1_total_size;
-  ChangePoint sst_size_cp;
-  //  ChangePoint write_buffer_number;
-
-  sst_size_cp.opt = sst_size;
-  L1_total_size.opt = total_l1_size;
-  // adjust the memtable size
-  memtable_size_cp.db_width = false;
-  memtable_size_cp.opt = memtable_size;
-
-  target_value = std::max(target_value, min_memtable_size);
-  target_value = std::min(target_value, max_memtable_size);
-
+  DBImpl::TuningUpdate::ColumnFamilyUpdate cf_update;
+  cf_update.cf_id = cf.id;
   // SST sizes should be controlled to be the same as memtable size
-  memtable_size_cp.value = std::to_string(target_value);
-  sst_size_cp.value = std::to_string(target_value);
+  cf_update.write_buffer_size = target_value;
+  cf_update.target_file_size_base = target_value;
 
   // calculate the total size of L1
-  uint64_t l1_size = current_opt.level0_file_num_compaction_trigger *
-                     current_opt.min_write_buffer_number_to_merge *
-                     target_value;
-
-  L1_total_size.value = std::to_string(l1_size);
-  sst_size_cp.db_width = false;
-  L1_total_size.db_width = false;
-
-  //  change_list->push_back(write_buffer_number);
-  change_list->push_back(memtable_size_cp);
-  change_list->push_back(L1_total_size);
-  change_list->push_back(sst_size_cp);
+  cf_update.max_bytes_for_level_base =
+      static_cast<uint64_t>(cf.level0_file_num_compaction_trigger) *
+      cf.min_write_buffer_number_to_merge * target_value;
+  update->column_families.push_back(cf_update);
+  if (cf.id == 0) {
+    current_opt.write_buffer_size = target_value;
+  }
 }
 
-void DOTA_Tuner::FillUpChangeList(std::vector<ChangePoint> *change_list,
-                                  TuningOP op) {
-  uint64_t current_thread_num = current_opt.max_background_jobs;
-  uint64_t current_batch_size = current_opt.write_buffer_size;
-  switch (op.BatchOp) {
+void DOTA_Tuner::SetCompactionSpeed(DBImpl::TuningUpdate *update, OpType op) {
+  uint32_t subcompactions = std::max(current_opt.max_subcompactions, 1u);
+  size_t readahead = current_opt.compaction_readahead_size;
+  int64_t rate = current_opt.rate_limiter_bytes_per_sec;
+  switch (op) {
     case kLinearIncrease:
-      SetBatchSize(change_list,
-                   current_batch_size += default_opts.write_buffer_size);
+      subcompactions = std::min(subcompactions + 1, max_subcompactions);
+      readahead = std::min(readahead + readahead_step, max_readahead);
+      rate += max_rate_limit / 4;
       break;
     case kHalf:
-      SetBatchSize(change_list, current_batch_size /= 2);
+      subcompactions = std::max(subcompactions / 2, 1u);
+      // 预读不会减到一个步长以下，用户没开的预读也不会被打开
+      if (readahead > readahead_step) {
+        readahead = std::max(readahead / 2, readahead_step);
+      }
+      rate /= 2;
       break;
     case kKeep:
-      break;
+      return;
+  }
+  if (subcompactions != current_opt.max_subcompactions) {
+    update->max_subcompactions = subcompactions;
+    current_opt.max_subcompactions = subcompactions;
   }
-  switch (op.ThreadOp) {
+  if (readahead != current_opt.compaction_readahead_size) {
+    update->compaction_readahead_size = readahead;
+    current_opt.compaction_readahead_size = readahead;
+  }
+  if (max_rate_limit > 0) {
+    rate = std::max(std::min(rate, max_rate_limit), max_rate_limit / 8);
+    if (rate != current_opt.rate_limiter_bytes_per_sec) {
+      update->rate_limiter_bytes_per_sec = rate;
+      current_opt.rate_limiter_bytes_per_sec = rate;
+    }
+  }
+}
+
+void DOTA_Tuner::FillUpChangeList(DBImpl::TuningUpdate *update,
+                                  OpType thread_op,
+                                  const std::vector<OpType> &batch_ops,
+                                  OpType compaction_op) {
+  uint64_t current_thread_num = current_opt.max_background_jobs;
+  std::vector<uint64_t> targets;
+  targets.reserve(cf_scores_.size());
+  for (size_t i = 0; i < cf_scores_.size(); i++) {
+    const auto &cf = cf_scores_[i];
+    uint64_t current_batch_size = cf.write_buffer_size;
+    switch (batch_ops[i]) {
+      case kLinearIncrease:
+        current_batch_size += cf_history_.at(cf.id).base_write_buffer_size;
+        break;
+      case kHalf:
+        current_batch_size /= 2;
+        break;
+      case kKeep:
+        break;
+    }
+    if (batch_ops[i] != kKeep) {
+      current_batch_size = std::max(current_batch_size, MemtableFloor(cf));
+      current_batch_size = std::min(current_batch_size, max_memtable_size);
+    }
+    targets.push_back(current_batch_size);
+  }
+  FitIntoWriteBufferBudget(&targets);
+  last_op_.ThreadOp = thread_op;
+  last_op_.BatchOp = kKeep;
+  last_op_.CompactionOp = compaction_op;
+  for (size_t i = 0; i < cf_scores_.size(); i++) {
+    if (targets[i] != cf_scores_[i].write_buffer_size) {
+      SetBatchSize(update, cf_scores_[i], targets[i]);
+    }
+    if (cf_scores_[i].id == 0) {
+      last_op_.BatchOp = batch_ops[i];
+    }
+  }
+  switch (thread_op) {
     case kLinearIncrease:
-      SetThreadNum(change_list, current_thread_num += 2);
+      SetThreadNum(update, current_thread_num += 2);
       break;
     case kHalf:
-      SetThreadNum(change_list, current_thread_num /= 2);
+      SetThreadNum(update, current_thread_num /= 2);
       break;
     case kKeep:
       break;
   }
+  SetCompactionSpeed(update, compaction_op);
 }
 
 SystemScores SystemScores::operator-(const SystemScores &a) {
@@ -316,6 +622,7 @@ SystemScores SystemScores::operator-(const SystemScores &a) {
   temp.memtable_speed = this->memtable_speed - a.memtable_speed;
   temp.active_size_ratio = this->active_size_ratio - a.active_size_ratio;
   temp.immutable_number = this->immutable_number - a.immutable_number;
+  temp.memtable_fill = this->memtable_fill - a.memtable_fill;
   temp.flush_speed_avg = this->flush_speed_avg - a.flush_speed_avg;
   temp.flush_speed_var = this->flush_speed_var - a.flush_speed_var;
   temp.l0_num = this->l0_num - a.l0_num;
@@ -338,6 +645,7 @@ SystemScores SystemScores::operator+(const SystemScores &a) {
   temp.memtable_speed = this->memtable_speed + a.memtable_speed;
   temp.active_size_ratio = this->active_size_ratio + a.active_size_ratio;
   temp.immutable_number = this->immutable_number + a.immutable_number;
+  temp.memtable_fill = this->memtable_fill + a.memtable_fill;
   temp.flush_speed_avg = this->flush_speed_avg + a.flush_speed_avg;
   temp.flush_speed_var = this->flush_speed_var + a.flush_speed_var;
   temp.l0_num = this->l0_num + a.l0_num;
@@ -358,6 +666,7 @@ SystemScores SystemScores::operator/(const int &a) {
   temp.memtable_speed = this->memtable_speed / a;
   temp.active_size_ratio = this->active_size_ratio / a;
   temp.immutable_number = this->immutable_number / a;
+  temp.memtable_fill = this->memtable_fill / a;
   temp.l0_num = this->l0_num / a;
   temp.l0_drop_ratio = this->l0_drop_ratio / a;
   temp.estimate_compaction_bytes = this->estimate_compaction_bytes / a;
@@ -380,22 +689,29 @@ SystemScores SystemScores::operator/(const int &a) {
 FEAT_Tuner::~FEAT_Tuner() = default;
 
 void FEAT_Tuner::DetectTuningOperations(int /*secs_elapsed*/,
-                                        std::vector<ChangePoint> *change_list) {
+                                        DBImpl::TuningUpdate *update) {
   //   first, we tune only when the flushing speed is slower than before
+  last_op_ = TuningOP{kKeep, kKeep};
   auto current_score = this->ScoreTheSystem();
-  if (current_score.flush_speed_avg == 0) return ;
+  // 没有 flush 的轮次也要留下来，预测需要连续的压力变化
   scores.push_back(current_score);
-  if (scores.size() == 1) {
-    return;
-  }
-  this->UpdateMaxScore(current_score);
   if (scores.size() >= (size_t)this->score_array_len) {
     // remove the first record
     scores.pop_front();
   }
+  if (current_score.flush_speed_avg == 0) return ;
+  if (scores.size() == 1) {
+    return;
+  }
+  this->UpdateMaxScore(current_score);
   CalculateAvgScore();
 
-  current_score_ = current_score;
+  auto forecast = ForecastStall(scores, forecast_samples);
+  if (forecast.Nearest() <= forecast_horizon) {
+    ROCKS_LOG_INFO(info_log(), "[tuner] stall forecast in %.1f secs",
+                   forecast.Nearest());
+  }
+  current_score_ = ProjectScore(current_score, forecast, forecast_horizon);
   
 //  std::cout << current_score_.flush_speed_avg<< std::endl;
 
@@ -411,11 +727,19 @@ void FEAT_Tuner::DetectTuningOperations(int /*secs_elapsed*/,
    if (TEA_enable) {
       result = TuneByTEA();
    }
+    std::vector<OpType> batch_ops(cf_scores_.size(), kKeep);
     if (FEA_enable) {
-      TuningOP fea_result = TuneByFEA();
-      result.BatchOp = fea_result.BatchOp;
+      for (size_t i = 0; i < cf_scores_.size(); i++) {
+        const auto &cf = cf_scores_[i];
+        auto &history = cf_history_[cf.id];
+        auto cf_score = ProjectScore(
+            cf.scores, ForecastStall(history.recent, forecast_samples),
+            forecast_horizon);
+        batch_ops[i] =
+            VoteForColumnFamily(cf, TuneByFEA(cf_score, history.max_scores));
+      }
     }
-    FillUpChangeList(change_list, result);
+    FillUpChangeList(update, result.ThreadOp, batch_ops, result.CompactionOp);
 
   }
  }
@@ -434,6 +758,8 @@ TuningOP FEAT_Tuner::TuneByTEA() {
 
   if (current_score_.flush_speed_avg < max_scores.flush_speed_avg * TEA_slow_flush && current_score_.flush_speed_avg > 0 ) {
     result.ThreadOp = kHalf;
+    // compaction 读写占了 flush 的带宽，让每个 compaction 慢下来
+    result.CompactionOp = kHalf;
     std::cout << "slow flush, decrease thread" << std::endl;
   }
 
@@ -441,23 +767,31 @@ TuningOP FEAT_Tuner::TuneByTEA() {
   if (current_score_.estimate_compaction_bytes >= 1 || current_score_.l0_num >= 1) {
     result.ThreadOp = kLinearIncrease;
     std::cout << "lo/ro increase, thread" << std::endl;
+    if (current_score_.compaction_idle_time > idle_threshold) {
+      // compaction 线程空着但 L0 还在堆积：一个很长的 L0->L1 compaction
+      // 挡住了后面的，加线程没用，要拆成 subcompaction 并加大预读
+      result.ThreadOp = kKeep;
+      result.CompactionOp = kLinearIncrease;
+      ROCKS_LOG_INFO(info_log(),
+                     "[tuner] long compaction, increase subcompactions");
+    }
   }
 
   return result;
 }
 
-TuningOP FEAT_Tuner::TuneByFEA() {
-  TuningOP negative_protocol{kKeep, kKeep};
+OpType FEAT_Tuner::TuneByFEA(const SystemScores &score,
+                             const SystemScores &max_score) {
+  OpType negative_protocol = kKeep;
 
-  if (current_score_.flush_speed_avg <
-          max_scores.flush_speed_avg * TEA_slow_flush ||
-      current_score_.immutable_number > 1) {
-    negative_protocol.BatchOp = kLinearIncrease;
+  if (score.flush_speed_avg < max_score.flush_speed_avg * TEA_slow_flush ||
+      score.immutable_number > 1 || score.memtable_fill >= 1) {
+    negative_protocol = kLinearIncrease;
     std::cout << "slow flushing, increase batch" << std::endl;
   }
 
-  if (current_score_.estimate_compaction_bytes >= 1) {
-    negative_protocol.BatchOp = kHalf;
+  if (score.estimate_compaction_bytes >= 1) {
+    negative_protocol = kHalf;
     std::cout << "ro, decrease batch" << std::endl;
   }
   return negative_protocol;
@@ -0,0 +1,239 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/utilities/report_agent.h"
+
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class StallForecastTest : public testing::Test {
+ public:
+  // 每 `gap_secs` 秒一轮，L0 压力每轮增加 `l0_step`
+  static std::deque<SystemScores> Rounds(int rounds, int gap_secs,
+                                         double l0_step) {
+    std::deque<SystemScores> scores;
+    for (int i = 0; i < rounds; i++) {
+      SystemScores score;
+      score.timestamp_micros = (uint64_t)(i * gap_secs) * 1000000;
+      score.l0_num = 0.1 + l0_step * i;
+      scores.push_back(score);
+    }
+    return scores;
+  }
+};
+
+// 测试：按线性趋势算出到达 slowdown 触发线的时间
+TEST_F(StallForecastTest, RisingTrendGivesTimeToStall) {
+  // 1. Arrange
+  auto scores = Rounds(5, 10, 0.1);
+
+  // 2. Act
+  auto forecast = ForecastStall(scores, 5);
+
+  // 3. Assert
+  ASSERT_NEAR(forecast.l0_slope, 0.01, 1e-9);
+  // 最后一轮 l0_num = 0.5，还要 (1 - 0.5) / 0.01 秒
+  ASSERT_NEAR(forecast.l0_secs, 50, 1e-6);
+  ASSERT_EQ(forecast.memtable_secs, StallForecast::kNoStall);
+  ASSERT_EQ(forecast.pending_bytes_secs, StallForecast::kNoStall);
+  ASSERT_NEAR(forecast.Nearest(), 50, 1e-6);
+}
+
+// 测试：压力持平或下降时不预测写停顿，也不外推
+TEST_F(StallForecastTest, FlatOrFallingTrendNeverStalls) {
+  // 1. Arrange
+  auto flat = Rounds(5, 10, 0);
+  auto falling = Rounds(5, 10, -0.02);
+
+  // 2. Act
+  auto flat_forecast = ForecastStall(flat, 5);
+  auto falling_forecast = ForecastStall(falling, 5);
+  auto projected = ProjectScore(falling.back(), falling_forecast, 20);
+
+  // 3. Assert
+  ASSERT_EQ(flat_forecast.Nearest(), StallForecast::kNoStall);
+  ASSERT_EQ(falling_forecast.Nearest(), StallForecast::kNoStall);
+  ASSERT_DOUBLE_EQ(projected.l0_num, falling.back().l0_num);
+}
+
+// 测试：只用最近 `samples` 轮，预测范围内的 memtable 写满会提前反映出来
+TEST_F(StallForecastTest, ProjectsRecentMemtableTrend) {
+  // 1. Arrange
+  auto scores = Rounds(6, 10, 0);
+  // 前两轮 memtable 压力很高，之后从 0.2 开始每轮涨 0.2
+  scores[0].memtable_fill = 0.9;
+  scores[1].memtable_fill = 0.9;
+  for (int i = 2; i < 6; i++) {
+    scores[i].memtable_fill = 0.2 * (i - 1);
+  }
+
+  // 2. Act
+  auto forecast = ForecastStall(scores, 4);
+  auto projected = ProjectScore(scores.back(), forecast, 20);
+
+  // 3. Assert
+  ASSERT_NEAR(forecast.memtable_slope, 0.02, 1e-9);
+  ASSERT_NEAR(forecast.memtable_secs, 10, 1e-6);
+  ASSERT_NEAR(projected.memtable_fill, 1.2, 1e-9);
+  ASSERT_EQ(projected.immutable_number, 1);
+  ASSERT_EQ(scores.back().immutable_number, 0);
+}
+
+// 测试：CompactionOp 同时调整 subcompaction 数、预读和限速，并且不越界
+TEST(CompactionSpeedTest, StepsAndClampsCompactionKnobs) {
+  // 1. Arrange
+  Options options;
+  options.core_number = 8;
+  options.max_subcompactions = 1;
+  options.compaction_readahead_size = 0;
+  options.rate_limiter.reset(NewGenericRateLimiter(64 << 20));
+  auto events = std::make_shared<TunerEventListener>(Env::Default());
+  DOTA_Tuner tuner(options, nullptr, nullptr, nullptr, Env::Default(), 1,
+                   events);
+  DBImpl::TuningUpdate first_half;
+  std::vector<DBImpl::TuningUpdate> increases(9);
+  DBImpl::TuningUpdate second_half;
+
+  // 2. Act
+  tuner.SetCompactionSpeed(&first_half, kHalf);
+  for (auto& update : increases) {
+    tuner.SetCompactionSpeed(&update, kLinearIncrease);
+  }
+  tuner.SetCompactionSpeed(&second_half, kHalf);
+
+  // 3. Assert
+  // 已经是限速上限，没开预读，只有一个 subcompaction：只有限速能降
+  ASSERT_EQ(first_half.max_subcompactions, 0u);
+  ASSERT_EQ(first_half.compaction_readahead_size, 0u);
+  ASSERT_EQ(first_half.rate_limiter_bytes_per_sec, 32 << 20);
+  ASSERT_EQ(increases[0].max_subcompactions, 2u);
+  ASSERT_EQ(increases[0].compaction_readahead_size, 2u << 20);
+  ASSERT_EQ(increases[0].rate_limiter_bytes_per_sec, 48 << 20);
+  // subcompaction 最多 core_number / 2 个，预读最多 16MB，
+  // 限速不超过用户配置的速度
+  ASSERT_TRUE(increases[8].empty());
+  ASSERT_EQ(tuner.tuned_options().max_subcompactions, 4u);
+  ASSERT_EQ(tuner.tuned_options().compaction_readahead_size, 16u << 20);
+  ASSERT_EQ(tuner.tuned_options().rate_limiter_bytes_per_sec, 64 << 20);
+  ASSERT_EQ(second_half.max_subcompactions, 2u);
+  ASSERT_EQ(second_half.compaction_readahead_size, 8u << 20);
+  ASSERT_EQ(second_half.rate_limiter_bytes_per_sec, 32 << 20);
+}
+
+// 不连 DB，直接摆好各列族的打分
+class BatchSizeTuner : public DOTA_Tuner {
+ public:
+  using DOTA_Tuner::DOTA_Tuner;
+
+  void AddColumnFamily(uint32_t id, uint64_t write_buffer_size,
+                       uint64_t base_write_buffer_size,
+                       uint64_t ingest_bytes = 0) {
+    ColumnFamilyScores cf;
+    cf.id = id;
+    cf.ingest_bytes = ingest_bytes;
+    cf.write_buffer_size = write_buffer_size;
+    cf.max_write_buffer_number = 2;
+    cf.level0_file_num_compaction_trigger = 4;
+    cf.min_write_buffer_number_to_merge = 1;
+    cf_scores_.push_back(cf);
+    cf_history_[id].base_write_buffer_size = base_write_buffer_size;
+  }
+
+  const ColumnFamilyScores& column_family(size_t i) const {
+    return cf_scores_[i];
+  }
+};
+
+// 测试：BatchOp 不是 kKeep 时按列族改 memtable、SST 和 L1 的大小
+TEST(BatchSizeTest, FillUpChangeListResizesEachColumnFamily) {
+  // 1. Arrange
+  Options options;
+  options.max_memtable_size = 1ull << 30;
+  auto events = std::make_shared<TunerEventListener>(Env::Default());
+  BatchSizeTuner tuner(options, nullptr, nullptr, nullptr, Env::Default(), 1,
+                       events);
+  tuner.AddColumnFamily(0, 64 << 20, 64 << 20);
+  tuner.AddColumnFamily(1, 256 << 20, 128 << 20);
+  tuner.AddColumnFamily(2, 64 << 20, 64 << 20);
+  DBImpl::TuningUpdate update;
+
+  // 2. Act
+  tuner.FillUpChangeList(&update, kKeep, {kLinearIncrease, kHalf, kKeep});
+
+  // 3. Assert
+  // 第三个列族保持不变，不出现在更新里
+  ASSERT_EQ(update.column_families.size(), 2u);
+  const auto& grown = update.column_families[0];
+  ASSERT_EQ(grown.cf_id, 0u);
+  ASSERT_EQ(grown.write_buffer_size, 128u << 20);
+  ASSERT_EQ(grown.target_file_size_base, 128u << 20);
+  ASSERT_EQ(grown.max_bytes_for_level_base, 4 * (128ull << 20));
+  const auto& halved = update.column_families[1];
+  ASSERT_EQ(halved.cf_id, 1u);
+  ASSERT_EQ(halved.write_buffer_size, 128u << 20);
+  ASSERT_EQ(tuner.tuned_options().write_buffer_size, 128u << 20);
+  ASSERT_EQ(tuner.last_op().BatchOp, kLinearIncrease);
+  ASSERT_EQ(update.max_background_jobs, 0);
+}
+
+// 测试：超出预算时先保底，写入快但要得少的列族用不完的预算分给其他列族
+TEST(BatchSizeTest, BudgetSlackGoesToOtherColumnFamilies) {
+  // 1. Arrange
+  Options options;
+  options.max_memtable_size = 1ull << 30;
+  auto events = std::make_shared<TunerEventListener>(Env::Default());
+  BatchSizeTuner tuner(options, nullptr, nullptr, nullptr, Env::Default(), 1,
+                       events);
+  tuner.AddColumnFamily(0, 256 << 20, 64 << 20, 100);
+  tuner.AddColumnFamily(1, 128 << 20, 64 << 20, 300);
+  tuner.AddColumnFamily(2, 64 << 20, 64 << 20, 0);
+  std::vector<uint64_t> targets = {256 << 20, 128 << 20, 64 << 20};
+
+  // 2. Act
+  // 每个列族 2 个 memtable，保底 384MB，还剩 256MB 可分
+  tuner.ShareWriteBufferBudget(640 << 20, &targets);
+
+  // 3. Assert
+  // 第一轮列族 0 分到 64MB，列族 1 按写入量该分 192MB 但只要 128MB，
+  // 多出的 64MB 第二轮给列族 0
+  ASSERT_EQ(targets[0], 128u << 20);
+  ASSERT_EQ(targets[1], 128u << 20);
+  ASSERT_EQ(targets[2], 64u << 20);
+}
+
+// 测试：冷列族只缩到装得下一轮写入，没有写入的列族不再缩
+TEST(BatchSizeTest, IdleColumnFamilyStopsShrinking) {
+  // 1. Arrange
+  Options options;
+  auto events = std::make_shared<TunerEventListener>(Env::Default());
+  BatchSizeTuner tuner(options, nullptr, nullptr, nullptr, Env::Default(), 1,
+                       events);
+  tuner.AddColumnFamily(0, 64 << 20, 64 << 20, 0);
+  tuner.AddColumnFamily(1, 64 << 20, 64 << 20, 1 << 20);
+  tuner.AddColumnFamily(2, 64 << 20, 64 << 20, 48 << 20);
+
+  // 2. Act
+  OpType idle = tuner.VoteForColumnFamily(tuner.column_family(0),
+                                          kLinearIncrease);
+  OpType cold = tuner.VoteForColumnFamily(tuner.column_family(1),
+                                          kLinearIncrease);
+  OpType warm = tuner.VoteForColumnFamily(tuner.column_family(2),
+                                          kLinearIncrease);
+
+  // 3. Assert
+  ASSERT_EQ(idle, kKeep);
+  ASSERT_EQ(cold, kHalf);
+  ASSERT_EQ(warm, kKeep);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -7,13 +7,16 @@
 #include "rocksdb/utilities/DOTA_tuner.h"
 
 namespace ROCKSDB_NAMESPACE {
-ReporterAgent::~ReporterAgent() {
+ReporterAgent::~ReporterAgent() { StopReporting(); }
+void ReporterAgent::StopReporting() {
   {
     std::unique_lock<std::mutex> lk(mutex_);
     stop_ = true;
     stop_cv_.notify_all();
   }
-  reporting_thread_.join();
+  if (reporting_thread_.joinable()) {
+    reporting_thread_.join();
+  }
 }
 void ReporterAgent::InsertNewTuningPoints(ChangePoint point) {
   std::cout << "can't use change point @ " << point.change_timing
@@ -29,20 +32,63 @@ Status ReporterAgent::ReportLine(int secs_elapsed,
 }
 
 void ReporterAgentWithTuning::DetectChangesPoints(int sec_elapsed) {
-  std::vector<ChangePoint> change_points;
-  if (applying_changes) {
+  DBImpl::TuningUpdate update;
+  tuner->DetectTuningOperations(sec_elapsed, &update);
+  if (trace_writer_ != nullptr) {
+    TunerTraceRecord record;
+    record.secs_elapsed = sec_elapsed;
+    record.scores = tuner->last_score();
+    record.op = tuner->last_op();
+    record.max_background_jobs = tuner->tuned_options().max_background_jobs;
+    record.write_buffer_size = tuner->tuned_options().write_buffer_size;
+    record.max_subcompactions = tuner->tuned_options().max_subcompactions;
+    record.compaction_readahead_size =
+        tuner->tuned_options().compaction_readahead_size;
+    record.rate_limiter_bytes_per_sec =
+        tuner->tuned_options().rate_limiter_bytes_per_sec;
+    Status s = trace_writer_->Append(record);
+    if (!s.ok()) {
+      std::cout << "tuner trace stopped: " << s.ToString() << std::endl;
+      trace_writer_.reset();
+    }
+  }
+  if (update.empty()) {
     return;
   }
-  tuner->DetectTuningOperations(sec_elapsed, &change_points);
-  ApplyChangePointsInstantly(&change_points);
+  Status s = running_db_->ApplyTuningUpdate(update);
+  if (!s.ok()) {
+    std::cout << "apply tuning update failed: " << s.ToString() << std::endl;
+  }
 }
 
-void ReporterAgentWithTuning::DetectAndTuning(int secs_elapsed) {
-  if (secs_elapsed % tuning_gap_secs_ == 0) {
+void ReporterAgentWithTuning::TuneOnEvents() {
+  const uint64_t gap_micros = tuning_gap_secs_ * kMicrosInSecond;
+  while (true) {
+    events_->WaitForTuningRound(gap_micros);
+    if (tuning_stopped_.load()) {
+      break;
+    }
+    int secs_elapsed =
+        static_cast<int>((env_->NowMicros() - tuning_started_) /
+                         kMicrosInSecond);
+    std::lock_guard<std::mutex> lock(tuner_mutex_);
     DetectChangesPoints(secs_elapsed);
-    //    this->running_db_->immutable_db_options().job_stats->clear();
     last_metrics_collect_secs = secs_elapsed;
   }
+}
+
+void ReporterAgentWithTuning::DetectAndTuning(int secs_elapsed) {
+  // 调优轮次由 tuning_thread_ 驱动，这里只处理预设的 change points，
+  // 并且低频地把调过的 options 写回 OPTIONS 文件
+  if (secs_elapsed - last_persist_secs_ >= kPersistOptionsGapSecs) {
+    last_persist_secs_ = secs_elapsed;
+    Status s = running_db_->PersistTunedOptions();
+    if (!s.ok()) {
+      std::cout << "persist tuned options failed: " << s.ToString()
+                << std::endl;
+    }
+  }
+  std::lock_guard<std::mutex> lock(tuner_mutex_);
   if (tuning_points.empty() ||
       tuning_points.front().change_timing < secs_elapsed) {
     return;
@@ -53,95 +99,70 @@ void ReporterAgentWithTuning::DetectAndTuning(int secs_elapsed) {
 
 Status ReporterAgentWithTuning::ReportLine(int secs_elapsed,
                                            int total_ops_done_snapshot) {
-  auto opt = this->running_db_->GetOptions();
+  uint64_t write_buffer_size;
+  int max_background_jobs;
+  {
+    std::lock_guard<std::mutex> lock(tuner_mutex_);
+    write_buffer_size = tuner->tuned_options().write_buffer_size;
+    max_background_jobs = tuner->tuned_options().max_background_jobs;
+  }
 
   std::string report = std::to_string(secs_elapsed) + "," +
                        std::to_string(total_ops_done_snapshot - last_report_) + "," +
-                       std::to_string(opt.write_buffer_size >> 20) + "," +
-                       std::to_string(opt.max_background_jobs);
+                       std::to_string(write_buffer_size >> 20) + "," +
+                       std::to_string(max_background_jobs);
   auto s = report_file_->Append(report);
   return s;
 }
 void ReporterAgentWithTuning::UseFEATTuner(bool TEA_enable, bool FEA_enable) {
-  tuner.release();
+  std::lock_guard<std::mutex> lock(tuner_mutex_);
   tuner.reset(new FEAT_Tuner(options_when_boost, running_db_, &last_report_,
-                             &total_ops_done_, env_, tuning_gap_secs_,
+                             &total_ops_done_, env_, tuning_gap_secs_, events_,
                              TEA_enable, FEA_enable));
 };
 
-Status update_db_options(
-    DBImpl* running_db_,
-    std::unordered_map<std::string, std::string>* new_db_options,
-    bool* applying_changes, Env* /*env*/) {
-  *applying_changes = true;
-  Status s = running_db_->SetDBOptions(*new_db_options);
-  free(new_db_options);
-  *applying_changes = false;
-  return s;
-}
-
-Status update_cf_options(
-    DBImpl* running_db_,
-    std::unordered_map<std::string, std::string>* new_cf_options,
-    bool* applying_changes, Env* /*env*/) {
-  *applying_changes = true;
-  Status s = running_db_->SetOptions(*new_cf_options);
-  free(new_cf_options);
-  *applying_changes = false;
-  return s;
-}
-
-Status SILK_pause_compaction(DBImpl* running_db_, bool* stopped) {
-  Status s = running_db_->PauseBackgroundWork();
-  *stopped = true;
-  return s;
-}
-
-Status SILK_resume_compaction(DBImpl* running_db_, bool* stopped) {
-  Status s = running_db_->ContinueBackgroundWork();
-  *stopped = false;
-  return s;
+Status ReporterAgentWithTuning::StartTunerTrace(const std::string& fname) {
+  std::lock_guard<std::mutex> lock(tuner_mutex_);
+  return TunerTraceWriter::Create(env_, fname, &trace_writer_);
 }
 
 void ReporterAgentWithTuning::ApplyChangePointsInstantly(
     std::vector<ChangePoint>* points) {
-  std::unordered_map<std::string, std::string>* new_cf_options;
-  std::unordered_map<std::string, std::string>* new_db_options;
-
-  new_cf_options = new std::unordered_map<std::string, std::string>();
-  new_db_options = new std::unordered_map<std::string, std::string>();
   if (points->empty()) {
     return;
   }
-
-  for (auto point : *points) {
+  std::unordered_map<std::string, std::string> new_cf_options;
+  std::unordered_map<std::string, std::string> new_db_options;
+  for (const auto& point : *points) {
     if (point.db_width) {
-      new_db_options->emplace(point.opt, point.value);
+      new_db_options.emplace(point.opt, point.value);
     } else {
-      new_cf_options->emplace(point.opt, point.value);
+      new_cf_options.emplace(point.opt, point.value);
     }
   }
   points->clear();
   Status s;
-  if (!new_db_options->empty()) {
-    //    std::thread t();
-    std::thread t(update_db_options, running_db_, new_db_options,
-                  &applying_changes, env_);
-    t.detach();
+  if (!new_db_options.empty()) {
+    s = running_db_->SetDBOptions(new_db_options);
+  }
+  if (s.ok() && !new_cf_options.empty()) {
+    s = running_db_->SetOptions(new_cf_options);
   }
-  if (!new_cf_options->empty()) {
-    std::thread t(update_cf_options, running_db_, new_cf_options,
-                  &applying_changes, env_);
-    t.detach();
+  if (!s.ok()) {
+    std::cout << "apply change points failed: " << s.ToString() << std::endl;
   }
 }
 
-ReporterAgentWithTuning::ReporterAgentWithTuning(DBImpl* running_db, Env* env,
-                                                 const std::string& fname,
-                                                 uint64_t report_interval_secs,
-                                                 uint64_t dota_tuning_gap_secs)
+ReporterAgentWithTuning::ReporterAgentWithTuning(
+    DBImpl* running_db, Env* env, const std::string& fname,
+    uint64_t report_interval_secs, uint64_t dota_tuning_gap_secs,
+    std::shared_ptr<TunerEventListener> events)
     : ReporterAgent(env, fname, report_interval_secs, DOTAHeader()),
-      options_when_boost(running_db->GetOptions()) {
+      options_when_boost(running_db->GetOptions()),
+      events_(std::move(events)),
+      tuning_started_(env->NowMicros()),
+      last_persist_secs_(0),
+      tuning_stopped_(false) {
   tuning_points = std::vector<ChangePoint>();
   tuning_points.clear();
   std::cout << "using reporter agent with change points." << std::endl;
@@ -153,12 +174,27 @@ ReporterAgentWithTuning::ReporterAgentWithTuning(DBImpl* running_db, Env* env,
   }
   this->tuning_gap_secs_ = std::max(dota_tuning_gap_secs, report_interval_secs);
   this->last_metrics_collect_secs = 0;
-  this->last_compaction_thread_len = 0;
-  this->last_flush_thread_len = 0;
+  if (events_ == nullptr) {
+    std::cout << "Missing the TunerEventListener of db_ to collect metrics"
+              << std::endl;
+    abort();
+  }
   tuner.reset(new DOTA_Tuner(options_when_boost, running_db_, &last_report_,
-                             &total_ops_done_, env_, tuning_gap_secs_));
+                             &total_ops_done_, env_, tuning_gap_secs_,
+                             events_));
   tuner->ResetTuner();
-  this->applying_changes = false;
+  tuning_thread_ = port::Thread([this]() { TuneOnEvents(); });
+}
+
+ReporterAgentWithTuning::~ReporterAgentWithTuning() {
+  StopReporting();
+  tuning_stopped_.store(true);
+  events_->Wake();
+  tuning_thread_.join();
+  if (trace_writer_ != nullptr) {
+    trace_writer_->Close().PermitUncheckedError();
+  }
+  running_db_->PersistTunedOptions().PermitUncheckedError();
 }
 
 inline double average(std::vector<double>& v) {
@@ -187,60 +223,37 @@ void ReporterWithMoreDetails::DetectAndTuning(int secs_elapsed) {
 
 Status ReporterAgentWithSILK::ReportLine(int secs_elapsed,
                                          int total_ops_done_snapshot) {
-  // copy from SILK https://github.com/theoanab/SILK-USENIXATC2019
-  // //check the current bandwidth for user operations
-  long cur_throughput = (total_ops_done_snapshot - last_report_);
-  long cur_bandwidth_user_ops_MBPS =
-      cur_throughput * FLAGS_value_size / 1000000;
-
-  // SILK TESTING the Pause compaction work functionality
-  if (!pausedcompaction &&
-      cur_bandwidth_user_ops_MBPS > FLAGS_SILK_bandwidth_limitation * 0.75) {
-    // SILK Consider this a load peak
-    //    running_db_->PauseCompactionWork();
-    //    pausedcompaction = true;
-    pausedcompaction = true;
-    std::thread t(SILK_pause_compaction, running_db_, &pausedcompaction);
-    t.detach();
-
-  } else if (pausedcompaction && cur_bandwidth_user_ops_MBPS <=
-                                     FLAGS_SILK_bandwidth_limitation * 0.75) {
-    std::thread t(SILK_resume_compaction, running_db_, &pausedcompaction);
-    t.detach();
-  }
-
-  long cur_bandiwdth_compaction_MBPS =
-      FLAGS_SILK_bandwidth_limitation -
-      cur_bandwidth_user_ops_MBPS;  // measured 200MB/s SSD bandwidth on XEON.
-  if (cur_bandiwdth_compaction_MBPS < 10) {
-    cur_bandiwdth_compaction_MBPS = 10;
-  }
-  if (abs(prev_bandwidth_compaction_MBPS - cur_bandiwdth_compaction_MBPS) >=
-      10) {
-    auto opt = running_db_->GetOptions();
-    opt.rate_limiter.get()->SetBytesPerSecond(cur_bandiwdth_compaction_MBPS *
-                                              1000 * 1000);
-    prev_bandwidth_compaction_MBPS = cur_bandiwdth_compaction_MBPS;
-  }
-  // Adjust the tuner from SILK before reporting
+  // The limiter throttles IO_LOW (deep compactions) by the client write rate,
+  // IO_HIGH (flush) and IO_MID (L0 compactions) keep the whole bandwidth
+  RateLimiter* limiter = running_db_->immutable_db_options().rate_limiter.get();
   std::string report = std::to_string(secs_elapsed) + "," +
-                       std::to_string(total_ops_done_snapshot - last_report_) + "," +
-                       std::to_string(cur_bandwidth_user_ops_MBPS);
+                       std::to_string(total_ops_done_snapshot - last_report_);
+  for (Env::IOPriority pri : {Env::IO_HIGH, Env::IO_MID, Env::IO_LOW}) {
+    int64_t bytes_through =
+        limiter == nullptr ? 0 : limiter->GetTotalBytesThrough(pri);
+    double mbps = static_cast<double>(bytes_through - last_bytes_through_[pri]) /
+                  (report_interval_secs_ * 1048576.0);
+    last_bytes_through_[pri] = bytes_through;
+    report += "," + std::to_string(mbps);
+  }
   auto s = report_file_->Append(report);
   return s;
 }
 
 ReporterAgentWithSILK::ReporterAgentWithSILK(DBImpl* running_db, Env* env,
                                              const std::string& fname,
-                                             uint64_t report_interval_secs,
-                                             int32_t value_size,
-                                             int32_t bandwidth_limitation)
-    : ReporterAgent(env, fname, report_interval_secs) {
-  std::cout << "SILK enabled, Disk bandwidth has been set to: "
-            << bandwidth_limitation << std::endl;
+                                             uint64_t report_interval_secs)
+    : ReporterAgent(env, fname, report_interval_secs, SILKHeader()) {
   running_db_ = running_db;
-  this->FLAGS_value_size = value_size;
-  this->FLAGS_SILK_bandwidth_limitation = bandwidth_limitation;
+  RateLimiter* limiter = running_db_->immutable_db_options().rate_limiter.get();
+  if (limiter == nullptr || !limiter->IsForegroundAware()) {
+    std::cout << "SILK enabled without a foreground-aware rate limiter, "
+                 "compactions are not arbitrated"
+              << std::endl;
+  } else {
+    std::cout << "SILK enabled, Disk bandwidth has been set to: "
+              << (limiter->GetBytesPerSecond() >> 20) << " MB/s" << std::endl;
+  }
 }
 
 };  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,66 @@
+//
+//  arrival_schedule.cc
+//  YCSB-cpp
+//
+
+#include "arrival_schedule.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace ycsbc {
+
+const std::string ArrivalSchedule::TARGET_PROPERTY = "target";
+const std::string ArrivalSchedule::TARGET_SCHEDULE_PROPERTY = "targetschedule";
+const std::string ArrivalSchedule::ARRIVAL_PROPERTY = "arrival";
+const std::string ArrivalSchedule::ARRIVAL_DEFAULT = "constant";
+const std::string ArrivalSchedule::LOAD_PREFIX = "load.";
+
+utils::Properties ArrivalSchedule::LoadPhaseProperties(const utils::Properties &p) {
+  utils::Properties load_props = p;
+  load_props.SetProperty(TARGET_PROPERTY, "0");
+  load_props.SetProperty(TARGET_SCHEDULE_PROPERTY, "");
+  load_props.OverrideWithPrefix(LOAD_PREFIX);
+  return load_props;
+}
+
+ArrivalSchedule::ArrivalSchedule(const utils::Properties &p, int num_threads)
+    : poisson_(false) {
+  const std::string arrival = p.GetProperty(ARRIVAL_PROPERTY, ARRIVAL_DEFAULT);
+  if (arrival == "poisson") {
+    poisson_ = true;
+  } else if (arrival != "constant") {
+    throw utils::Exception("Unknown arrival process: " + arrival);
+  }
+
+  const std::string schedule = p.GetProperty(TARGET_SCHEDULE_PROPERTY);
+  if (!schedule.empty()) {
+    std::stringstream points(schedule);
+    std::string point;
+    while (std::getline(points, point, ',')) {
+      size_t colon = point.find(':');
+      if (colon == std::string::npos) {
+        throw utils::Exception("Bad " + TARGET_SCHEDULE_PROPERTY + " point: " + point);
+      }
+      points_.emplace_back(std::stod(point.substr(0, colon)),
+                           std::stod(point.substr(colon + 1)));
+    }
+  } else {
+    double target = std::stod(p.GetProperty(TARGET_PROPERTY, "0"));
+    if (target > 0) {
+      points_.emplace_back(0, target);
+    }
+  }
+  std::stable_sort(points_.begin(), points_.end(),
+                   [](const std::pair<double, double> &a,
+                      const std::pair<double, double> &b) { return a.first < b.first; });
+  for (auto &point : points_) {
+    // 速率为 0 时下一个操作永远排不上，要暂停就把速率调低
+    if (point.second <= 0) {
+      throw utils::Exception(TARGET_SCHEDULE_PROPERTY + " rates must be positive");
+    }
+    point.second /= num_threads;
+  }
+}
+
+} // ycsbc
@@ -0,0 +1,122 @@
+//
+//  arrival_schedule.h
+//  YCSB-cpp
+//
+//  Open-loop load: when the operations are sent, independent of when the
+//  previous ones returned.
+//
+
+#ifndef YCSB_C_ARRIVAL_SCHEDULE_H_
+#define YCSB_C_ARRIVAL_SCHEDULE_H_
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "properties.h"
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// The target rate of one load phase, shared by all the client threads.
+///
+/// Properties:
+///   target          ops/sec of all the threads together, 0 runs closed-loop
+///   targetschedule  "<secs>:<ops/sec>,..." rates at seconds since the start
+///                   of the phase, linear in between, so "0:1000,60:20000"
+///                   ramps and "0:1000,59:1000,60:20000,70:20000,71:1000"
+///                   bursts. Overrides target
+///   arrival         "constant" or "poisson" gaps between the operations
+///
+/// They pace the transaction phase only. The load phase runs closed-loop
+/// unless load.target or load.targetschedule is set, see
+/// LoadPhaseProperties().
+///
+class ArrivalSchedule {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static const std::string TARGET_PROPERTY;
+  static const std::string TARGET_SCHEDULE_PROPERTY;
+  static const std::string ARRIVAL_PROPERTY;
+  static const std::string ARRIVAL_DEFAULT;
+
+  static const std::string LOAD_PREFIX;
+
+  ArrivalSchedule(const utils::Properties &p, int num_threads);
+
+  ///
+  /// `p` with target and targetschedule dropped and the load.* properties
+  /// put in their place, to build the schedule of the load phase from.
+  ///
+  static utils::Properties LoadPhaseProperties(const utils::Properties &p);
+
+  bool open_loop() const { return !points_.empty(); }
+  bool poisson() const { return poisson_; }
+
+  ///
+  /// Ops/sec of one client thread `secs` after it started sending.
+  ///
+  double ThreadRateAt(double secs) const;
+
+ private:
+  // (secs, ops/sec of one thread), sorted by secs
+  std::vector<std::pair<double, double>> points_;
+  bool poisson_;
+};
+
+///
+/// Send times of one client thread, counted from its construction so that
+/// opening the DB does not show up as a backlog.
+///
+class ArrivalProcess {
+ public:
+  explicit ArrivalProcess(const ArrivalSchedule *schedule)
+      : schedule_(schedule), start_(ArrivalSchedule::Clock::now()), secs_(0),
+        rng_(std::random_device()()) {}
+
+  ///
+  /// The time to send the next operation at. It may be in the past when the
+  /// thread falls behind, the latency is still measured from it.
+  ///
+  ArrivalSchedule::Clock::time_point Next() {
+    double rate = schedule_->ThreadRateAt(secs_);
+    double gap = 1.0 / rate;
+    if (schedule_->poisson()) {
+      gap = -std::log(1.0 - uniform_(rng_)) / rate;
+    }
+    secs_ += gap;
+    return start_ +
+           std::chrono::duration_cast<ArrivalSchedule::Clock::duration>(
+               std::chrono::duration<double>(secs_));
+  }
+
+ private:
+  const ArrivalSchedule *schedule_;
+  ArrivalSchedule::Clock::time_point start_;
+  double secs_;
+  std::mt19937_64 rng_;
+  std::uniform_real_distribution<double> uniform_;
+};
+
+inline double ArrivalSchedule::ThreadRateAt(double secs) const {
+  if (secs <= points_.front().first) {
+    return points_.front().second;
+  }
+  for (size_t i = 1; i < points_.size(); ++i) {
+    if (secs < points_[i].first) {
+      const auto &a = points_[i - 1];
+      const auto &b = points_[i];
+      return a.second + (b.second - a.second) * (secs - a.first) / (b.first - a.first);
+    }
+  }
+  return points_.back().second;
+}
+
+} // ycsbc
+
+#endif // YCSB_C_ARRIVAL_SCHEDULE_H_
@@ -0,0 +1,145 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "ycsbcore/arrival_schedule.h"
+
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+
+namespace ycsbc {
+
+class ArrivalScheduleTest : public testing::Test {
+ public:
+  static utils::Properties Props(
+      const std::vector<std::pair<std::string, std::string>>& values) {
+    utils::Properties props;
+    for (const auto& value : values) {
+      props.SetProperty(value.first, value.second);
+    }
+    return props;
+  }
+};
+
+// 测试：没有 target 也没有 targetschedule 时是闭环
+TEST_F(ArrivalScheduleTest, ClosedLoopByDefault) {
+  // 1. Arrange
+  auto none = Props({});
+  auto zero = Props({{"target", "0"}});
+
+  // 2. Act
+  ArrivalSchedule none_schedule(none, 4);
+  ArrivalSchedule zero_schedule(zero, 4);
+
+  // 3. Assert
+  ASSERT_FALSE(none_schedule.open_loop());
+  ASSERT_FALSE(zero_schedule.open_loop());
+  ASSERT_FALSE(none_schedule.poisson());
+}
+
+// 测试：target 按线程平分，速率不随时间变化
+TEST_F(ArrivalScheduleTest, TargetIsSplitAcrossThreads) {
+  // 1. Arrange
+  auto props = Props({{"target", "8000"}, {"arrival", "poisson"}});
+
+  // 2. Act
+  ArrivalSchedule schedule(props, 4);
+
+  // 3. Assert
+  ASSERT_TRUE(schedule.open_loop());
+  ASSERT_TRUE(schedule.poisson());
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(0), 2000);
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(3600), 2000);
+}
+
+// 测试：乱序给出的点会排好序，点之间线性插值，两端之外取端点的速率，
+// targetschedule 优先于 target
+TEST_F(ArrivalScheduleTest, ScheduleInterpolatesBetweenPoints) {
+  // 1. Arrange
+  auto props = Props({{"target", "100"},
+                      {"targetschedule", "60:20000, 10:1000,70:20000,71:1000"}});
+
+  // 2. Act
+  ArrivalSchedule schedule(props, 2);
+
+  // 3. Assert
+  ASSERT_TRUE(schedule.open_loop());
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(0), 500);
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(10), 500);
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(35), 5250);
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(60), 10000);
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(65), 10000);
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(70.5), 5250);
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(71), 500);
+  ASSERT_DOUBLE_EQ(schedule.ThreadRateAt(1000), 500);
+}
+
+// 测试：格式错误、速率不是正数、未知的到达过程都报错
+TEST_F(ArrivalScheduleTest, RejectsBadProperties) {
+  // 1. Arrange
+  auto no_colon = Props({{"targetschedule", "0:1000,60"}});
+  auto zero_rate = Props({{"targetschedule", "0:1000,60:0"}});
+  auto negative_target = Props({{"target", "-5"}});
+  auto unknown_arrival = Props({{"target", "1000"}, {"arrival", "bursty"}});
+
+  // 2. Act & 3. Assert
+  ASSERT_THROW(ArrivalSchedule(no_colon, 1), utils::Exception);
+  ASSERT_THROW(ArrivalSchedule(zero_rate, 1), utils::Exception);
+  ASSERT_THROW(ArrivalSchedule(unknown_arrival, 1), utils::Exception);
+  // 负的 target 和 0 一样是闭环
+  ASSERT_FALSE(ArrivalSchedule(negative_target, 1).open_loop());
+}
+
+// 测试：固定间隔时每个发送时间比上一个晚 1 / 速率
+TEST_F(ArrivalScheduleTest, ConstantArrivalsFollowTheRate) {
+  // 1. Arrange
+  auto props = Props({{"targetschedule", "0:1000,1:1000,2:500"}});
+  ArrivalSchedule schedule(props, 1);
+  ArrivalProcess process(&schedule);
+
+  // 2. Act
+  std::vector<ArrivalSchedule::Clock::time_point> sends;
+  for (int i = 0; i < 1001; i++) {
+    sends.push_back(process.Next());
+  }
+
+  // 3. Assert
+  // 第一秒每毫秒一个
+  auto first_gap = std::chrono::duration<double>(sends[1] - sends[0]).count();
+  ASSERT_NEAR(first_gap, 0.001, 1e-6);
+  auto first_second =
+      std::chrono::duration<double>(sends[999] - sends[0]).count();
+  ASSERT_NEAR(first_second, 0.999, 1e-6);
+  auto last_gap = std::chrono::duration<double>(sends[1000] - sends[999]).count();
+  ASSERT_NEAR(last_gap, 0.001, 1e-4);
+}
+
+// 测试：target 和 targetschedule 只管事务阶段，load 阶段用 load.* 的设置
+TEST_F(ArrivalScheduleTest, LoadPhaseHasItsOwnTarget) {
+  // 1. Arrange
+  auto unpaced = Props({{"target", "8000"}, {"targetschedule", "0:1000"}});
+  auto paced = Props({{"target", "8000"},
+                      {"targetschedule", "0:1000"},
+                      {"load.target", "4000"}});
+
+  // 2. Act
+  ArrivalSchedule unpaced_load(ArrivalSchedule::LoadPhaseProperties(unpaced),
+                               2);
+  ArrivalSchedule paced_load(ArrivalSchedule::LoadPhaseProperties(paced), 2);
+  ArrivalSchedule transactions(paced, 2);
+
+  // 3. Assert
+  ASSERT_FALSE(unpaced_load.open_loop());
+  ASSERT_TRUE(paced_load.open_loop());
+  ASSERT_DOUBLE_EQ(paced_load.ThreadRateAt(0), 2000);
+  ASSERT_DOUBLE_EQ(transactions.ThreadRateAt(0), 500);
+}
+
+}  // namespace ycsbc
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
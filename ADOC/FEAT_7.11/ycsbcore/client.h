@@ -9,28 +9,52 @@
 #ifndef YCSB_C_CLIENT_H_
 #define YCSB_C_CLIENT_H_
 
+#include <atomic>
 #include <string>
+#include <thread>
 #include "db.h"
 #include "core_workload.h"
 #include "utils.h"
 #include "countdown_latch.h"
+#include "arrival_schedule.h"
+#include "measurements.h"
 
 namespace ycsbc {
 
 inline int ClientThread(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops, bool is_loading,
-                        bool init_db, bool cleanup_db, CountDownLatch *latch) {
+                        bool init_db, bool cleanup_db, CountDownLatch *latch,
+                        Measurements *measurements = nullptr,
+                        const ArrivalSchedule *schedule = nullptr,
+                        const std::atomic<bool> *stop = nullptr) {
   if (init_db) {
     db->Init();
   }
 
+  // open-loop: 按计划时间发送，不等上一个操作返回就算进延迟
+  const bool open_loop = schedule != nullptr && schedule->open_loop();
+  ArrivalProcess arrivals(schedule);
+
   int oks = 0;
   for (int i = 0; i < num_ops; ++i) {
+    if (stop != nullptr && stop->load(std::memory_order_relaxed)) {
+      break;
+    }
+    if (open_loop) {
+      ArrivalSchedule::Clock::time_point send_at = arrivals.Next();
+      std::this_thread::sleep_until(send_at);
+      if (measurements != nullptr) {
+        measurements->SetIntendedStart(send_at);
+      }
+    }
     if (is_loading) {
       oks += wl->DoInsert(*db);
     } else {
       oks += wl->DoTransaction(*db);
     }
   }
+  if (open_loop && measurements != nullptr) {
+    measurements->SetIntendedStart({});
+  }
 
   if (cleanup_db) {
     db->Cleanup();
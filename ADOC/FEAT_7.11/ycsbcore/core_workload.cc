@@ -24,7 +24,8 @@ using std::string;
 using ycsbc::CoreWorkload;
 
 const char *ycsbc::kOperationString[ycsbc::MAXOPTYPE] = {
-    "INSERT", "READ", "UPDATE", "SCAN", "READMODIFYWRITE", "DELETE"};
+    "INSERT", "READ", "UPDATE", "SCAN", "READMODIFYWRITE", "DELETE",
+    "BATCHREAD"};
 
 const string CoreWorkload::TABLENAME_PROPERTY = "table";
 const string CoreWorkload::TABLENAME_DEFAULT = "usertable";
@@ -84,6 +85,12 @@ const string CoreWorkload::INSERT_ORDER_DEFAULT = "hashed";
 const string CoreWorkload::INSERT_START_PROPERTY = "insertstart";
 const string CoreWorkload::INSERT_START_DEFAULT = "0";
 
+const string CoreWorkload::READ_BATCH_SIZE_PROPERTY = "readbatchsize";
+const string CoreWorkload::READ_BATCH_SIZE_DEFAULT = "1";
+
+const string CoreWorkload::VALUE_POOL_SIZE_PROPERTY = "valuepoolsize";
+const string CoreWorkload::VALUE_POOL_SIZE_DEFAULT = "0";
+
 const string CoreWorkload::RECORD_COUNT_PROPERTY = "recordcount";
 const string CoreWorkload::OPERATION_COUNT_PROPERTY = "operationcount";
 
@@ -98,6 +105,22 @@ void CoreWorkload::Init(const utils::Properties &p) {
   field_prefix_ = p.GetProperty(FIELD_NAME_PREFIX, FIELD_NAME_PREFIX_DEFAULT);
   field_len_generator_ = GetFieldLenGenerator(p);
 
+  size_t value_pool_size = std::stoull(
+      p.GetProperty(VALUE_POOL_SIZE_PROPERTY, VALUE_POOL_SIZE_DEFAULT));
+  if (value_pool_size > 0) {
+    size_t field_len =
+        std::stoull(p.GetProperty(FIELD_LENGTH_PROPERTY, FIELD_LENGTH_DEFAULT));
+    if (value_pool_size < field_len) {
+      throw utils::Exception(VALUE_POOL_SIZE_PROPERTY + " is smaller than " +
+                             FIELD_LENGTH_PROPERTY);
+    }
+    // 值从随机池里按随机偏移截取，池要比 SST block 大得多，否则会被压缩掉
+    value_pool_.reserve(value_pool_size);
+    RandomByteGenerator byte_generator;
+    std::generate_n(std::back_inserter(value_pool_), value_pool_size,
+                    [&]() { return byte_generator.Next(); });
+  }
+
   double read_proportion = std::stod(
       p.GetProperty(READ_PROPORTION_PROPERTY, READ_PROPORTION_DEFAULT));
   double update_proportion = std::stod(
@@ -123,6 +146,8 @@ void CoreWorkload::Init(const utils::Properties &p) {
 
   zero_padding_ =
       std::stoi(p.GetProperty(ZERO_PADDING_PROPERTY, ZERO_PADDING_DEFAULT));
+  read_batch_size_ =
+      std::stoi(p.GetProperty(READ_BATCH_SIZE_PROPERTY, READ_BATCH_SIZE_DEFAULT));
 
   read_all_fields_ = utils::StrToBool(
       p.GetProperty(READ_ALL_FIELDS_PROPERTY, READ_ALL_FIELDS_DEFAULT));
@@ -215,35 +240,55 @@ std::string CoreWorkload::BuildKeyName() {
 ycsbc::Operation CoreWorkload::NextOp() { return op_chooser_.Next(); }
 
 std::string CoreWorkload::BuildKeyName(uint64_t key_num) {
+  std::string key;
+  BuildKeyName(key_num, &key);
+  return key;
+}
+
+void CoreWorkload::BuildKeyName(uint64_t key_num, std::string *key) {
   if (!ordered_inserts_) {
     key_num = utils::Hash(key_num);
   }
-  std::string prekey = "user";
-  std::string value = std::to_string(key_num);
-  int fill = std::max(0, zero_padding_ - static_cast<int>(value.size()));
-  return prekey.append(fill, '0').append(value);
+  char digits[20];
+  char *end = digits + sizeof(digits);
+  char *begin = end;
+  do {
+    *--begin = static_cast<char>('0' + key_num % 10);
+    key_num /= 10;
+  } while (key_num > 0);
+  int fill = std::max(0, zero_padding_ - static_cast<int>(end - begin));
+  key->assign("user").append(fill, '0').append(begin, end);
+}
+
+void CoreWorkload::NextFieldName(std::string *name) {
+  name->assign(field_prefix_).append(std::to_string(field_chooser_->Next()));
+}
+
+void CoreWorkload::FillValue(uint64_t len, std::string *value) {
+  if (!value_pool_.empty()) {
+    size_t offset = utils::ThreadLocalRandomInt() % (value_pool_.size() - len + 1);
+    value->assign(value_pool_, offset, len);
+    return;
+  }
+  value->clear();
+  value->reserve(len);
+  RandomByteGenerator byte_generator;
+  std::generate_n(std::back_inserter(*value), len,
+                  [&]() { return byte_generator.Next(); });
 }
 
 void CoreWorkload::BuildValues(std::vector<ycsbc::DB::Field> &values) {
+  values.resize(field_count_);
   for (int i = 0; i < field_count_; ++i) {
-    values.push_back(DB::Field());
-    ycsbc::DB::Field &field = values.back();
-    field.name.append(field_prefix_).append(std::to_string(i));
-    uint64_t len = field_len_generator_->Next();
-    field.value.reserve(len);
-    RandomByteGenerator byte_generator;
-    std::generate_n(std::back_inserter(field.value), len,
-                    [&]() { return byte_generator.Next(); });
+    ycsbc::DB::Field &field = values[i];
+    field.name.assign(field_prefix_).append(std::to_string(i));
+    FillValue(field_len_generator_->Next(), &field.value);
   }
 }
 
 void CoreWorkload::BuildSingleValue(std::vector<ycsbc::DB::Field> &values) {
-  values.push_back(DB::Field());
-  ycsbc::DB::Field &field = values.back();
-  field.name.append(NextFieldName());
-  uint64_t len = field_len_generator_->Next();
-  field.value.reserve(len);
-  RandomByteGenerator byte_generator;
-  std::generate_n(std::back_inserter(field.value), len,
-                  [&]() { return byte_generator.Next(); });
+  values.resize(1);
+  ycsbc::DB::Field &field = values[0];
+  NextFieldName(&field.name);
+  FillValue(field_len_generator_->Next(), &field.value);
 }
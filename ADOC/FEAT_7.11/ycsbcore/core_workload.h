@@ -29,6 +29,7 @@ enum Operation {
   SCAN,
   READMODIFYWRITE,
   DELETE,
+  BATCHREAD,
   MAXOPTYPE
 };
 
@@ -148,6 +149,20 @@ class CoreWorkload {
   static const std::string INSERT_START_PROPERTY;
   static const std::string INSERT_START_DEFAULT;
 
+  ///
+  /// The name of the property for the number of records one read operation
+  /// reads, in one DB::BatchRead() call when it is more than 1.
+  ///
+  static const std::string READ_BATCH_SIZE_PROPERTY;
+  static const std::string READ_BATCH_SIZE_DEFAULT;
+
+  ///
+  /// The name of the property for the bytes of random data the field values
+  /// are cut from. 0 generates every value byte by byte.
+  ///
+  static const std::string VALUE_POOL_SIZE_PROPERTY;
+  static const std::string VALUE_POOL_SIZE_DEFAULT;
+
   static const std::string RECORD_COUNT_PROPERTY;
   static const std::string OPERATION_COUNT_PROPERTY;
 
@@ -180,7 +195,8 @@ class CoreWorkload {
         insert_key_sequence_(nullptr),
         transaction_insert_key_sequence_(nullptr),
         ordered_inserts_(true),
-        record_count_(0) {}
+        record_count_(0),
+        read_batch_size_(1) {}
 
   virtual ~CoreWorkload() {
     delete field_len_generator_;
@@ -194,14 +210,38 @@ class CoreWorkload {
   static Generator<uint64_t> *GetFieldLenGenerator(const utils::Properties &p);
   std::string BuildKeyName(uint64_t key_num);
   std::string BuildKeyName();
+  ///
+  /// Writes the key into a caller-owned buffer, which keeps its capacity.
+  ///
+  void BuildKeyName(uint64_t key_num, std::string *key);
   Operation NextOp();
+  ///
+  /// Resize `values` to the fields and fill them in place, so a vector
+  /// reused across operations stops allocating once it has grown.
+  ///
   void BuildValues(std::vector<DB::Field> &values);
   void BuildSingleValue(std::vector<DB::Field> &update);
+  void FillValue(uint64_t len, std::string *value);
 
   uint64_t NextTransactionKeyNum();
   std::string NextFieldName();
+  void NextFieldName(std::string *name);
+
+  ///
+  /// Buffers of one client thread, reused by all its operations.
+  ///
+  struct Scratch {
+    std::string key;
+    std::vector<std::string> keys;
+    std::vector<std::string> fields;
+    std::vector<DB::Field> values;
+    std::vector<DB::Field> result;
+    std::vector<std::vector<DB::Field>> results;
+  };
+  static Scratch &LocalScratch();
 
   int TransactionRead(DB &db);
+  int TransactionBatchRead(DB &db);
   int TransactionReadModifyWrite(DB &db);
   int TransactionScan(DB &db);
   int TransactionUpdate(DB &db);
@@ -223,6 +263,8 @@ class CoreWorkload {
   bool ordered_inserts_;
   size_t record_count_;
   int zero_padding_;
+  int read_batch_size_;
+  std::string value_pool_;
 };
 
 inline uint64_t CoreWorkload::NextTransactionKeyNum() {
@@ -234,15 +276,21 @@ inline uint64_t CoreWorkload::NextTransactionKeyNum() {
 }
 
 inline std::string CoreWorkload::NextFieldName() {
-  return std::string(field_prefix_)
-      .append(std::to_string(field_chooser_->Next()));
+  std::string name;
+  NextFieldName(&name);
+  return name;
+}
+
+inline CoreWorkload::Scratch &CoreWorkload::LocalScratch() {
+  static thread_local Scratch scratch;
+  return scratch;
 }
 
 inline bool CoreWorkload::DoInsert(DB &db) {
-  const std::string key = BuildKeyName(insert_key_sequence_->Next());
-  std::vector<DB::Field> fields;
-  BuildValues(fields);
-  return db.Insert(table_name_, key, fields) == DB::kOK;
+  Scratch &scratch = LocalScratch();
+  BuildKeyName(insert_key_sequence_->Next(), &scratch.key);
+  BuildValues(scratch.values);
+  return db.Insert(table_name_, scratch.key, scratch.values) == DB::kOK;
 }
 
 inline bool CoreWorkload::DoTransaction(DB &db) {
@@ -271,72 +319,89 @@ inline bool CoreWorkload::DoTransaction(DB &db) {
 }
 
 inline int CoreWorkload::TransactionRead(DB &db) {
-  uint64_t key_num = NextTransactionKeyNum();
-  const std::string key = BuildKeyName(key_num);
-  std::vector<DB::Field> result;
+  if (read_batch_size_ > 1) {
+    return TransactionBatchRead(db);
+  }
+  Scratch &scratch = LocalScratch();
+  BuildKeyName(NextTransactionKeyNum(), &scratch.key);
+  scratch.result.clear();
   if (!read_all_fields()) {
-    std::vector<std::string> fields;
-    fields.push_back(NextFieldName());
-    return db.Read(table_name_, key, &fields, result);
+    scratch.fields.resize(1);
+    NextFieldName(&scratch.fields[0]);
+    return db.Read(table_name_, scratch.key, &scratch.fields, scratch.result);
   } else {
-    return db.Read(table_name_, key, NULL, result);
+    return db.Read(table_name_, scratch.key, NULL, scratch.result);
+  }
+}
+
+inline int CoreWorkload::TransactionBatchRead(DB &db) {
+  Scratch &scratch = LocalScratch();
+  scratch.keys.resize(read_batch_size_);
+  for (int i = 0; i < read_batch_size_; ++i) {
+    BuildKeyName(NextTransactionKeyNum(), &scratch.keys[i]);
+  }
+  scratch.results.clear();
+  if (!read_all_fields()) {
+    scratch.fields.resize(1);
+    NextFieldName(&scratch.fields[0]);
+    return db.BatchRead(table_name_, scratch.keys, &scratch.fields, scratch.results);
+  } else {
+    return db.BatchRead(table_name_, scratch.keys, NULL, scratch.results);
   }
 }
 
 inline int CoreWorkload::TransactionReadModifyWrite(DB &db) {
-  uint64_t key_num = NextTransactionKeyNum();
-  const std::string key = BuildKeyName(key_num);
-  std::vector<DB::Field> result;
+  Scratch &scratch = LocalScratch();
+  BuildKeyName(NextTransactionKeyNum(), &scratch.key);
+  scratch.result.clear();
 
   if (!read_all_fields()) {
-    std::vector<std::string> fields;
-    fields.push_back(NextFieldName());
-    db.Read(table_name_, key, &fields, result);
+    scratch.fields.resize(1);
+    NextFieldName(&scratch.fields[0]);
+    db.Read(table_name_, scratch.key, &scratch.fields, scratch.result);
   } else {
-    db.Read(table_name_, key, NULL, result);
+    db.Read(table_name_, scratch.key, NULL, scratch.result);
   }
 
-  std::vector<DB::Field> values;
   if (write_all_fields()) {
-    BuildValues(values);
+    BuildValues(scratch.values);
   } else {
-    BuildSingleValue(values);
+    BuildSingleValue(scratch.values);
   }
-  return db.Update(table_name_, key, values);
+  return db.Update(table_name_, scratch.key, scratch.values);
 }
 
 inline int CoreWorkload::TransactionScan(DB &db) {
-  uint64_t key_num = NextTransactionKeyNum();
-  const std::string key = BuildKeyName(key_num);
+  Scratch &scratch = LocalScratch();
+  BuildKeyName(NextTransactionKeyNum(), &scratch.key);
   int len = scan_len_chooser_->Next();
-  std::vector<std::vector<DB::Field>> result;
+  scratch.results.clear();
   if (!read_all_fields()) {
-    std::vector<std::string> fields;
-    fields.push_back(NextFieldName());
-    return db.Scan(table_name_, key, len, &fields, result);
+    scratch.fields.resize(1);
+    NextFieldName(&scratch.fields[0]);
+    return db.Scan(table_name_, scratch.key, len, &scratch.fields, scratch.results);
   } else {
-    return db.Scan(table_name_, key, len, NULL, result);
+    return db.Scan(table_name_, scratch.key, len, NULL, scratch.results);
   }
 }
 
 inline int CoreWorkload::TransactionUpdate(DB &db) {
-  uint64_t key_num = NextTransactionKeyNum();
-  const std::string key = BuildKeyName(key_num);
-  std::vector<DB::Field> values;
+  Scratch &scratch = LocalScratch();
+  BuildKeyName(NextTransactionKeyNum(), &scratch.key);
   if (write_all_fields()) {
-    BuildValues(values);
+    BuildValues(scratch.values);
   } else {
-    BuildSingleValue(values);
+    BuildSingleValue(scratch.values);
   }
-  return db.Update(table_name_, key, values);
+  return db.Update(table_name_, scratch.key, scratch.values);
 }
 
 inline int CoreWorkload::TransactionInsert(DB &db) {
+  Scratch &scratch = LocalScratch();
   uint64_t key_num = transaction_insert_key_sequence_->Next();
-  const std::string key = BuildKeyName(key_num);
-  std::vector<DB::Field> values;
-  BuildValues(values);
-  int s = db.Insert(table_name_, key, values);
+  BuildKeyName(key_num, &scratch.key);
+  BuildValues(scratch.values);
+  int s = db.Insert(table_name_, scratch.key, scratch.values);
   transaction_insert_key_sequence_->Acknowledge(key_num);
   return s;
 }
@@ -54,6 +54,31 @@ class DB {
                    const std::vector<std::string> *fields,
                    std::vector<Field> &result) = 0;
   ///
+  /// Reads a batch of records from the database.
+  /// The default implementation reads them one by one.
+  ///
+  /// @param table The name of the table.
+  /// @param keys The keys of the records to read.
+  /// @param fields The list of fields to read, or NULL for all of them.
+  /// @param result A vector of vector, where each vector contains field/value
+  ///        pairs for the record of the key at the same position
+  /// @return Zero if every record was read, or the first non-zero code.
+  ///
+  virtual Status BatchRead(const std::string &table,
+                           const std::vector<std::string> &keys,
+                           const std::vector<std::string> *fields,
+                           std::vector<std::vector<Field>> &result) {
+    Status s = kOK;
+    result.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      Status key_status = Read(table, keys[i], fields, result[i]);
+      if (s == kOK) {
+        s = key_status;
+      }
+    }
+    return s;
+  }
+  ///
   /// Performs a range scan for a set of records in the database.
   /// Field/value pairs from the result are stored in a vector.
   ///
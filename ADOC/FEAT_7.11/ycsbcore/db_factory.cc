@@ -9,12 +9,16 @@
 #include "db_factory.h"
 #include "basic_db.h"
 #include "db_wrapper.h"
+#include "rocksdb_db.h"
 
 namespace ycsbc {
 
 
 std::map<std::string, DBFactory::DBCreator> &DBFactory::Registry() {
-  static std::map<std::string, DBCreator> registry;
+  // 内置的 DB 直接放进表里：链接静态库时没被引用的 .o 会被丢掉，
+  // 里面的静态注册也就不会执行
+  static std::map<std::string, DBCreator> registry{
+      {"basic", NewBasicDB}, {"rocksdb", NewRocksdbDB}};
   return registry;
 }
 
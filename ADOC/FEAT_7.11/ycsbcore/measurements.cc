@@ -7,57 +7,297 @@
 
 #include "measurements.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <limits>
 #include <numeric>
 #include <sstream>
+#include <thread>
 
 namespace ycsbc {
 
-Measurements::Measurements() : count_{}, latency_sum_{}, latency_max_{} {
-  std::fill(std::begin(latency_min_), std::end(latency_min_), std::numeric_limits<uint64_t>::max());
+int LatencyHistogram::BucketOf(uint64_t latency) {
+  if (latency < 2 * kSubBuckets) {
+    return static_cast<int>(latency);
+  }
+  int shift = 63 - __builtin_clzll(latency) - kSubBucketBits;
+  return shift * kSubBuckets + static_cast<int>(latency >> shift);
+}
+
+uint64_t LatencyHistogram::BucketLow(int bucket) {
+  if (bucket < 2 * kSubBuckets) {
+    return bucket;
+  }
+  int shift = bucket / kSubBuckets - 1;
+  return static_cast<uint64_t>(bucket - shift * kSubBuckets) << shift;
+}
+
+uint64_t LatencyHistogram::BucketHigh(int bucket) {
+  if (bucket < 2 * kSubBuckets) {
+    return bucket;
+  }
+  int shift = bucket / kSubBuckets - 1;
+  return BucketLow(bucket) + ((uint64_t{1} << shift) - 1);
+}
+
+LatencyHistogram::LatencyHistogram() : buckets_(kNumBuckets) {
+  Clear();
+}
+
+void LatencyHistogram::Add(int bucket, uint64_t count) {
+  if (count == 0) {
+    return;
+  }
+  buckets_[bucket] += count;
+  count_ += count;
+}
+
+void LatencyHistogram::AddSum(uint64_t sum, uint64_t min, uint64_t max) {
+  sum_ += sum;
+  min_ = std::min(min_, min);
+  max_ = std::max(max_, max);
+}
+
+void LatencyHistogram::Subtract(const LatencyHistogram &older) {
+  count_ -= older.count_;
+  sum_ -= older.sum_;
+  min_ = std::numeric_limits<uint64_t>::max();
+  max_ = 0;
+  for (int i = 0; i < kNumBuckets; i++) {
+    buckets_[i] -= older.buckets_[i];
+    if (buckets_[i] > 0) {
+      min_ = std::min(min_, BucketLow(i));
+      max_ = BucketHigh(i);
+    }
+  }
+}
+
+void LatencyHistogram::Clear() {
+  count_ = 0;
+  sum_ = 0;
+  min_ = std::numeric_limits<uint64_t>::max();
+  max_ = 0;
+  std::fill(buckets_.begin(), buckets_.end(), 0);
+}
+
+double LatencyHistogram::Average() const {
+  return count_ > 0 ? static_cast<double>(sum_) / count_ : 0;
+}
+
+uint64_t LatencyHistogram::Percentile(double p) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100 * count_));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; i++) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // 取桶的中点，再截到真实的 min / max 之内
+      uint64_t mid = BucketLow(i) + (BucketHigh(i) - BucketLow(i)) / 2;
+      return std::max(std::min(mid, max_), Min());
+    }
+  }
+  return max_;
+}
+
+// One writer per shard: plain load + store instead of read-modify-write, the
+// merging thread only needs every counter to be read atomically
+struct Measurements::Shard {
+  struct Histograms {
+    std::atomic<uint64_t> sum[MAXOPTYPE];
+    std::atomic<uint64_t> min[MAXOPTYPE];
+    std::atomic<uint64_t> max[MAXOPTYPE];
+    std::atomic<uint64_t> buckets[MAXOPTYPE][LatencyHistogram::kNumBuckets];
+
+    void Clear() {
+      for (int op = 0; op < MAXOPTYPE; op++) {
+        sum[op].store(0, std::memory_order_relaxed);
+        min[op].store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        max[op].store(0, std::memory_order_relaxed);
+        for (auto &bucket : buckets[op]) {
+          bucket.store(0, std::memory_order_relaxed);
+        }
+      }
+    }
+
+    void Add(Operation op, uint64_t latency) {
+      Increase(buckets[op][LatencyHistogram::BucketOf(latency)], 1);
+      Increase(sum[op], latency);
+      if (latency < min[op].load(std::memory_order_relaxed)) {
+        min[op].store(latency, std::memory_order_relaxed);
+      }
+      if (latency > max[op].load(std::memory_order_relaxed)) {
+        max[op].store(latency, std::memory_order_relaxed);
+      }
+    }
+
+    void CollectInto(LatencyHistogram *merged) const {
+      for (int op = 0; op < MAXOPTYPE; op++) {
+        for (int i = 0; i < LatencyHistogram::kNumBuckets; i++) {
+          merged[op].Add(i, buckets[op][i].load(std::memory_order_relaxed));
+        }
+        merged[op].AddSum(sum[op].load(std::memory_order_relaxed),
+                          min[op].load(std::memory_order_relaxed),
+                          max[op].load(std::memory_order_relaxed));
+      }
+    }
+  };
+
+  std::thread::id owner;
+  // only touched by the owner
+  std::chrono::steady_clock::time_point intended_start;
+  Histograms series[kNumSeries];
+
+  Shard() : owner(std::this_thread::get_id()) { Clear(); }
+
+  void Clear() {
+    for (auto &histograms : series) {
+      histograms.Clear();
+    }
+  }
+
+  static void Increase(std::atomic<uint64_t> &counter, uint64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta,
+                  std::memory_order_relaxed);
+  }
+};
+
+namespace {
+std::atomic<uint64_t> next_measurements_id{1};
+const char *kSeriesPrefix[Measurements::kNumSeries] = {"", "Intended-"};
+} // anonymous
+
+Measurements::Measurements() : id_(next_measurements_id.fetch_add(1)) {}
+
+Measurements::~Measurements() = default;
+
+Measurements::Shard *Measurements::LocalShard() {
+  // 用 id 而不是地址认实例：析构后同一地址上的新实例不会拿到旧的 shard
+  thread_local uint64_t cached_id = 0;
+  thread_local Shard *cached_shard = nullptr;
+  if (cached_id == id_) {
+    return cached_shard;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::thread::id self = std::this_thread::get_id();
+  auto it = std::find_if(shards_.begin(), shards_.end(),
+                         [&](const std::unique_ptr<Shard> &shard) {
+                           return shard->owner == self;
+                         });
+  if (it == shards_.end()) {
+    shards_.emplace_back(new Shard());
+    it = std::prev(shards_.end());
+  }
+  cached_id = id_;
+  cached_shard = it->get();
+  return cached_shard;
 }
 
 void Measurements::Report(Operation op, uint64_t latency) {
-  count_[op].fetch_add(1, std::memory_order_relaxed);
-  latency_sum_[op].fetch_add(latency, std::memory_order_relaxed);
-  uint64_t prev_min = latency_min_[op].load(std::memory_order_relaxed);
-  while (prev_min > latency
-         && !latency_min_[op].compare_exchange_weak(prev_min, latency, std::memory_order_relaxed));
-  uint64_t prev_max = latency_max_[op].load(std::memory_order_relaxed);
-  while (prev_max < latency
-         && !latency_max_[op].compare_exchange_weak(prev_max, latency, std::memory_order_relaxed));
+  Shard *shard = LocalShard();
+  shard->series[kServiceTime].Add(op, latency);
+  if (shard->intended_start != std::chrono::steady_clock::time_point()) {
+    auto intended = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - shard->intended_start);
+    // 排队的时间不会比服务时间短
+    shard->series[kIntendedTime].Add(
+        op, std::max<uint64_t>(intended.count(), latency));
+  }
 }
 
-std::string Measurements::GetStatusMsg() {
+void Measurements::SetIntendedStart(std::chrono::steady_clock::time_point start) {
+  LocalShard()->intended_start = start;
+}
+
+void Measurements::CollectLocked(LatencyHistogram (*merged)[MAXOPTYPE]) {
+  for (const auto &shard : shards_) {
+    for (int series = 0; series < kNumSeries; series++) {
+      shard->series[series].CollectInto(merged[series]);
+    }
+  }
+}
+
+uint64_t Measurements::GetCount(Operation op) {
+  LatencyHistogram merged[kNumSeries][MAXOPTYPE];
+  std::lock_guard<std::mutex> lock(mutex_);
+  CollectLocked(merged);
+  return merged[kServiceTime][op].Count();
+}
+
+double Measurements::GetLatency(Operation op) {
+  LatencyHistogram merged[kNumSeries][MAXOPTYPE];
+  std::lock_guard<std::mutex> lock(mutex_);
+  CollectLocked(merged);
+  return merged[kServiceTime][op].Average();
+}
+
+std::string Measurements::Format(const LatencyHistogram (*histograms)[MAXOPTYPE]) {
   std::ostringstream msg_stream;
   msg_stream.precision(2);
-  uint64_t total_cnt = 0;
-  msg_stream << std::fixed << " operations;";
+  msg_stream << std::fixed;
   for (int i = 0; i < MAXOPTYPE; i++) {
-    Operation op = static_cast<Operation>(i);
-    uint64_t cnt = GetCount(op);
-    if (cnt == 0)
-      continue;
-    msg_stream << " [" << kOperationString[op] << ":"
-               << " Count=" << cnt
-               << " Max=" << latency_max_[op].load(std::memory_order_relaxed) / 1000.0
-               << " Min=" << latency_min_[op].load(std::memory_order_relaxed) / 1000.0
-               << " Avg="
-               << ((cnt > 0)
-                   ? static_cast<double>(latency_sum_[op].load(std::memory_order_relaxed)) / cnt
-                   : 0) / 1000.0
-               << "]";
-    total_cnt += cnt;
-  }
-  return std::to_string(total_cnt) + msg_stream.str();
+    for (int series = 0; series < kNumSeries; series++) {
+      const LatencyHistogram &h = histograms[series][i];
+      if (h.Count() == 0)
+        continue;
+      msg_stream << " [" << kSeriesPrefix[series] << kOperationString[i] << ":"
+                 << " Count=" << h.Count()
+                 << " Max=" << h.Max() / 1000.0
+                 << " Min=" << h.Min() / 1000.0
+                 << " Avg=" << h.Average() / 1000.0
+                 << " P50=" << h.Percentile(50) / 1000.0
+                 << " P99=" << h.Percentile(99) / 1000.0
+                 << " P99.9=" << h.Percentile(99.9) / 1000.0
+                 << " P99.99=" << h.Percentile(99.99) / 1000.0
+                 << "]";
+    }
+  }
+  return msg_stream.str();
+}
+
+std::string Measurements::GetStatusMsg() {
+  LatencyHistogram merged[kNumSeries][MAXOPTYPE];
+  LatencyHistogram interval[kNumSeries][MAXOPTYPE];
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CollectLocked(merged);
+    for (int series = 0; series < kNumSeries; series++) {
+      for (int i = 0; i < MAXOPTYPE; i++) {
+        interval[series][i] = merged[series][i];
+        interval[series][i].Subtract(last_status_[series][i]);
+        last_status_[series][i] = merged[series][i];
+      }
+    }
+  }
+  uint64_t total_cnt = 0;
+  for (const auto &h : merged[kServiceTime]) {
+    total_cnt += h.Count();
+  }
+  return std::to_string(total_cnt) + " operations;" + Format(interval);
+}
+
+std::string Measurements::GetSummaryMsg() {
+  LatencyHistogram merged[kNumSeries][MAXOPTYPE];
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CollectLocked(merged);
+  }
+  return Format(merged);
 }
 
 void Measurements::Reset() {
-  std::fill(std::begin(count_), std::end(count_), 0);
-  std::fill(std::begin(latency_sum_), std::end(latency_sum_), 0);
-  std::fill(std::begin(latency_min_), std::end(latency_min_), std::numeric_limits<uint64_t>::max());
-  std::fill(std::begin(latency_max_), std::end(latency_max_), 0);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &shard : shards_) {
+    shard->Clear();
+  }
+  for (auto &series : last_status_) {
+    for (auto &h : series) {
+      h.Clear();
+    }
+  }
 }
 
 } // ycsbc
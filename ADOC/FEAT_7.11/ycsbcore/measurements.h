@@ -11,29 +11,95 @@
 #include "core_workload.h"
 
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace ycsbc {
 
+///
+/// HDR style latency histogram: exact below 64ns, then 32 linear buckets per
+/// power of two, so a percentile is off by at most 1/32 of its value.
+///
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  static int BucketOf(uint64_t latency);
+  static uint64_t BucketLow(int bucket);
+  static uint64_t BucketHigh(int bucket);
+
+  LatencyHistogram();
+  void Add(int bucket, uint64_t count);
+  void AddSum(uint64_t sum, uint64_t min, uint64_t max);
+  ///
+  /// Removes the samples of an older snapshot of the same histogram. The
+  /// min and max are then only known up to their buckets.
+  ///
+  void Subtract(const LatencyHistogram &older);
+  void Clear();
+
+  uint64_t Count() const { return count_; }
+  uint64_t Min() const { return count_ == 0 ? 0 : min_; }
+  uint64_t Max() const { return max_; }
+  double Average() const;
+  uint64_t Percentile(double p) const;
+
+ private:
+  uint64_t count_;
+  uint64_t sum_;
+  uint64_t min_;
+  uint64_t max_;
+  std::vector<uint64_t> buckets_;
+};
+
+///
+/// Every client thread reports into its own shard, the shards are merged
+/// when a status or summary is printed.
+///
+/// In open-loop runs the client thread also sets the time each operation
+/// was scheduled at, the latency from it, queueing included, is reported
+/// as Intended-<operation> next to the service time.
+///
 class Measurements {
  public:
+  enum Series { kServiceTime, kIntendedTime, kNumSeries };
+
   Measurements();
+  ~Measurements();
   void Report(Operation op, uint64_t latency);
-  uint64_t GetCount(Operation op) {
-    return count_[op].load(std::memory_order_relaxed);
-  }
-  double GetLatency(Operation op) {
-    uint64_t cnt = GetCount(op);
-    return cnt > 0
-        ? static_cast<double>(latency_sum_[op].load(std::memory_order_relaxed)) / cnt
-        : 0.0;
-  }
+  ///
+  /// Sets the scheduled time of the operations the calling thread reports
+  /// from now on, a default time_point goes back to closed-loop.
+  ///
+  void SetIntendedStart(std::chrono::steady_clock::time_point start);
+  uint64_t GetCount(Operation op);
+  double GetLatency(Operation op);
+  ///
+  /// Latencies of the operations since the previous call, with the count of
+  /// all operations since Reset() in front.
+  ///
   std::string GetStatusMsg();
+  ///
+  /// Latencies of all the operations since Reset().
+  ///
+  std::string GetSummaryMsg();
   void Reset();
  private:
-  std::atomic<uint> count_[MAXOPTYPE];
-  std::atomic<uint64_t> latency_sum_[MAXOPTYPE];
-  std::atomic<uint64_t> latency_min_[MAXOPTYPE];
-  std::atomic<uint64_t> latency_max_[MAXOPTYPE];
+  struct Shard;
+
+  Shard *LocalShard();
+  void CollectLocked(LatencyHistogram (*merged)[MAXOPTYPE]);
+  static std::string Format(const LatencyHistogram (*histograms)[MAXOPTYPE]);
+
+  const uint64_t id_;
+  std::mutex mutex_;  // guards shards_ and last_status_
+  std::vector<std::unique_ptr<Shard>> shards_;
+  LatencyHistogram last_status_[kNumSeries][MAXOPTYPE];
 };
 
 } // ycsbc
@@ -0,0 +1,169 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "ycsbcore/measurements.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+
+namespace ycsbc {
+
+class LatencyHistogramTest : public testing::Test {
+ public:
+  static void AddLatency(LatencyHistogram* h, uint64_t latency) {
+    h->Add(LatencyHistogram::BucketOf(latency), 1);
+    h->AddSum(latency, latency, latency);
+  }
+};
+
+// 测试：64 以下每个值一个桶，之后每个 2 的幂次的边界正好落在桶边上
+TEST_F(LatencyHistogramTest, BucketEdges) {
+  // 1. Arrange
+  const uint64_t max_latency = std::numeric_limits<uint64_t>::max();
+
+  // 2. Act
+  int bucket_63 = LatencyHistogram::BucketOf(63);
+  int bucket_64 = LatencyHistogram::BucketOf(64);
+  int bucket_max = LatencyHistogram::BucketOf(max_latency);
+
+  // 3. Assert
+  ASSERT_EQ(bucket_63, 63);
+  ASSERT_EQ(LatencyHistogram::BucketLow(bucket_63), 63u);
+  ASSERT_EQ(LatencyHistogram::BucketHigh(bucket_63), 63u);
+  ASSERT_EQ(bucket_64, 64);
+  ASSERT_EQ(LatencyHistogram::BucketLow(bucket_64), 64u);
+  ASSERT_EQ(LatencyHistogram::BucketHigh(bucket_64), 65u);
+  for (int k = 6; k < 64; k++) {
+    const uint64_t edge = uint64_t{1} << k;
+    int below = LatencyHistogram::BucketOf(edge - 1);
+    int at = LatencyHistogram::BucketOf(edge);
+    ASSERT_EQ(at, below + 1) << "2^" << k;
+    ASSERT_EQ(LatencyHistogram::BucketHigh(below), edge - 1) << "2^" << k;
+    ASSERT_EQ(LatencyHistogram::BucketLow(at), edge) << "2^" << k;
+  }
+  ASSERT_EQ(bucket_max, LatencyHistogram::kNumBuckets - 1);
+  ASSERT_EQ(LatencyHistogram::BucketHigh(bucket_max), max_latency);
+}
+
+// 测试：每个值都落在自己桶的上下界之内，桶宽不超过下界的 1/32
+TEST_F(LatencyHistogramTest, BucketsCoverEveryLatency) {
+  // 1. Arrange
+  std::mt19937_64 rng(301);
+  std::vector<uint64_t> latencies;
+  for (int i = 0; i < 10000; i++) {
+    latencies.push_back(rng() >> (rng() % 64));
+  }
+
+  // 2. Act & 3. Assert
+  for (uint64_t latency : latencies) {
+    int bucket = LatencyHistogram::BucketOf(latency);
+    ASSERT_GE(bucket, 0);
+    ASSERT_LT(bucket, LatencyHistogram::kNumBuckets);
+    uint64_t low = LatencyHistogram::BucketLow(bucket);
+    uint64_t high = LatencyHistogram::BucketHigh(bucket);
+    ASSERT_LE(low, latency);
+    ASSERT_GE(high, latency);
+    ASSERT_LE(high - low, low / LatencyHistogram::kSubBuckets);
+  }
+}
+
+// 测试：百分位数和精确值的误差不超过 1/32，并且不超出 min / max
+TEST_F(LatencyHistogramTest, PercentileWithinOneThirtySecond) {
+  // 1. Arrange
+  LatencyHistogram h;
+  const uint64_t n = 100000;
+  for (uint64_t latency = 1; latency <= n; latency++) {
+    AddLatency(&h, latency * 37);
+  }
+
+  // 2. Act & 3. Assert
+  for (double p : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0}) {
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100 * n));
+    double exact = static_cast<double>(rank * 37);
+    double estimate = static_cast<double>(h.Percentile(p));
+    ASSERT_LE(std::abs(estimate - exact), exact / 32) << "P" << p;
+  }
+  ASSERT_EQ(h.Count(), n);
+  ASSERT_EQ(h.Min(), 37u);
+  ASSERT_EQ(h.Max(), n * 37);
+  ASSERT_LE(h.Percentile(100), h.Max());
+  ASSERT_DOUBLE_EQ(h.Average(), 37.0 * (n + 1) / 2);
+}
+
+// 测试：减掉上一次的快照后只剩这段时间的样本，min / max 精确到桶
+TEST_F(LatencyHistogramTest, SubtractLeavesTheInterval) {
+  // 1. Arrange
+  LatencyHistogram previous;
+  LatencyHistogram current;
+  LatencyHistogram expected;
+  for (uint64_t latency = 1000; latency < 2000; latency++) {
+    AddLatency(&previous, latency);
+    AddLatency(&current, latency);
+  }
+  for (uint64_t latency = 5000; latency < 9000; latency++) {
+    AddLatency(&current, latency);
+    AddLatency(&expected, latency);
+  }
+
+  // 2. Act
+  LatencyHistogram interval = current;
+  interval.Subtract(previous);
+
+  // 3. Assert
+  ASSERT_EQ(interval.Count(), 4000u);
+  ASSERT_DOUBLE_EQ(interval.Average(), expected.Average());
+  ASSERT_EQ(interval.Min(), LatencyHistogram::BucketLow(
+                                LatencyHistogram::BucketOf(5000)));
+  ASSERT_EQ(interval.Max(), LatencyHistogram::BucketHigh(
+                                LatencyHistogram::BucketOf(8999)));
+  // 只知道 min / max 所在的桶，百分位数落在同一个桶里
+  for (double p : {50.0, 99.0, 99.9}) {
+    ASSERT_EQ(LatencyHistogram::BucketOf(interval.Percentile(p)),
+              LatencyHistogram::BucketOf(expected.Percentile(p)))
+        << "P" << p;
+  }
+}
+
+// 测试：GetStatusMsg 只报上一次以来的操作，总数和 GetSummaryMsg 都是累计的
+TEST_F(LatencyHistogramTest, StatusReportsTheIntervalOnly) {
+  // 1. Arrange
+  Measurements measurements;
+  // 64ns 以下每个值一个桶，min / max 减完快照后也是精确的
+  for (int i = 0; i < 10; i++) {
+    measurements.Report(READ, 10);
+  }
+  measurements.GetStatusMsg();
+  for (int i = 0; i < 5; i++) {
+    measurements.Report(READ, 40);
+  }
+  measurements.Report(UPDATE, 20);
+
+  // 2. Act
+  std::string status = measurements.GetStatusMsg();
+  std::string empty_status = measurements.GetStatusMsg();
+  std::string summary = measurements.GetSummaryMsg();
+
+  // 3. Assert
+  ASSERT_EQ(status.find("16 operations;"), 0u);
+  ASSERT_NE(status.find("[READ: Count=5 Max=0.04 Min=0.04"), std::string::npos);
+  ASSERT_NE(status.find("[UPDATE: Count=1 "), std::string::npos);
+  ASSERT_EQ(empty_status, "16 operations;");
+  ASSERT_NE(summary.find("[READ: Count=15 Max=0.04 Min=0.01"),
+            std::string::npos);
+  ASSERT_EQ(measurements.GetCount(READ), 15u);
+  ASSERT_DOUBLE_EQ(measurements.GetLatency(READ), 20.0);
+}
+
+}  // namespace ycsbc
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
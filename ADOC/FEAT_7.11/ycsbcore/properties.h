@@ -27,6 +27,11 @@ class Properties {
   const std::string &operator[](const std::string &key) const;
   void SetProperty(const std::string &key, const std::string &value);
   bool ContainsKey(const std::string &key) const;
+  ///
+  /// Sets every property under `prefix` again without the prefix, so
+  /// "phase.read.threadcount" overrides "threadcount".
+  ///
+  void OverrideWithPrefix(const std::string &prefix);
   void Load(std::ifstream &input);
  private:
   std::map<std::string, std::string> properties_;
@@ -54,6 +59,19 @@ inline bool Properties::ContainsKey(const std::string &key) const {
   return properties_.find(key) != properties_.end();
 }
 
+inline void Properties::OverrideWithPrefix(const std::string &prefix) {
+  std::map<std::string, std::string> overrides;
+  for (const auto &property : properties_) {
+    if (property.first.size() > prefix.size() &&
+        property.first.compare(0, prefix.size(), prefix) == 0) {
+      overrides[property.first.substr(prefix.size())] = property.second;
+    }
+  }
+  for (const auto &property : overrides) {
+    properties_[property.first] = property.second;
+  }
+}
+
 inline void Properties::Load(std::ifstream &input) {
   if (!input.is_open()) {
     throw utils::Exception("File not open!");
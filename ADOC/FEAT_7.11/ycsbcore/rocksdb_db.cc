@@ -0,0 +1,378 @@
+//
+//  rocksdb_db.cc
+//  YCSB-cpp
+//
+//  Binding of the ADOC RocksDB engine, selected with `-db rocksdb`.
+//
+
+#include "rocksdb_db.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "rocksdb/convenience.h"
+#include "rocksdb/utilities/options_util.h"
+#include "rocksdb/utilities/report_agent.h"
+#include "rocksdb/wide_columns.h"
+#include "util/coding.h"
+
+namespace {
+
+const std::string PROP_NAME = "rocksdb.dbname";
+const std::string PROP_NAME_DEFAULT = "";
+
+const std::string PROP_OPTIONS_FILE = "rocksdb.optionsfile";
+const std::string PROP_OPTIONS_FILE_DEFAULT = "";
+
+const std::string PROP_DESTROY = "rocksdb.destroy";
+const std::string PROP_DESTROY_DEFAULT = "false";
+
+const std::string PROP_FORMAT = "rocksdb.format";
+const std::string PROP_FORMAT_DEFAULT = "packed";
+
+const std::string PROP_TUNER = "rocksdb.tuner";
+const std::string PROP_TUNER_DEFAULT = "off";
+
+const std::string PROP_TUNER_TEA = "rocksdb.tuner.tea";
+const std::string PROP_TUNER_TEA_DEFAULT = "true";
+
+const std::string PROP_TUNER_FEA = "rocksdb.tuner.fea";
+const std::string PROP_TUNER_FEA_DEFAULT = "true";
+
+const std::string PROP_REPORT_FILE = "rocksdb.report_file";
+const std::string PROP_REPORT_FILE_DEFAULT = "ycsb_report.csv";
+
+const std::string PROP_REPORT_INTERVAL = "rocksdb.report_interval";
+const std::string PROP_REPORT_INTERVAL_DEFAULT = "1";
+
+const std::string PROP_TUNING_GAP = "rocksdb.tuning_gap";
+const std::string PROP_TUNING_GAP_DEFAULT = "1";
+
+const std::string PROP_TUNER_TRACE = "rocksdb.tuner_trace";
+const std::string PROP_TUNER_TRACE_DEFAULT = "";
+
+bool Selected(const std::vector<std::string> *fields, const rocksdb::Slice &name) {
+  return fields == nullptr ||
+         std::find(fields->begin(), fields->end(), name) != fields->end();
+}
+
+} // anonymous
+
+namespace ycsbc {
+
+std::mutex RocksdbDB::mutex_;
+int RocksdbDB::ref_cnt_ = 0;
+rocksdb::DB *RocksdbDB::db_ = nullptr;
+RocksdbDB::RowFormat RocksdbDB::format_ = RocksdbDB::kPacked;
+std::shared_ptr<rocksdb::TunerEventListener> RocksdbDB::tuner_listener_;
+std::unique_ptr<rocksdb::ReporterAgent> RocksdbDB::reporter_;
+
+RocksdbDB::~RocksdbDB() {
+  // 没有调 Cleanup() 时 iterator 也不能比 DB 活得久
+  iter_.reset();
+}
+
+void RocksdbDB::Init() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (ref_cnt_ > 0) {
+    ref_cnt_++;
+    return;
+  }
+  try {
+    OpenDB(*props_);
+  } catch (...) {
+    // Open 成功之后调优器的设置还可能失败，把已经打开的 DB 关掉，
+    // 下一次 Init 才会重新打开而不是拿到一个半初始化的 db_
+    reporter_.reset();
+    delete db_;
+    db_ = nullptr;
+    tuner_listener_.reset();
+    throw;
+  }
+  ref_cnt_++;
+}
+
+void RocksdbDB::Cleanup() {
+  iter_.reset();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (--ref_cnt_ > 0) {
+    return;
+  }
+  // 先停掉调优线程，它会在退出前把调过的 options 写回 OPTIONS 文件
+  reporter_.reset();
+  delete db_;
+  db_ = nullptr;
+  tuner_listener_.reset();
+}
+
+void RocksdbDB::OpenDB(const utils::Properties &props) {
+  const std::string db_path = props.GetProperty(PROP_NAME, PROP_NAME_DEFAULT);
+  if (db_path.empty()) {
+    throw utils::Exception(PROP_NAME + " is missing");
+  }
+  const std::string format = props.GetProperty(PROP_FORMAT, PROP_FORMAT_DEFAULT);
+  if (format == "packed") {
+    format_ = kPacked;
+  } else if (format == "wide") {
+    format_ = kWideColumns;
+  } else {
+    throw utils::Exception("Unknown " + PROP_FORMAT + ": " + format);
+  }
+
+  rocksdb::Options options;
+  const std::string options_file =
+      props.GetProperty(PROP_OPTIONS_FILE, PROP_OPTIONS_FILE_DEFAULT);
+  if (!options_file.empty()) {
+    rocksdb::ConfigOptions config_options;
+    rocksdb::DBOptions db_options;
+    std::vector<rocksdb::ColumnFamilyDescriptor> cf_descs;
+    rocksdb::Status s = rocksdb::LoadOptionsFromFile(
+        config_options, options_file, &db_options, &cf_descs);
+    if (!s.ok()) {
+      throw utils::Exception("RocksDB LoadOptionsFromFile: " + s.ToString());
+    }
+    options = rocksdb::Options(db_options, rocksdb::ColumnFamilyOptions());
+    for (const auto &cf : cf_descs) {
+      if (cf.name == rocksdb::kDefaultColumnFamilyName) {
+        options = rocksdb::Options(db_options, cf.options);
+      }
+    }
+  }
+  options.create_if_missing = true;
+  if (utils::StrToBool(props.GetProperty(PROP_DESTROY, PROP_DESTROY_DEFAULT))) {
+    rocksdb::Status s = rocksdb::DestroyDB(db_path, options);
+    if (!s.ok()) {
+      throw utils::Exception("RocksDB DestroyDB: " + s.ToString());
+    }
+  }
+
+  const std::string tuner = props.GetProperty(PROP_TUNER, PROP_TUNER_DEFAULT);
+  if (tuner != "off" && tuner != "dota" && tuner != "feat") {
+    throw utils::Exception("Unknown " + PROP_TUNER + ": " + tuner);
+  }
+  if (tuner != "off") {
+    // 调优器的指标来自这个 listener，必须在 Open 之前挂上
+    tuner_listener_ = std::make_shared<rocksdb::TunerEventListener>(options.env);
+    options.listeners.push_back(tuner_listener_);
+  }
+
+  rocksdb::Status s = rocksdb::DB::Open(options, db_path, &db_);
+  if (!s.ok()) {
+    throw utils::Exception("RocksDB Open: " + s.ToString());
+  }
+  if (tuner == "off") {
+    return;
+  }
+
+  auto *agent = new rocksdb::ReporterAgentWithTuning(
+      static_cast<rocksdb::DBImpl *>(db_->GetRootDB()), options.env,
+      props.GetProperty(PROP_REPORT_FILE, PROP_REPORT_FILE_DEFAULT),
+      std::stoull(props.GetProperty(PROP_REPORT_INTERVAL, PROP_REPORT_INTERVAL_DEFAULT)),
+      std::stoull(props.GetProperty(PROP_TUNING_GAP, PROP_TUNING_GAP_DEFAULT)),
+      tuner_listener_);
+  reporter_.reset(agent);
+  if (tuner == "feat") {
+    agent->UseFEATTuner(
+        utils::StrToBool(props.GetProperty(PROP_TUNER_TEA, PROP_TUNER_TEA_DEFAULT)),
+        utils::StrToBool(props.GetProperty(PROP_TUNER_FEA, PROP_TUNER_FEA_DEFAULT)));
+  }
+  const std::string trace_file =
+      props.GetProperty(PROP_TUNER_TRACE, PROP_TUNER_TRACE_DEFAULT);
+  if (!trace_file.empty()) {
+    s = agent->StartTunerTrace(trace_file);
+    if (!s.ok()) {
+      throw utils::Exception("RocksDB StartTunerTrace: " + s.ToString());
+    }
+  }
+}
+
+// <name length><name><value length><value> for every field
+void RocksdbDB::SerializeRow(const std::vector<Field> &values, std::string *data) {
+  for (const Field &field : values) {
+    rocksdb::PutLengthPrefixedSlice(data, field.name);
+    rocksdb::PutLengthPrefixedSlice(data, field.value);
+  }
+}
+
+bool RocksdbDB::DeserializeRow(rocksdb::Slice data,
+                               const std::vector<std::string> *fields,
+                               std::vector<Field> *values) {
+  rocksdb::Slice name;
+  rocksdb::Slice value;
+  while (!data.empty()) {
+    if (!rocksdb::GetLengthPrefixedSlice(&data, &name) ||
+        !rocksdb::GetLengthPrefixedSlice(&data, &value)) {
+      return false;
+    }
+    if (Selected(fields, name)) {
+      values->push_back({name.ToString(), value.ToString()});
+    }
+  }
+  return true;
+}
+
+DB::Status RocksdbDB::FromRocksdb(const rocksdb::Status &s) {
+  if (s.ok()) {
+    return kOK;
+  } else if (s.IsNotFound()) {
+    return kNotFound;
+  }
+  std::cerr << "RocksDB: " << s.ToString() << std::endl;
+  return kError;
+}
+
+DB::Status RocksdbDB::ReadRow(const rocksdb::Slice &key,
+                              const std::vector<std::string> *fields,
+                              std::vector<Field> *values) {
+  if (format_ == kPacked) {
+    rocksdb::PinnableSlice data;
+    Status s = FromRocksdb(
+        db_->Get(read_options_, db_->DefaultColumnFamily(), key, &data));
+    if (s != kOK) {
+      return s;
+    }
+    return DeserializeRow(data, fields, values) ? kOK : kError;
+  }
+  rocksdb::PinnableWideColumns columns;
+  Status s = FromRocksdb(
+      db_->GetEntity(read_options_, db_->DefaultColumnFamily(), key, &columns));
+  if (s != kOK) {
+    return s;
+  }
+  for (const auto &column : columns.columns()) {
+    if (Selected(fields, column.name())) {
+      values->push_back({column.name().ToString(), column.value().ToString()});
+    }
+  }
+  return kOK;
+}
+
+DB::Status RocksdbDB::WriteRow(const std::string &key,
+                               const std::vector<Field> &values) {
+  if (format_ == kPacked) {
+    row_buffer_.clear();
+    SerializeRow(values, &row_buffer_);
+    return FromRocksdb(db_->Put(write_options_, key, row_buffer_));
+  }
+  rocksdb::WideColumns columns;
+  columns.reserve(values.size());
+  for (const Field &field : values) {
+    columns.emplace_back(field.name, field.value);
+  }
+  return FromRocksdb(db_->PutEntity(write_options_, db_->DefaultColumnFamily(),
+                                    key, columns));
+}
+
+void RocksdbDB::ReportOps(int64_t num_ops) {
+  if (reporter_ != nullptr) {
+    reporter_->ReportFinishedOps(num_ops);
+  }
+}
+
+DB::Status RocksdbDB::Read(const std::string & /*table*/, const std::string &key,
+                           const std::vector<std::string> *fields,
+                           std::vector<Field> &result) {
+  Status s = ReadRow(key, fields, &result);
+  ReportOps(1);
+  return s;
+}
+
+DB::Status RocksdbDB::BatchRead(const std::string & /*table*/,
+                                const std::vector<std::string> &keys,
+                                const std::vector<std::string> *fields,
+                                std::vector<std::vector<Field>> &result) {
+  result.resize(keys.size());
+  Status s = kOK;
+  if (format_ == kWideColumns) {
+    // 7.11 还没有 MultiGetEntity
+    for (size_t i = 0; i < keys.size(); i++) {
+      Status key_status = ReadRow(keys[i], fields, &result[i]);
+      s = s == kOK ? key_status : s;
+    }
+    ReportOps(keys.size());
+    return s;
+  }
+  std::vector<rocksdb::Slice> key_slices(keys.begin(), keys.end());
+  std::vector<rocksdb::PinnableSlice> values(keys.size());
+  std::vector<rocksdb::Status> statuses(keys.size());
+  db_->MultiGet(read_options_, db_->DefaultColumnFamily(), keys.size(),
+                key_slices.data(), values.data(), statuses.data());
+  for (size_t i = 0; i < keys.size(); i++) {
+    Status key_status = FromRocksdb(statuses[i]);
+    if (key_status == kOK && !DeserializeRow(values[i], fields, &result[i])) {
+      key_status = kError;
+    }
+    s = s == kOK ? key_status : s;
+  }
+  ReportOps(keys.size());
+  return s;
+}
+
+DB::Status RocksdbDB::Scan(const std::string & /*table*/, const std::string &key,
+                           int len, const std::vector<std::string> *fields,
+                           std::vector<std::vector<Field>> &result) {
+  if (iter_ == nullptr || !iter_->Refresh().ok()) {
+    iter_.reset(db_->NewIterator(read_options_));
+  }
+  Status s = kOK;
+  iter_->Seek(key);
+  for (int i = 0; iter_->Valid() && i < len; i++, iter_->Next()) {
+    result.emplace_back();
+    if (format_ == kPacked) {
+      if (!DeserializeRow(iter_->value(), fields, &result.back())) {
+        s = kError;
+        break;
+      }
+    } else {
+      // iterator 只给出默认列，其他列要按 key 再读
+      s = ReadRow(iter_->key(), fields, &result.back());
+      if (s != kOK) {
+        break;
+      }
+    }
+  }
+  if (s == kOK && !iter_->status().ok()) {
+    s = FromRocksdb(iter_->status());
+  }
+  ReportOps(1);
+  return s;
+}
+
+DB::Status RocksdbDB::Update(const std::string & /*table*/, const std::string &key,
+                             std::vector<Field> &values) {
+  // 两种格式都是整行覆盖，只改部分字段时要先读出整行
+  std::vector<Field> row;
+  Status s = ReadRow(key, nullptr, &row);
+  if (s == kOK) {
+    for (Field &value : values) {
+      auto it = std::find_if(row.begin(), row.end(), [&](const Field &field) {
+        return field.name == value.name;
+      });
+      if (it == row.end()) {
+        row.push_back(value);
+      } else {
+        it->value = value.value;
+      }
+    }
+    s = WriteRow(key, row);
+  }
+  ReportOps(1);
+  return s;
+}
+
+DB::Status RocksdbDB::Insert(const std::string & /*table*/, const std::string &key,
+                             std::vector<Field> &values) {
+  Status s = WriteRow(key, values);
+  ReportOps(1);
+  return s;
+}
+
+DB::Status RocksdbDB::Delete(const std::string & /*table*/, const std::string &key) {
+  Status s = FromRocksdb(db_->Delete(write_options_, key));
+  ReportOps(1);
+  return s;
+}
+
+DB *NewRocksdbDB() { return new RocksdbDB; }
+
+} // ycsbc
@@ -0,0 +1,105 @@
+//
+//  rocksdb_db.h
+//  YCSB-cpp
+//
+//  Binding of the ADOC RocksDB engine, selected with `-db rocksdb`.
+//
+
+#ifndef YCSB_C_ROCKSDB_DB_H_
+#define YCSB_C_ROCKSDB_DB_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "db.h"
+#include "properties.h"
+#include "rocksdb/db.h"
+
+namespace rocksdb {
+class ReporterAgent;
+class TunerEventListener;
+}  // namespace rocksdb
+
+namespace ycsbc {
+
+///
+/// All the client threads share one rocksdb::DB, opened by the first Init()
+/// and closed by the last Cleanup(). The table name is ignored.
+///
+/// Properties:
+///   rocksdb.dbname          path of the DB (required)
+///   rocksdb.optionsfile     OPTIONS file to open the DB with
+///   rocksdb.destroy         destroy the DB before opening it
+///   rocksdb.format          "packed": the fields are packed into one value,
+///                           "wide": one wide column per field
+///   rocksdb.tuner           "off", "dota" or "feat", attaches a
+///                           ReporterAgentWithTuning to the DB
+///   rocksdb.tuner.tea       TEA of the FEAT tuner
+///   rocksdb.tuner.fea       FEA of the FEAT tuner
+///   rocksdb.report_file     throughput report of the tuner
+///   rocksdb.report_interval seconds between report lines
+///   rocksdb.tuning_gap      seconds between tuning rounds
+///   rocksdb.tuner_trace     trace file of the tuner, see tools/tuner_replay
+///
+class RocksdbDB : public DB {
+ public:
+  RocksdbDB() {}
+  ~RocksdbDB();
+
+  void Init();
+  void Cleanup();
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result);
+
+  Status BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                   const std::vector<std::string> *fields,
+                   std::vector<std::vector<Field>> &result);
+
+  Status Scan(const std::string &table, const std::string &key, int len,
+              const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result);
+
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values);
+
+  Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values);
+
+  Status Delete(const std::string &table, const std::string &key);
+
+ private:
+  enum RowFormat { kPacked, kWideColumns };
+
+  static void OpenDB(const utils::Properties &props);
+  static void SerializeRow(const std::vector<Field> &values, std::string *data);
+  static bool DeserializeRow(rocksdb::Slice data,
+                             const std::vector<std::string> *fields,
+                             std::vector<Field> *values);
+  static Status FromRocksdb(const rocksdb::Status &s);
+
+  Status ReadRow(const rocksdb::Slice &key, const std::vector<std::string> *fields,
+                 std::vector<Field> *values);
+  Status WriteRow(const std::string &key, const std::vector<Field> &values);
+  void ReportOps(int64_t num_ops);
+
+  static std::mutex mutex_;
+  static int ref_cnt_;
+  static rocksdb::DB *db_;
+  static RowFormat format_;
+  static std::shared_ptr<rocksdb::TunerEventListener> tuner_listener_;
+  static std::unique_ptr<rocksdb::ReporterAgent> reporter_;
+
+  rocksdb::ReadOptions read_options_;
+  rocksdb::WriteOptions write_options_;
+  // 每个客户端线程复用一个 iterator，Scan 前 Refresh 到最新的数据。
+  // 两次 Scan 之间它会钉住旧的 memtable 和 SST，Cleanup() 时释放
+  std::unique_ptr<rocksdb::Iterator> iter_;
+  // 打包后的行，跨写入复用容量
+  std::string row_buffer_;
+};
+
+DB *NewRocksdbDB();
+
+} // ycsbc
+
+#endif // YCSB_C_ROCKSDB_DB_H_
@@ -6,12 +6,16 @@
 //  Copyright (c) 2014 Jinglei Ren <jinglei@ren.systems>.
 //
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <climits>
 #include <cstring>
 #include <ctime>
 #include <future>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
@@ -51,6 +55,107 @@ void StatusThread(ycsbc::Measurements *measurements, CountDownLatch *latch,
   };
 }
 
+std::vector<std::string> PhaseNames(const ycsbc::utils::Properties &props) {
+  std::vector<std::string> phases;
+  std::stringstream names(props.GetProperty("phases"));
+  std::string name;
+  while (std::getline(names, name, ',')) {
+    name = ycsbc::utils::Trim(name);
+    if (!name.empty()) {
+      phases.push_back(name);
+    }
+  }
+  return phases;
+}
+
+ycsbc::utils::Properties PhaseProperties(const ycsbc::utils::Properties &props,
+                                         const std::string &phase) {
+  ycsbc::utils::Properties phase_props = props;
+  phase_props.OverrideWithPrefix("phase." + phase + ".");
+  return phase_props;
+}
+
+///
+/// Runs the transaction phases one after another on the already open DB.
+/// A phase runs for phase.<name>.duration seconds, or its operationcount
+/// when there is no duration, and reports its own throughput and latency.
+/// The records inserted by a phase can be read by the ones after it.
+///
+void RunPhases(const ycsbc::utils::Properties &props,
+               const std::vector<std::string> &phases,
+               const std::vector<ycsbc::DB *> &dbs,
+               ycsbc::Measurements *measurements, bool show_status,
+               int status_interval) {
+  using namespace std::chrono;
+  uint64_t record_count =
+      std::stoull(props[ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY]);
+  for (const std::string &phase : phases) {
+    ycsbc::utils::Properties phase_props = PhaseProperties(props, phase);
+    phase_props.SetProperty(ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY,
+                            std::to_string(record_count));
+    const int num_threads = stoi(phase_props.GetProperty("threadcount", "1"));
+    const int duration = stoi(phase_props.GetProperty("duration", "0"));
+    const int total_ops =
+        duration > 0
+            ? INT_MAX
+            : stoi(phase_props[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
+
+    ycsbc::CoreWorkload wl;
+    wl.Init(phase_props);
+    ycsbc::ArrivalSchedule schedule(phase_props, num_threads);
+    measurements->Reset();
+
+    std::time_t start_c = system_clock::to_time_t(system_clock::now());
+    std::cout << "Phase " << phase << " start: "
+              << std::put_time(std::localtime(&start_c), "%F %T") << std::endl;
+
+    CountDownLatch latch(num_threads);
+    std::atomic<bool> stop{false};
+    ycsbc::utils::Timer<double> timer;
+
+    timer.Start();
+    std::future<void> status_future;
+    if (show_status) {
+      status_future = std::async(std::launch::async, StatusThread,
+                                 measurements, &latch, status_interval);
+    }
+    std::vector<std::future<int>> client_threads;
+    for (int i = 0; i < num_threads; ++i) {
+      int thread_ops = total_ops;
+      if (duration == 0) {
+        thread_ops = total_ops / num_threads + (i < total_ops % num_threads);
+      }
+      client_threads.emplace_back(
+          std::async(std::launch::async, ycsbc::ClientThread, dbs[i], &wl,
+                     thread_ops, false, false, false, &latch, measurements,
+                     &schedule, &stop));
+    }
+    if (duration > 0) {
+      latch.AwaitFor(duration);
+      stop.store(true);
+    }
+
+    int sum = 0;
+    for (auto &n : client_threads) {
+      sum += n.get();
+    }
+    double runtime = timer.End();
+
+    if (show_status) {
+      status_future.wait();
+    }
+
+    std::cout << "Phase " << phase << " runtime(sec): " << runtime << std::endl;
+    std::cout << "Phase " << phase << " operations(ops): " << sum << std::endl;
+    std::cout << "Phase " << phase << " throughput(ops/sec): " << sum / runtime
+              << std::endl;
+    std::cout << "Phase " << phase << " latency(us):"
+              << measurements->GetSummaryMsg() << std::endl;
+
+    record_count = wl.transaction_insert_key_sequence_->Last() + 1;
+  }
+}
+
 int ycsbc_main(const int argc, const char *argv[]) {
   ycsbc::utils::Properties props;
   ParseCommandLine(argc, argv, props);
@@ -65,9 +170,19 @@ int ycsbc_main(const int argc, const char *argv[]) {
 
   const int num_threads = stoi(props.GetProperty("threadcount", "1"));
 
+  // 有 phases 时事务阶段按脚本跑，DB 由这里打开一次，各阶段之间不重开
+  const std::vector<std::string> phases = PhaseNames(props);
+  const bool scripted = do_transaction && !phases.empty();
+  int max_threads = num_threads;
+  for (const std::string &phase : phases) {
+    max_threads = std::max(
+        max_threads,
+        stoi(PhaseProperties(props, phase).GetProperty("threadcount", "1")));
+  }
+
   ycsbc::Measurements measurements;
   std::vector<ycsbc::DB *> dbs;
-  for (int i = 0; i < num_threads; i++) {
+  for (int i = 0; i < max_threads; i++) {
     ycsbc::DB *db = ycsbc::DBFactory::CreateDB(&props, &measurements);
     if (db == nullptr) {
       std::cerr << "Unknown database name " << props["dbname"] << std::endl;
@@ -76,6 +191,12 @@ int ycsbc_main(const int argc, const char *argv[]) {
     dbs.push_back(db);
   }
 
+  if (scripted) {
+    for (ycsbc::DB *db : dbs) {
+      db->Init();
+    }
+  }
+
   ycsbc::CoreWorkload wl;
   wl.Init(props);
 
@@ -89,6 +210,8 @@ int ycsbc_main(const int argc, const char *argv[]) {
         stoi(props[ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY]);
 
     CountDownLatch latch(num_threads);
+    ycsbc::ArrivalSchedule schedule(
+        ycsbc::ArrivalSchedule::LoadPhaseProperties(props), num_threads);
     ycsbc::utils::Timer<double> timer;
 
     timer.Start();
@@ -105,7 +228,8 @@ int ycsbc_main(const int argc, const char *argv[]) {
       }
       client_threads.emplace_back(
           std::async(std::launch::async, ycsbc::ClientThread, dbs[i], &wl,
-                     thread_ops, true, true, !do_transaction, &latch));
+                     thread_ops, true, !scripted, !do_transaction, &latch,
+                     &measurements, &schedule, nullptr));
     }
     assert((int)client_threads.size() == num_threads);
 
@@ -123,6 +247,8 @@ int ycsbc_main(const int argc, const char *argv[]) {
     std::cout << "Load runtime(sec): " << runtime << std::endl;
     std::cout << "Load operations(ops): " << sum << std::endl;
     std::cout << "Load throughput(ops/sec): " << sum / runtime << std::endl;
+    std::cout << "Load latency(us):" << measurements.GetSummaryMsg()
+              << std::endl;
   }
 
   measurements.Reset();
@@ -130,11 +256,17 @@ int ycsbc_main(const int argc, const char *argv[]) {
       std::chrono::seconds(stoi(props.GetProperty("sleepafterload", "0"))));
 
   // transaction phase
-  if (do_transaction) {
+  if (scripted) {
+    RunPhases(props, phases, dbs, &measurements, show_status, status_interval);
+    for (ycsbc::DB *db : dbs) {
+      db->Cleanup();
+    }
+  } else if (do_transaction) {
     const int total_ops =
         stoi(props[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
 
     CountDownLatch latch(num_threads);
+    ycsbc::ArrivalSchedule schedule(props, num_threads);
     ycsbc::utils::Timer<double> timer;
 
     timer.Start();
@@ -151,7 +283,8 @@ int ycsbc_main(const int argc, const char *argv[]) {
       }
       client_threads.emplace_back(
           std::async(std::launch::async, ycsbc::ClientThread, dbs[i], &wl,
-                     thread_ops, false, !do_load, true, &latch));
+                     thread_ops, false, !do_load, true, &latch,
+                     &measurements, &schedule, nullptr));
     }
     assert((int)client_threads.size() == num_threads);
 
@@ -169,12 +302,14 @@ int ycsbc_main(const int argc, const char *argv[]) {
     std::cout << "Run runtime(sec): " << runtime << std::endl;
     std::cout << "Run operations(ops): " << sum << std::endl;
     std::cout << "Run throughput(ops/sec): " << sum / runtime << std::endl;
+    std::cout << "Run latency(us):" << measurements.GetSummaryMsg()
+              << std::endl;
   }
 
-  for (int i = 0; i < num_threads; i++) {
-    delete dbs[i];
+  for (ycsbc::DB *db : dbs) {
+    delete db;
   }
-  return -1;
+  return 0;
 }
 
 void ParseCommandLine(int argc, const char *argv[],
@@ -266,7 +401,8 @@ void UsageMessage(const char *command) {
          "  -t: run the transactions phase of the workload\n"
          "  -run: same as -t\n"
          "  -threads n: execute using n threads (default: 1)\n"
-         "  -db dbname: specify the name of the DB to use (default: basic)\n"
+         "  -db dbname: specify the name of the DB to use (default: basic),\n"
+         "              basic or rocksdb\n"
          "  -P propertyfile: load properties from the given file. Multiple "
          "files can\n"
          "                   be specified, and will be processed in the order "
@@ -277,7 +413,13 @@ void UsageMessage(const char *command) {
          "any\n"
          "                 values in the propertyfile\n"
          "  -s: print status every 10 seconds (use status.interval prop to "
-         "override)"
+         "override)\n"
+         "With -p phases=a,b,... the transaction phase runs the listed phases\n"
+         "in order on the same DB, phase.<name>.<prop>=value overrides a\n"
+         "property in one phase and phase.<name>.duration=secs sets how long\n"
+         "it runs instead of operationcount\n"
+         "target and targetschedule pace the transaction phase only, use\n"
+         "load.target and load.targetschedule to pace the load phase"
       << std::endl;
 }
 
@@ -148,8 +148,9 @@ class DOTA_Tuner {
   SystemScores max_scores; // 历史峰值
   SystemScores avg_scores; // 平均值
 
-  uint64_t last_flush_thread_len;
-  uint64_t last_compaction_thread_len;
+  // 线程池累计的空闲时间 (ns)，每个调优周期取差值
+  uint64_t last_flush_idle_nanos;
+  uint64_t last_compaction_idle_nanos;
   Env* env_;
 
   double tuning_gap; // tuning 的时间间隔
@@ -182,8 +183,8 @@ class DOTA_Tuner {
         compaction_list_from_opt_ptr(
             running_db->immutable_db_options().job_stats),
         max_scores(),
-        last_flush_thread_len(0),
-        last_compaction_thread_len(0),
+        last_flush_idle_nanos(0),
+        last_compaction_idle_nanos(0),
         env_(env),
         tuning_gap(gap_sec),
         core_num(running_db->immutable_db_options().core_number),
@@ -168,25 +168,22 @@ SystemScores DOTA_Tuner::ScoreTheSystem() {
         current_score.l0_drop_ratio /= l0_compaction;
     }
 
-    // 获取后台线程池的等待时间
+    // 获取后台线程池的累计空闲时间
     // Env::HIGH 对应的是 flush 线程池，Env::LOW 对应的是 compaction 线程池
-    auto flush_thread_idle_list = *env_->GetThreadPoolWaitingTime(Env::HIGH);
-    auto compaction_thread_idle_list = *env_->GetThreadPoolWaitingTime(Env::LOW);
-    std::unordered_map<int, uint64_t> thread_idle_time;
-    // 本次调优周期内新增的 flush 线程等待记录
-    // 下面分别累加了 flush 与 compaction 的空闲时间
-    uint64_t temp = flush_thread_idle_list.size();
-    for (uint64_t i = last_flush_thread_len; i < temp; i++) {
-        auto temp_entry = flush_thread_idle_list[i];
-        auto value = temp_entry.second;
-        current_score.flush_idle_time += value;
-    }
-    temp = compaction_thread_idle_list.size();
-    for (uint64_t i = last_compaction_thread_len; i < temp; i++) {
-        auto temp_entry = compaction_thread_idle_list[i];
-        auto value = temp_entry.second;
-        current_score.compaction_idle_time += value;
-    }
+    // 计数器只增不减，O(1) 读取，本周期的空闲时间就是两次读数的差值
+    uint64_t busy_nanos = 0;
+    uint64_t flush_idle_nanos = last_flush_idle_nanos;
+    uint64_t compaction_idle_nanos = last_compaction_idle_nanos;
+    env_->GetThreadPoolUtilization(Env::HIGH, &busy_nanos, &flush_idle_nanos)
+        .PermitUncheckedError();
+    env_->GetThreadPoolUtilization(Env::LOW, &busy_nanos,
+                                   &compaction_idle_nanos)
+        .PermitUncheckedError();
+    // 下面分别累加了 flush 与 compaction 的空闲时间 (micros)
+    current_score.flush_idle_time +=
+        (flush_idle_nanos - last_flush_idle_nanos) / 1000.0;
+    current_score.compaction_idle_time +=
+        (compaction_idle_nanos - last_compaction_idle_nanos) / 1000.0;
     // 分别转换为 idle time 占总时间的比例
     // 通过直接计算线程的 idle time 来判断后台任务是否饱和
     current_score.flush_idle_time /=
@@ -199,8 +196,8 @@ SystemScores DOTA_Tuner::ScoreTheSystem() {
     // 更新索引
     flush_list_accessed = flush_result_length;
     compaction_list_accessed = compaction_result_length;
-    last_compaction_thread_len = compaction_thread_idle_list.size();
-    last_flush_thread_len = flush_thread_idle_list.size();
+    last_flush_idle_nanos = flush_idle_nanos;
+    last_compaction_idle_nanos = compaction_idle_nanos;
     return current_score;
 }
 
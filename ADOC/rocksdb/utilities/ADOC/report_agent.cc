@@ -45,8 +45,6 @@ ReporterAgentWithTuning::ReporterAgentWithTuning(DBImpl* running_db, Env* env,
   }
   this->tuning_gap_secs_ = std::max(dota_tuning_gap_secs, report_interval_secs);
   this->last_metrics_collect_secs = 0;
-  this->last_compaction_thread_len = 0;
-  this->last_flush_thread_len = 0;
   tuner.reset(new DOTA_Tuner(options_when_boost, running_db_, &last_report_,
                              &total_ops_done_, env_, tuning_gap_secs_));
   tuner->ResetTuner();
@@ -0,0 +1,149 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/auto_tuner.h"
+
+#include <algorithm>
+
+namespace ROCKSDB_NAMESPACE {
+
+AutoTuner::AutoTuner(int max_background_jobs_limit,
+                     uint64_t base_write_buffer_size,
+                     uint64_t max_write_buffer_size)
+    : max_background_jobs_limit_(
+          std::max(max_background_jobs_limit, kMinBackgroundJobs)),
+      base_write_buffer_size_(base_write_buffer_size),
+      min_write_buffer_size_(
+          std::min(kMinWriteBufferSize, base_write_buffer_size)),
+      max_write_buffer_size_(
+          std::max(max_write_buffer_size, base_write_buffer_size)) {}
+
+AutoTuner::Scores AutoTuner::ScoreTheSystem(
+    const AutoTuneSample& sample) const {
+  Scores scores;
+  const uint64_t elapsed_micros =
+      sample.now_micros > last_sample_.now_micros
+          ? sample.now_micros - last_sample_.now_micros
+          : 0;
+  if (elapsed_micros > 0) {
+    scores.write_rate =
+        static_cast<double>(sample.bytes_written - last_sample_.bytes_written) *
+        1000000 / elapsed_micros;
+  }
+  scores.flush_numbers = sample.flush_count - last_sample_.flush_count;
+  const uint64_t flush_micros = sample.flush_micros - last_sample_.flush_micros;
+  if (scores.flush_numbers > 0 && flush_micros > 0) {
+    scores.flush_speed =
+        static_cast<double>(sample.flush_bytes - last_sample_.flush_bytes) /
+        flush_micros;
+  }
+  scores.immutable_number = sample.num_immutable_memtables;
+  if (sample.level0_slowdown_writes_trigger > 0) {
+    scores.l0_ratio = static_cast<double>(sample.num_l0_files) /
+                      sample.level0_slowdown_writes_trigger;
+  }
+  if (sample.soft_pending_compaction_bytes_limit > 0) {
+    scores.pending_bytes_ratio =
+        static_cast<double>(sample.estimated_pending_compaction_bytes) /
+        sample.soft_pending_compaction_bytes_limit;
+  }
+  return scores;
+}
+
+AutoTuner::Op AutoTuner::TuneByTEA(const Scores& scores) const {
+  Op op = Op::kKeep;
+  if (scores.immutable_number >= 1) {
+    op = Op::kLinearIncrease;
+  }
+  // 刷盘带宽掉到历史最好的一半以下，说明设备已经拥塞，再加线程只会更慢
+  if (scores.flush_speed > 0 &&
+      scores.flush_speed < max_flush_speed_ * kSlowFlushRatio) {
+    op = Op::kHalf;
+  }
+  // L0 或 pending bytes 到了 slowdown 阈值，优先让 compaction 跟上
+  if (scores.pending_bytes_ratio >= 1 || scores.l0_ratio >= 1) {
+    op = Op::kLinearIncrease;
+  }
+  return op;
+}
+
+AutoTuner::Op AutoTuner::TuneByFEA(const Scores& scores) const {
+  Op op = Op::kKeep;
+  if (scores.flush_speed < max_flush_speed_ * kSlowFlushRatio ||
+      scores.immutable_number > 1) {
+    op = Op::kLinearIncrease;
+  }
+  // 更大的 memtable 会让 compaction 欠账更多
+  if (scores.pending_bytes_ratio >= 1) {
+    op = Op::kHalf;
+  }
+  return op;
+}
+
+int AutoTuner::NextBackgroundJobs(Op op, int current) const {
+  int target = current;
+  switch (op) {
+    case Op::kLinearIncrease:
+      target = current + 2;
+      break;
+    case Op::kHalf:
+      target = current / 2;
+      break;
+    case Op::kKeep:
+      return current;
+  }
+  return std::min(std::max(target, kMinBackgroundJobs),
+                  max_background_jobs_limit_);
+}
+
+uint64_t AutoTuner::NextWriteBufferSize(Op op, uint64_t current) const {
+  uint64_t target = current;
+  switch (op) {
+    case Op::kLinearIncrease:
+      target = current + base_write_buffer_size_;
+      break;
+    case Op::kHalf:
+      target = current / 2;
+      break;
+    case Op::kKeep:
+      return current;
+  }
+  return std::min(std::max(target, min_write_buffer_size_),
+                  max_write_buffer_size_);
+}
+
+bool AutoTuner::Tick(const AutoTuneSample& sample, Decision* decision) {
+  decision->thread_op = Op::kKeep;
+  decision->batch_op = Op::kKeep;
+  decision->max_background_jobs = sample.max_background_jobs;
+  decision->write_buffer_size = sample.write_buffer_size;
+
+  if (!has_last_sample_) {
+    has_last_sample_ = true;
+    last_sample_ = sample;
+    return false;
+  }
+  last_scores_ = ScoreTheSystem(sample);
+  last_sample_ = sample;
+  if (last_scores_.flush_speed == 0) {
+    return false;
+  }
+  max_flush_speed_ = std::max(max_flush_speed_, last_scores_.flush_speed);
+  // 第一个有 flush 的周期只用来建立基线
+  if (++scored_periods_ == 1) {
+    return false;
+  }
+
+  decision->thread_op = TuneByTEA(last_scores_);
+  decision->batch_op = TuneByFEA(last_scores_);
+  decision->max_background_jobs =
+      NextBackgroundJobs(decision->thread_op, sample.max_background_jobs);
+  decision->write_buffer_size =
+      NextWriteBufferSize(decision->batch_op, sample.write_buffer_size);
+  return decision->max_background_jobs != sample.max_background_jobs ||
+         decision->write_buffer_size != sample.write_buffer_size;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
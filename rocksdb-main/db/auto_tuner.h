@@ -0,0 +1,114 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// add for ADOC tuner
+// The FEAT tuner of ADOC, embedded into the DB. Every
+// DBOptions::auto_tune_period_sec the DB takes an AutoTuneSample (cumulative
+// counters plus a few gauges, all read under the DB mutex) and feeds it to
+// AutoTuner::Tick(), which scores the last period and votes:
+//
+//  * TEA (thread) votes on max_background_jobs: more jobs when flushes queue
+//    up or L0 / pending compaction bytes reach their slowdown triggers, half
+//    of them when the flush bandwidth collapses (the device is congested).
+//  * FEA (batch) votes on write_buffer_size: larger memtables when flushes
+//    are slow or queue up, smaller ones when pending compaction bytes reach
+//    the soft limit.
+//
+// The tuner itself only holds the history of the previous samples, applying
+// the decision is left to the DB.
+
+#pragma once
+
+#include <cstdint>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct AutoTuneSample {
+  uint64_t now_micros = 0;
+
+  // Cumulative counters
+  uint64_t bytes_written = 0;
+  uint64_t flush_count = 0;
+  uint64_t flush_bytes = 0;
+  uint64_t flush_micros = 0;
+
+  // Gauges of the tuned column family
+  int num_immutable_memtables = 0;
+  int num_l0_files = 0;
+  uint64_t estimated_pending_compaction_bytes = 0;
+
+  // Settings in effect
+  int max_background_jobs = 0;
+  uint64_t write_buffer_size = 0;
+  int level0_slowdown_writes_trigger = 0;
+  uint64_t soft_pending_compaction_bytes_limit = 0;
+};
+
+class AutoTuner {
+ public:
+  enum class Op { kKeep, kLinearIncrease, kHalf };
+
+  // What happened during one period
+  struct Scores {
+    // Bytes per second written by users
+    double write_rate = 0;
+    // Bytes per microsecond of the flushes that finished in the period
+    double flush_speed = 0;
+    uint64_t flush_numbers = 0;
+    int immutable_number = 0;
+    // L0 files / level0_slowdown_writes_trigger
+    double l0_ratio = 0;
+    // Estimated pending compaction bytes / soft_pending_compaction_bytes_limit
+    double pending_bytes_ratio = 0;
+  };
+
+  struct Decision {
+    Op thread_op = Op::kKeep;
+    Op batch_op = Op::kKeep;
+    int max_background_jobs = 0;
+    uint64_t write_buffer_size = 0;
+  };
+
+  // The TEA slow-flush threshold of ADOC: a flush bandwidth below this
+  // fraction of the best one seen means the device is congested.
+  static constexpr double kSlowFlushRatio = 0.5;
+  static constexpr int kMinBackgroundJobs = 2;
+  static constexpr uint64_t kMinWriteBufferSize = 64 << 20;
+
+  // `base_write_buffer_size` is the step of a linear memtable increase.
+  AutoTuner(int max_background_jobs_limit, uint64_t base_write_buffer_size,
+            uint64_t max_write_buffer_size);
+
+  // Scores the period since the previous sample and fills `decision`.
+  // Returns true when max_background_jobs or write_buffer_size should
+  // change. Periods without a finished flush carry no flush bandwidth and
+  // are not voted on.
+  bool Tick(const AutoTuneSample& sample, Decision* decision);
+
+  const Scores& last_scores() const { return last_scores_; }
+  double max_flush_speed() const { return max_flush_speed_; }
+
+ private:
+  Scores ScoreTheSystem(const AutoTuneSample& sample) const;
+  Op TuneByTEA(const Scores& scores) const;
+  Op TuneByFEA(const Scores& scores) const;
+  int NextBackgroundJobs(Op op, int current) const;
+  uint64_t NextWriteBufferSize(Op op, uint64_t current) const;
+
+  const int max_background_jobs_limit_;
+  const uint64_t base_write_buffer_size_;
+  const uint64_t min_write_buffer_size_;
+  const uint64_t max_write_buffer_size_;
+
+  bool has_last_sample_ = false;
+  AutoTuneSample last_sample_;
+  Scores last_scores_;
+  uint64_t scored_periods_ = 0;
+  double max_flush_speed_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,230 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/auto_tuner.h"
+
+#include "db/db_test_util.h"
+#include "env/composite_env_wrapper.h"
+#include "port/stack_trace.h"
+#include "test_util/mock_time_env.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class AutoTunerTest : public testing::Test {
+ public:
+  static constexpr uint64_t kBase = 64 << 20;
+
+  AutoTunerTest() : tuner_(8, kBase, 4 * kBase) {
+    sample_.max_background_jobs = 4;
+    sample_.write_buffer_size = kBase;
+    sample_.level0_slowdown_writes_trigger = 20;
+    sample_.soft_pending_compaction_bytes_limit = 64ull << 30;
+  }
+
+  // 推进一个周期：期间完成 `flushes` 次 flush，每次写出 `bytes_per_flush`
+  // 字节、耗时 1ms
+  bool Period(int flushes, uint64_t bytes_per_flush,
+              AutoTuner::Decision* decision) {
+    sample_.now_micros += 1000000;
+    sample_.bytes_written += flushes * bytes_per_flush;
+    sample_.flush_count += flushes;
+    sample_.flush_bytes += flushes * bytes_per_flush;
+    sample_.flush_micros += flushes * 1000;
+    return tuner_.Tick(sample_, decision);
+  }
+
+  // 前两个周期只建立基线
+  void WarmUp() {
+    AutoTuner::Decision decision;
+    ASSERT_FALSE(tuner_.Tick(sample_, &decision));
+    ASSERT_FALSE(Period(1, 1 << 20, &decision));
+  }
+
+  AutoTuner tuner_;
+  AutoTuneSample sample_;
+};
+
+// 测试：基线周期和没有 flush 的周期都不投票
+TEST_F(AutoTunerTest, NoVoteWithoutFlushes) {
+  // 1. Arrange
+  WarmUp();
+  sample_.num_immutable_memtables = 3;
+
+  // 2. Act
+  AutoTuner::Decision decision;
+  bool changed = Period(0, 0, &decision);
+
+  // 3. Assert
+  ASSERT_FALSE(changed);
+  ASSERT_EQ(decision.max_background_jobs, 4);
+  ASSERT_EQ(decision.write_buffer_size, kBase);
+}
+
+// 测试：flush 排队时加线程、加大 memtable
+TEST_F(AutoTunerTest, QueuedFlushesAddJobsAndBatch) {
+  // 1. Arrange
+  WarmUp();
+  sample_.num_immutable_memtables = 2;
+
+  // 2. Act
+  AutoTuner::Decision decision;
+  bool changed = Period(1, 1 << 20, &decision);
+
+  // 3. Assert
+  ASSERT_TRUE(changed);
+  ASSERT_EQ(decision.thread_op, AutoTuner::Op::kLinearIncrease);
+  ASSERT_EQ(decision.batch_op, AutoTuner::Op::kLinearIncrease);
+  ASSERT_EQ(decision.max_background_jobs, 6);
+  ASSERT_EQ(decision.write_buffer_size, 2 * kBase);
+}
+
+// 测试：flush 带宽掉到一半以下时减半线程
+TEST_F(AutoTunerTest, SlowFlushHalvesJobs) {
+  // 1. Arrange
+  WarmUp();
+
+  // 2. Act
+  AutoTuner::Decision decision;
+  bool changed = Period(1, 256 << 10, &decision);
+
+  // 3. Assert
+  ASSERT_TRUE(changed);
+  ASSERT_EQ(decision.thread_op, AutoTuner::Op::kHalf);
+  ASSERT_EQ(decision.max_background_jobs, 2);
+  ASSERT_EQ(decision.write_buffer_size, 2 * kBase);
+}
+
+// 测试：pending bytes 到软上限时加线程、缩小 memtable
+TEST_F(AutoTunerTest, PendingBytesShrinkBatch) {
+  // 1. Arrange
+  WarmUp();
+  sample_.write_buffer_size = 2 * kBase;
+  sample_.estimated_pending_compaction_bytes =
+      sample_.soft_pending_compaction_bytes_limit;
+
+  // 2. Act
+  AutoTuner::Decision decision;
+  bool changed = Period(1, 1 << 20, &decision);
+
+  // 3. Assert
+  ASSERT_TRUE(changed);
+  ASSERT_EQ(decision.thread_op, AutoTuner::Op::kLinearIncrease);
+  ASSERT_EQ(decision.batch_op, AutoTuner::Op::kHalf);
+  ASSERT_EQ(decision.max_background_jobs, 6);
+  ASSERT_EQ(decision.write_buffer_size, kBase);
+}
+
+// 测试：调整结果不超出上下限
+TEST_F(AutoTunerTest, DecisionsAreBounded) {
+  // 1. Arrange
+  WarmUp();
+  sample_.max_background_jobs = 8;
+  sample_.write_buffer_size = 4 * kBase;
+  sample_.num_immutable_memtables = 2;
+
+  // 2. Act
+  AutoTuner::Decision decision;
+  bool changed = Period(1, 1 << 20, &decision);
+
+  // 3. Assert
+  ASSERT_FALSE(changed);
+  ASSERT_EQ(decision.max_background_jobs, 8);
+  ASSERT_EQ(decision.write_buffer_size, 4 * kBase);
+}
+
+class DBAutoTuneTest : public DBTestBase {
+ public:
+  DBAutoTuneTest() : DBTestBase("db_auto_tune_test", /*env_do_fsync=*/false) {
+    mock_clock_ = std::make_shared<MockSystemClock>(env_->GetSystemClock());
+    mock_env_.reset(new CompositeEnvWrapper(env_, mock_clock_));
+  }
+
+ protected:
+  std::unique_ptr<Env> mock_env_;
+  std::shared_ptr<MockSystemClock> mock_clock_;
+
+  void SetUp() override {
+    mock_clock_->InstallTimedWaitFixCallback();
+    SyncPoint::GetInstance()->SetCallBack(
+        "DBImpl::StartPeriodicTaskScheduler:Init", [&](void* arg) {
+          auto periodic_task_scheduler_ptr =
+              static_cast<PeriodicTaskScheduler*>(arg);
+          periodic_task_scheduler_ptr->TEST_OverrideTimer(mock_clock_.get());
+        });
+  }
+};
+
+// 测试：周期任务按 L0 和 flush 排队情况调整 max_background_jobs 和
+// write_buffer_size
+TEST_F(DBAutoTuneTest, AdjustsOptionsPeriodically) {
+  // 1. Arrange
+  Options options = CurrentOptions();
+  options.env = mock_env_.get();
+  options.auto_tune_period_sec = 1;
+  options.auto_tune_max_background_jobs = 8;
+  options.max_background_jobs = 2;
+  options.write_buffer_size = 1 << 20;
+  options.target_file_size_base = 1 << 20;
+  options.disable_auto_compactions = true;
+
+  // mock clock 下 flush 耗时为 0，按每次 flush 1ms 补上；L0 和 immutable
+  // memtable 的压力也在这里模拟，避免真的触发 write stall
+  int extra_l0_files = 0;
+  int extra_immutable_memtables = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::AutoTune:Sample", [&](void* arg) {
+        auto* sample = static_cast<AutoTuneSample*>(arg);
+        sample->flush_micros = sample->flush_count * 1000;
+        sample->num_l0_files += extra_l0_files;
+        sample->num_immutable_memtables += extra_immutable_memtables;
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  Reopen(options);
+  ASSERT_TRUE(dbfull()->TEST_GetPeriodicTaskScheduler().TEST_HasTask(
+      PeriodicTaskType::kAutoTune));
+
+  auto flush_one_period = [&](int round) {
+    for (int i = 0; i < 100; i++) {
+      ASSERT_OK(Put(Key(round * 100 + i), std::string(100, 'v')));
+    }
+    ASSERT_OK(Flush());
+    dbfull()->TEST_WaitForPeriodicTaskRun(
+        [&] { mock_clock_->MockSleepForSeconds(1); });
+  };
+
+  // 2. Act：L0 文件数达到 slowdown 阈值
+  extra_l0_files = options.level0_slowdown_writes_trigger;
+  int round = 0;
+  for (; round < 5 && dbfull()->GetDBOptions().max_background_jobs == 2;
+       round++) {
+    flush_one_period(round);
+  }
+
+  // 3. Assert
+  ASSERT_EQ(dbfull()->GetDBOptions().max_background_jobs, 4);
+  ASSERT_EQ(dbfull()->GetOptions().write_buffer_size, 1u << 20);
+
+  // 2. Act：再模拟 flush 排队
+  extra_immutable_memtables = 2;
+  flush_one_period(round);
+
+  // 3. Assert
+  ASSERT_EQ(dbfull()->GetDBOptions().max_background_jobs, 6);
+  ASSERT_EQ(dbfull()->GetOptions().write_buffer_size, 2u << 20);
+  ASSERT_EQ(dbfull()->GetOptions().target_file_size_base, 2u << 20);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
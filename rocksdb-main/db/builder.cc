@@ -22,6 +22,7 @@
 #include "db/output_validator.h"
 #include "db/range_del_aggregator.h"
 #include "db/table_cache.h"
+#include "db/tier_filter_index.h"
 #include "db/version_edit.h"
 #include "file/file_util.h"
 #include "file/filename.h"
@@ -355,6 +356,12 @@ Status BuildTable(
       assert(meta->fd.GetFileSize() > 0);
       tp = builder
                ->GetTableProperties();  // refresh now that builder is finished
+      // add for tier compaction style
+      // TierKeyFilterCollector 把 filter 写进了 table properties
+      if (ioptions.compaction_style == kCompactionStyleTier) {
+        meta->tier_key_filter = TierKeyFilter::FromTableProperties(
+            std::make_shared<const TableProperties>(tp));
+      }
       if (memtable_payload_bytes != nullptr &&
           memtable_garbage_bytes != nullptr) {
         const CompactionIterationStats& ci_stats = c_iter.iter_stats();
@@ -28,6 +28,7 @@
 #include "db/job_context.h"
 #include "db/range_del_aggregator.h"
 #include "db/table_properties_collector.h"
+#include "db/tier_filter_index.h"
 #include "db/version_set.h"
 #include "db/write_controller.h"
 #include "file/sst_file_manager_impl.h"
@@ -649,6 +650,15 @@ ColumnFamilyData::ColumnFamilyData(
 
   // Convert user defined table properties collector factories to internal ones.
   GetInternalTblPropCollFactory(ioptions_, &internal_tbl_prop_coll_factories_);
+  // add for tier compaction style
+  // 带时间戳的 user key 在写入和查找时不一致，不建 TierKeyFilter
+  if (ioptions_.compaction_style == kCompactionStyleTier &&
+      internal_comparator_.user_comparator()->timestamp_size() == 0) {
+    tier_key_filter_coll_factory_ = new TierKeyFilterCollectorFactory(
+        mutable_cf_options_.compaction_options_tier.filter_index_bits_per_key);
+    internal_tbl_prop_coll_factories_.emplace_back(
+        tier_key_filter_coll_factory_);
+  }
 
   // if _dummy_versions is nullptr, then this is a dummy column family.
   if (_dummy_versions != nullptr) {
@@ -1645,6 +1655,12 @@ Status ColumnFamilyData::SetOptions(
   if (s.ok()) {
     mutable_cf_options_ = MutableCFOptions(cf_opts);
     mutable_cf_options_.RefreshDerivedOptions(ioptions_);
+    // add for tier compaction style
+    if (tier_key_filter_coll_factory_ != nullptr) {
+      tier_key_filter_coll_factory_->SetBitsPerKey(
+          mutable_cf_options_.compaction_options_tier
+              .filter_index_bits_per_key);
+    }
   }
   return s;
 }
@@ -50,6 +50,7 @@ class InstrumentedMutexLock;
 struct SuperVersionContext;
 class BlobFileCache;
 class BlobSource;
+class TierKeyFilterCollectorFactory;
 
 extern const double kIncSlowdownRatio;
 // This file contains a list of data structures for managing column family
@@ -638,6 +639,9 @@ class ColumnFamilyData {
 
   const InternalKeyComparator internal_comparator_;
   InternalTblPropCollFactories internal_tbl_prop_coll_factories_;
+  // add for tier compaction style
+  // Owned by internal_tbl_prop_coll_factories_, nullptr unless tier style
+  TierKeyFilterCollectorFactory* tier_key_filter_coll_factory_ = nullptr;
 
   const ColumnFamilyOptions initial_cf_options_;
   const ImmutableOptions ioptions_;
@@ -9,6 +9,7 @@
 
 #include "db/compaction/compaction.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <vector>
 
@@ -72,6 +73,11 @@ void Compaction::FinalizeInputInfo(Version* _input_version) {
   cfd_->Ref();
   input_version_->Ref();
   edit_.SetColumnFamily(cfd_->GetID());
+  // add for tier compaction style
+  if (cfd_->ioptions().compaction_style == kCompactionStyleTier &&
+      output_level_ > 0) {
+    tier_output_epoch_number_ = cfd_->NewEpochNumber();
+  }
 }
 
 void Compaction::GetBoundaryKeys(
@@ -216,8 +222,36 @@ bool Compaction::IsBottommostLevel(
   }
   Slice smallest_key, largest_key;
   GetBoundaryKeys(vstorage, inputs, &smallest_key, &largest_key);
-  return !vstorage->RangeMightExistAfterSortedRun(smallest_key, largest_key,
-                                                  output_level, output_l0_idx);
+  if (vstorage->RangeMightExistAfterSortedRun(smallest_key, largest_key,
+                                              output_level, output_l0_idx)) {
+    return false;
+  }
+  // add for tier compaction style
+  // The outputs join the files already in the output level, which hold older
+  // versions of the same keys unless they are inputs themselves.
+  if (vstorage->compaction_style() == kCompactionStyleTier &&
+      output_level > 0) {
+    const Comparator* ucmp = vstorage->InternalComparator()->user_comparator();
+    for (const FileMetaData* f : vstorage->LevelFiles(output_level)) {
+      bool is_input = false;
+      for (const auto& level_inputs : inputs) {
+        if (level_inputs.level == output_level &&
+            std::find(level_inputs.files.begin(), level_inputs.files.end(),
+                      f) != level_inputs.files.end()) {
+          is_input = true;
+          break;
+        }
+      }
+      if (!is_input &&
+          ucmp->CompareWithoutTimestamp(f->largest.user_key(), smallest_key) >=
+              0 &&
+          ucmp->CompareWithoutTimestamp(f->smallest.user_key(), largest_key) <=
+              0) {
+        return false;
+      }
+    }
+  }
+  return true;
 }
 
 // test function to validate the functionality of IsBottommostLevel()
@@ -593,6 +627,14 @@ bool Compaction::IsTrivialMove() const {
     return is_trivial_move_;
   }
 
+  // add for tier compaction style
+  // Files of a tier may overlap each other, so only the tier picker can tell
+  // whether its inputs are safe to move; everything else is a real merge.
+  if (cfd_->ioptions().compaction_style == kCompactionStyleTier) {
+    return is_trivial_move_ && InputCompressionMatchesOutput() &&
+           !SupportsPerKeyPlacement();
+  }
+
   if (!(start_level_ != output_level_ && num_input_levels() == 1 &&
         input(0, 0)->fd.GetPathId() == output_path_id() &&
         InputCompressionMatchesOutput())) {
@@ -937,6 +979,11 @@ bool Compaction::ShouldFormSubcompactions() const {
     return (start_level_ == 0 || is_manual_compaction_) && output_level_ > 0;
   } else if (cfd_->ioptions().compaction_style == kCompactionStyleUniversal) {
     return number_levels_ > 1 && output_level_ > 0;
+  } else if (cfd_->ioptions().compaction_style == kCompactionStyleTier) {
+    // add for tier compaction style
+    // A tier merge reads overlapping runs like an L0->L1 compaction, so it
+    // can be split by the anchors sampled from every input file.
+    return output_level_ > start_level_;
   } else {
     return false;
   }
@@ -1017,6 +1064,14 @@ uint64_t Compaction::MinInputFileEpochNumber() const {
   return min_epoch_number;
 }
 
+uint64_t Compaction::OutputEpochNumber() const {
+  // add for tier compaction style
+  if (tier_output_epoch_number_ != kUnknownEpochNumber) {
+    return tier_output_epoch_number_;
+  }
+  return MinInputFileEpochNumber();
+}
+
 int Compaction::EvaluateProximalLevel(
     const VersionStorageInfo* vstorage,
     const MutableCFOptions& mutable_cf_options,
@@ -274,6 +274,8 @@ class Compaction {
   // Universal compaction. If all the input files are
   // non overlapping, then is_trivial_move_ variable
   // will be set true, else false
+  // Also used by tier compaction style for the tier files that overlap no
+  // other file of their level.
   void set_is_trivial_move(bool trivial_move) {
     is_trivial_move_ = trivial_move;
   }
@@ -440,6 +442,15 @@ class Compaction {
   // input files' associated with this compaction
   uint64_t MinInputFileEpochNumber() const;
 
+  // add for tier compaction style
+  // Epoch number of the files this compaction adds to the output level. The
+  // files of a tier level overlap each other and are searched by descending
+  // epoch number, so a tier compaction gives its outputs, or the files it
+  // moves, a new epoch number taken when it is picked. Any data that reaches
+  // the output level later was above the picked files then, i.e. newer.
+  // Other compaction styles keep MinInputFileEpochNumber().
+  uint64_t OutputEpochNumber() const;
+
   // Called by DBImpl::NotifyOnCompactionCompleted to make sure number of
   // compaction begin and compaction completion callbacks match.
   void SetNotifyOnCompactionCompleted() {
@@ -601,6 +612,10 @@ class Compaction {
   // compaction
   bool is_trivial_move_;
 
+  // add for tier compaction style
+  // See OutputEpochNumber(), kUnknownEpochNumber for other styles
+  uint64_t tier_output_epoch_number_ = kUnknownEpochNumber;
+
   // Does input compression match the output compression?
   bool InputCompressionMatchesOutput() const;
 
@@ -2185,7 +2185,7 @@ Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
       sub_compact->end.has_value() ? &tmp_end : nullptr);
 
   // Initialize a SubcompactionState::Output and add it to sub_compact->outputs
-  uint64_t epoch_number = sub_compact->compaction->MinInputFileEpochNumber();
+  uint64_t epoch_number = sub_compact->compaction->OutputEpochNumber();
   {
     FileMetaData meta;
     meta.fd = FileDescriptor(file_number,
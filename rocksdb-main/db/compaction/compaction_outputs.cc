@@ -11,6 +11,7 @@
 #include "db/compaction/compaction_outputs.h"
 
 #include "db/builder.h"
+#include "db/tier_filter_index.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -51,6 +52,14 @@ Status CompactionOutputs::Finish(
     meta->marked_for_compaction = builder_->NeedCompact();
     meta->user_defined_timestamps_persisted = static_cast<bool>(
         builder_->GetTableProperties().user_defined_timestamps_persisted);
+    // add for tier compaction style
+    // TierKeyFilterCollector 把 filter 写进了 table properties
+    if (compaction_->immutable_options().compaction_style ==
+        kCompactionStyleTier) {
+      meta->tier_key_filter = TierKeyFilter::FromTableProperties(
+          std::make_shared<const TableProperties>(
+              builder_->GetTableProperties()));
+    }
   }
   current_output().finished = true;
   stats_.bytes_written += current_bytes;
@@ -122,16 +122,16 @@ TEST_F(TieringCompactionPickerTest, PickCompaction_PicksLowestFullLevel) {
   ASSERT_EQ(compaction->output_level(), 2);
 }
 
-// 测试：确认挑选了目标层级的所有文件作为输入
+// 测试：层内文件互相重叠时，确认挑选了目标层级的所有文件作为输入
 TEST_F(TieringCompactionPickerTest, PickCompaction_SelectsAllFilesFromLevel) {
   // 1. Arrange
   const int T = 3;
   mutable_cf_options_.compaction_options_tier.files_per_tier = T;
   NewVersionStorage(6, kCompactionStyleTier);
-  // L1 满
-  Add(1, 10, "a", "b");
-  Add(1, 11, "c", "d");
-  Add(1, 12, "e", "f");
+  // L1 满，三个文件的 key range 互相重叠，构成同一个 slice
+  Add(1, 10, "a", "d");
+  Add(1, 11, "c", "f");
+  Add(1, 12, "e", "h");
   UpdateVersionStorageInfo();
 
   // 2. Act
@@ -230,9 +230,9 @@ TEST_F(TieringCompactionPickerTest, PickCompaction_IgnoresMaxCompactionBytes) {
   
   NewVersionStorage(6, kCompactionStyleTier);
   // L1 满，且总大小 (150 * 3 = 450) >> max_compaction_bytes
-  Add(1, 1, "a", "b", 150);
-  Add(1, 2, "c", "d", 150);
-  Add(1, 3, "e", "f", 150);
+  Add(1, 1, "a", "d", 150);
+  Add(1, 2, "c", "f", 150);
+  Add(1, 3, "e", "h", 150);
   UpdateVersionStorageInfo();
 
   // 2. Act
@@ -286,9 +286,9 @@ TEST_F(TieringCompactionPickerTest, PickCompaction_CompactsToBottommostLevel) {
 
   // 将倒数第二层 (L5) 填满
   const int second_to_last_level = kNumLevels - 2;
-  Add(second_to_last_level, 1, "a", "b");
-  Add(second_to_last_level, 2, "c", "d");
-  Add(second_to_last_level, 3, "e", "f");
+  Add(second_to_last_level, 1, "a", "d");
+  Add(second_to_last_level, 2, "c", "f");
+  Add(second_to_last_level, 3, "e", "h");
   UpdateVersionStorageInfo();
 
   // 2. Act
@@ -347,11 +347,456 @@ TEST_F(TieringCompactionPickerTest, PickCompaction_SelectsTierWithMarkedFile) {
   // 3. Assert
   ASSERT_NE(compaction, nullptr);
   ASSERT_EQ(compaction->start_level(), 2);
-  // Tiering 策略应该选择该层的所有文件
-  ASSERT_EQ(compaction->num_input_files(0), 3);
+  // 文件互不重叠，只选择包含被标记文件的 slice
+  ASSERT_EQ(compaction->num_input_files(0), 1);
+  ASSERT_EQ(compaction->input(0, 0)->fd.GetNumber(), 11);
   ASSERT_EQ(compaction->compaction_reason(), CompactionReason::kFilesMarkedForCompaction);
 }
 
+// --- key-range slice 的测试 ---
+
+// 测试：层内存在多个互不相交的 slice 时，优先选择文件最多的 slice
+TEST_F(TieringCompactionPickerTest, PickCompaction_PicksLargestSlice) {
+  // 1. Arrange
+  const int T = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  NewVersionStorage(6, kCompactionStyleTier);
+  // slice 1: [a,c] [b,d]
+  Add(1, 1, "a", "c");
+  Add(1, 2, "b", "d");
+  // slice 2: [m,p] [n,q] [o,r]
+  Add(1, 3, "m", "p");
+  Add(1, 4, "n", "q");
+  Add(1, 5, "o", "r");
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  std::unique_ptr<Compaction> compaction(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_EQ(compaction->start_level(), 1);
+  ASSERT_EQ(compaction->output_level(), 2);
+  ASSERT_EQ(compaction->num_input_files(0), 3);
+  ASSERT_EQ(compaction->input(0, 0)->fd.GetNumber(), 3);
+  ASSERT_EQ(compaction->input(0, 1)->fd.GetNumber(), 4);
+  ASSERT_EQ(compaction->input(0, 2)->fd.GetNumber(), 5);
+}
+
+// 测试：某个 slice 中有文件正在合并时，其他 slice 仍然可以被挑选
+TEST_F(TieringCompactionPickerTest, PickCompaction_SkipsBusySlice) {
+  // 1. Arrange
+  const int T = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  NewVersionStorage(6, kCompactionStyleTier);
+  // slice 1: [a,c] [b,d] [c,e]，其中文件 2 正在被合并
+  Add(1, 1, "a", "c");
+  Add(1, 2, "b", "d");
+  Add(1, 3, "c", "e");
+  // slice 2: [m,p] [n,q]
+  Add(1, 4, "m", "p");
+  Add(1, 5, "n", "q");
+  file_map_[2].first->being_compacted = true;
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  std::unique_ptr<Compaction> compaction(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_EQ(compaction->start_level(), 1);
+  ASSERT_EQ(compaction->num_input_files(0), 2);
+  ASSERT_EQ(compaction->input(0, 0)->fd.GetNumber(), 4);
+  ASSERT_EQ(compaction->input(0, 1)->fd.GetNumber(), 5);
+}
+
+// 测试：同一层的不同 slice 可以被并行挑选为多个 Compaction
+TEST_F(TieringCompactionPickerTest, PickCompaction_SlicesCompactInParallel) {
+  // 1. Arrange
+  const int T = 2;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  NewVersionStorage(6, kCompactionStyleTier);
+  // slice 1: [a,c] [b,d]
+  Add(1, 1, "a", "c");
+  Add(1, 2, "b", "d");
+  // slice 2: [m,p] [n,q]
+  Add(1, 3, "m", "p");
+  Add(1, 4, "n", "q");
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  std::unique_ptr<Compaction> c1(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+  ASSERT_NE(c1, nullptr);
+  ASSERT_TRUE(picker_->NeedsCompaction(vstorage_.get()));
+  std::unique_ptr<Compaction> c2(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  ASSERT_NE(c2, nullptr);
+  ASSERT_EQ(c1->num_input_files(0), 2);
+  ASSERT_EQ(c2->num_input_files(0), 2);
+  ASSERT_NE(c1->input(0, 0)->fd.GetNumber(), c2->input(0, 0)->fd.GetNumber());
+  picker_->ReleaseCompactionFiles(c1.get(), Status::OK());
+  picker_->ReleaseCompactionFiles(c2.get(), Status::OK());
+}
+
+// 测试：files_per_tier_per_level 覆盖单层的 T
+TEST_F(TieringCompactionPickerTest, PickCompaction_UsesPerLevelFilesPerTier) {
+  // 1. Arrange
+  mutable_cf_options_.compaction_options_tier.files_per_tier = 4;
+  // L1 的 T 为 2，其余层使用默认的 4（非正数也回退到默认值）
+  mutable_cf_options_.compaction_options_tier.files_per_tier_per_level = {0, 2};
+  NewVersionStorage(6, kCompactionStyleTier);
+  Add(0, 1, "a", "d");
+  Add(0, 2, "c", "f");
+  Add(0, 3, "e", "h");
+  Add(1, 4, "a", "d");
+  Add(1, 5, "c", "f");
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  std::unique_ptr<Compaction> compaction(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  // L0 只有 3 个文件不足 4 个，L1 有 2 个文件达到了它自己的 T
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_EQ(compaction->start_level(), 1);
+  ASSERT_EQ(compaction->num_input_files(0), 2);
+}
+
+// 测试：文件数不足 T，但本层大小达到下一层的 1/size_ratio 时触发合并
+TEST_F(TieringCompactionPickerTest, PickCompaction_TriggeredBySizeRatio) {
+  // 1. Arrange
+  mutable_cf_options_.compaction_options_tier.files_per_tier = 4;
+  mutable_cf_options_.compaction_options_tier.size_ratio = 4;
+  NewVersionStorage(6, kCompactionStyleTier);
+  // L1: 300 字节，L2: 1000 字节，300 * 4 >= 1000
+  Add(1, 1, "a", "d", 150);
+  Add(1, 2, "c", "f", 150);
+  Add(2, 3, "a", "z", 1000);
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  bool needs_compaction = picker_->NeedsCompaction(vstorage_.get());
+  std::unique_ptr<Compaction> compaction(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  ASSERT_TRUE(needs_compaction);
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_EQ(compaction->start_level(), 1);
+  ASSERT_EQ(compaction->output_level(), 2);
+}
+
+// 测试：lazy leveling 下合并进最后一层时，会带上最后一层中重叠的文件
+TEST_F(TieringCompactionPickerTest, PickCompaction_LazyLevelingMergesLastLevel) {
+  // 1. Arrange
+  const int T = 2;
+  const int kNumLevels = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  mutable_cf_options_.compaction_options_tier.lazy_leveling = true;
+  NewVersionStorage(kNumLevels, kCompactionStyleTier);
+  Add(1, 1, "c", "f", 1, 0, 300, 300);
+  Add(1, 2, "e", "h", 1, 0, 200, 200);
+  // 最后一层：[a,d] 与 slice 重叠，[g,j] 与 slice 重叠，[x,z] 不重叠
+  Add(2, 3, "a", "d", 1, 0, 100, 100);
+  Add(2, 4, "g", "j", 1, 0, 100, 100);
+  Add(2, 5, "x", "z", 1, 0, 100, 100);
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  std::unique_ptr<Compaction> compaction(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_EQ(compaction->output_level(), kNumLevels - 1);
+  ASSERT_EQ(compaction->num_input_levels(), 2u);
+  ASSERT_EQ(compaction->num_input_files(0), 2);
+  ASSERT_EQ(compaction->num_input_files(1), 2);
+  ASSERT_EQ(compaction->input(1, 0)->fd.GetNumber(), 3u);
+  ASSERT_EQ(compaction->input(1, 1)->fd.GetNumber(), 4u);
+}
+
+// 测试：lazy leveling 下，已有 compaction 正在往最后一层写入重叠的范围时，
+// 不能再把 slice 合并进最后一层
+TEST_F(TieringCompactionPickerTest, PickCompaction_LazyLevelingWaitsForRunningCompaction) {
+  // 1. Arrange
+  const int T = 2;
+  const int kNumLevels = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  mutable_cf_options_.compaction_options_tier.lazy_leveling = true;
+  NewVersionStorage(kNumLevels, kCompactionStyleTier);
+  Add(0, 1, "c", "h", 1, 0, 300, 300);
+  Add(1, 2, "d", "e", 1, 0, 200, 200);
+  Add(1, 3, "d", "f", 1, 0, 100, 100);
+  UpdateVersionStorageInfo();
+  // L0 的 [c,h] 通过 CompactFiles 直接写到最后一层，输出还没安装
+  std::unordered_set<uint64_t> input{1};
+  std::vector<CompactionInputFiles> input_files;
+  ASSERT_OK(picker_->GetCompactionInputsFromFileNumbers(
+      &input_files, &input, vstorage_.get(), CompactionOptions()));
+  std::unique_ptr<Compaction> running(picker_->PickCompactionForCompactFiles(
+      CompactionOptions(), input_files, kNumLevels - 1, vstorage_.get(),
+      mutable_cf_options_, mutable_db_options_, /*output_path_id=*/0));
+  ASSERT_NE(running, nullptr);
+  picker_->RegisterCompaction(running.get());
+
+  // 2. Act
+  std::unique_ptr<Compaction> blocked(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+  picker_->ReleaseCompactionFiles(running.get(), Status::OK());
+  std::unique_ptr<Compaction> compaction(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  ASSERT_EQ(blocked, nullptr);
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_EQ(compaction->start_level(), 1);
+  ASSERT_EQ(compaction->output_level(), kNumLevels - 1);
+  ASSERT_EQ(compaction->num_input_files(0), 2);
+}
+
+// --- trivial move 的测试 ---
+
+// 测试：层内文件两两不重叠时，整层直接移动到下一层，不需要重写
+TEST_F(TieringCompactionPickerTest, PickCompaction_TrivialMovesDisjointFiles) {
+  // 1. Arrange
+  const int T = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  NewVersionStorage(6, kCompactionStyleTier);
+  // 顺序写入产生的文件，key range 互不重叠
+  Add(1, 1, "a", "b");
+  Add(1, 2, "c", "d");
+  Add(1, 3, "e", "f");
+  // 下一层的文件与之重叠也不影响移动
+  Add(2, 4, "a", "z");
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  std::unique_ptr<Compaction> compaction(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_TRUE(compaction->is_trivial_move());
+  ASSERT_EQ(compaction->start_level(), 1);
+  ASSERT_EQ(compaction->output_level(), 2);
+  ASSERT_EQ(compaction->num_input_levels(), 1u);
+  ASSERT_EQ(compaction->num_input_files(0), 3);
+}
+
+// 测试：不重叠的文件先被移动，剩下互相重叠的文件再单独合并
+TEST_F(TieringCompactionPickerTest, PickCompaction_MovesDisjointThenMergesRest) {
+  // 1. Arrange
+  const int T = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  NewVersionStorage(6, kCompactionStyleTier);
+  Add(1, 1, "a", "b");
+  Add(1, 2, "m", "p");
+  Add(1, 3, "n", "q");
+  Add(1, 4, "o", "r");
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  std::unique_ptr<Compaction> c1(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+  std::unique_ptr<Compaction> c2(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  ASSERT_NE(c1, nullptr);
+  ASSERT_TRUE(c1->is_trivial_move());
+  ASSERT_EQ(c1->num_input_files(0), 1);
+  ASSERT_EQ(c1->input(0, 0)->fd.GetNumber(), 1u);
+  ASSERT_NE(c2, nullptr);
+  ASSERT_FALSE(c2->is_trivial_move());
+  ASSERT_EQ(c2->num_input_files(0), 3);
+  picker_->ReleaseCompactionFiles(c1.get(), Status::OK());
+  picker_->ReleaseCompactionFiles(c2.get(), Status::OK());
+}
+
+// 测试：lazy leveling 下，与最后一层重叠的文件不能直接移动进最后一层
+TEST_F(TieringCompactionPickerTest, PickCompaction_NoTrivialMoveIntoLeveledLastLevel) {
+  // 1. Arrange
+  const int T = 2;
+  const int kNumLevels = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  mutable_cf_options_.compaction_options_tier.lazy_leveling = true;
+  NewVersionStorage(kNumLevels, kCompactionStyleTier);
+  Add(1, 1, "a", "b", 1, 0, 200, 200);
+  Add(1, 2, "c", "d", 1, 0, 200, 200);
+  Add(2, 3, "c", "z", 1, 0, 100, 100);
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  std::unique_ptr<Compaction> compaction(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  // 只有 [a,b] 能移动，[c,d] 要和最后一层的 [c,z] 一起合并
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_TRUE(compaction->is_trivial_move());
+  ASSERT_EQ(compaction->num_input_files(0), 1);
+  ASSERT_EQ(compaction->input(0, 0)->fd.GetNumber(), 1u);
+}
+
+// 测试：lazy leveling 下，与正在写入最后一层的 compaction 范围重叠的文件
+// 也不能直接移动进最后一层
+TEST_F(TieringCompactionPickerTest, PickCompaction_NoTrivialMoveOverlappingRunningCompaction) {
+  // 1. Arrange
+  const int T = 2;
+  const int kNumLevels = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  mutable_cf_options_.compaction_options_tier.lazy_leveling = true;
+  NewVersionStorage(kNumLevels, kCompactionStyleTier);
+  Add(0, 1, "c", "h", 1, 0, 300, 300);
+  Add(1, 2, "a", "b", 1, 0, 200, 200);
+  Add(1, 3, "d", "e", 1, 0, 200, 200);
+  UpdateVersionStorageInfo();
+  // L0 的 [c,h] 通过 CompactFiles 直接写到最后一层，输出还没安装
+  std::unordered_set<uint64_t> input{1};
+  std::vector<CompactionInputFiles> input_files;
+  ASSERT_OK(picker_->GetCompactionInputsFromFileNumbers(
+      &input_files, &input, vstorage_.get(), CompactionOptions()));
+  std::unique_ptr<Compaction> running(picker_->PickCompactionForCompactFiles(
+      CompactionOptions(), input_files, kNumLevels - 1, vstorage_.get(),
+      mutable_cf_options_, mutable_db_options_, /*output_path_id=*/0));
+  ASSERT_NE(running, nullptr);
+  picker_->RegisterCompaction(running.get());
+
+  // 2. Act
+  std::unique_ptr<Compaction> compaction(picker_->PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, {}, nullptr,
+      vstorage_.get(), &log_buffer_));
+
+  // 3. Assert
+  // 只有 [a,b] 能移动，[d,e] 落在正在写入的 [c,h] 里
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_TRUE(compaction->is_trivial_move());
+  ASSERT_EQ(compaction->num_input_files(0), 1);
+  ASSERT_EQ(compaction->input(0, 0)->fd.GetNumber(), 2u);
+  picker_->ReleaseCompactionFiles(compaction.get(), Status::OK());
+  picker_->ReleaseCompactionFiles(running.get(), Status::OK());
+}
+
+// --- TierSortedRuns() 的测试 ---
+
+// 测试：同一层内互不重叠的文件被归入同一个 sorted run，重叠的文件分到不同 run
+TEST_F(TieringCompactionPickerTest, TierSortedRuns_GroupsNonOverlappingFiles) {
+  // 1. Arrange
+  const int T = 5;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  NewVersionStorage(6, kCompactionStyleTier);
+  // 第一个 run: [a,c] [d,f] [g,i]
+  Add(1, 1, "a", "c", 1, 0, 100, 100);
+  Add(1, 2, "d", "f", 1, 0, 100, 100);
+  Add(1, 3, "g", "i", 1, 0, 100, 100);
+  // 第二个 run: [b,e] [h,k]，与第一个 run 重叠
+  Add(1, 4, "b", "e", 1, 0, 200, 200);
+  Add(1, 5, "h", "k", 1, 0, 200, 200);
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  const auto& runs = vstorage_->TierSortedRuns(1);
+
+  // 3. Assert
+  ASSERT_EQ(runs.size(), 2);
+  size_t total_files = 0;
+  for (const auto& run : runs) {
+    total_files += run.num_files;
+    // run 内的文件按 key 有序且互不重叠
+    for (size_t i = 1; i < run.num_files; i++) {
+      ASSERT_LT(ucmp_->Compare(ExtractUserKey(run.files[i - 1].largest_key),
+                               ExtractUserKey(run.files[i].smallest_key)),
+                0);
+    }
+  }
+  ASSERT_EQ(total_files, 5);
+}
+
+// --- EstimateCompactionBytesNeeded() 的测试 ---
+
+// 测试：没有任何层级达到阈值 T 时，compaction 债务为 0
+TEST_F(TieringCompactionPickerTest, EstimateCompactionBytesNeeded_BelowThreshold) {
+  // 1. Arrange
+  const int T = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  NewVersionStorage(6, kCompactionStyleTier);
+  Add(0, 1, "a", "b", 100);
+  Add(0, 2, "c", "d", 100);
+  Add(1, 3, "a", "z", 1000);
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  uint64_t needed_bytes = vstorage_->estimated_compaction_needed_bytes();
+
+  // 3. Assert
+  ASSERT_EQ(needed_bytes, 0u);
+}
+
+// 测试：L0 满了之后合并到 L1，使 L1 也达到阈值，两层的字节数都计入债务
+TEST_F(TieringCompactionPickerTest, EstimateCompactionBytesNeeded_Cascade) {
+  // 1. Arrange
+  const int T = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  NewVersionStorage(6, kCompactionStyleTier);
+  // L0 满: 300 字节，合并后作为一个新文件落到 L1
+  Add(0, 1, "a", "b", 100, 0, 500, 500);
+  Add(0, 2, "c", "d", 100, 0, 400, 400);
+  Add(0, 3, "e", "f", 100, 0, 300, 300);
+  // L1 还差一个文件就满
+  Add(1, 4, "a", "m", 200, 0, 200, 200);
+  Add(1, 5, "n", "z", 200, 0, 100, 100);
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  uint64_t needed_bytes = vstorage_->estimated_compaction_needed_bytes();
+
+  // 3. Assert
+  // L0: 300，L1: 400 + 300，L2 只收到一个新文件，不再触发
+  ASSERT_EQ(needed_bytes, 1000u);
+}
+
+// 测试：合并输出按 target file size 切成多个文件时，会一路级联到最后的输入层
+TEST_F(TieringCompactionPickerTest, EstimateCompactionBytesNeeded_FanOut) {
+  // 1. Arrange
+  const int T = 3;
+  mutable_cf_options_.compaction_options_tier.files_per_tier = T;
+  mutable_cf_options_.target_file_size_base = 100;
+  mutable_cf_options_.target_file_size_multiplier = 1;
+  mutable_cf_options_.RefreshDerivedOptions(ioptions_);
+  NewVersionStorage(6, kCompactionStyleTier);
+  Add(0, 1, "a", "b", 100, 0, 300, 300);
+  Add(0, 2, "c", "d", 100, 0, 200, 200);
+  Add(0, 3, "e", "f", 100, 0, 100, 100);
+  UpdateVersionStorageInfo();
+
+  // 2. Act
+  uint64_t needed_bytes = vstorage_->estimated_compaction_needed_bytes();
+
+  // 3. Assert
+  // 每层都收到 3 个文件，L0 到 L4 各重写一次 300 字节
+  ASSERT_EQ(needed_bytes, 5 * 300u);
+}
+
 } // namespace ROCKSDB NAMESPACE
 
 int main(int argc, char** argv) {
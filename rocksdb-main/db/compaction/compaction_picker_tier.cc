@@ -9,12 +9,14 @@
 
 #include "db/compaction/compaction_picker_tier.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "db/version_edit.h"
 #include "logging/log_buffer.h"
+#include "logging/logging.h"
 #include "test_util/sync_point.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -114,8 +116,17 @@ class TierCompactionBuilder {
   // function will return false.
   bool PickFileToCompact();
 
-  // Return true if a L0 trivial move is picked up.
-  bool TryPickL0TrivialMove();
+  // add for tier compaction style
+  // Picks every file of `start_level_` that overlaps no other file of the
+  // level (a slice of one file) into `compaction_inputs_`, so that they can
+  // be re-linked into `output_level_` instead of being rewritten. The
+  // overlapping slices are left for a regular merge.
+  // No older run overlapping a moved file stays behind in `start_level_`, and
+  // the moved files take the newest epoch number of `output_level_` (see
+  // Compaction::OutputEpochNumber()), so they are searched before every file
+  // already there.
+  // Return true if a trivial move is picked up.
+  bool TryPickTrivialMove();
 
   // For L0->L0, picks the longest span of files that aren't currently
   // undergoing compaction for which work-per-deleted-file decreases. The span
@@ -151,8 +162,41 @@ class TierCompactionBuilder {
       const autovector<std::pair<int, FileMetaData*>>& level_files,
       CompactToNextLevel compact_to_next_level);
 
-  // 判断是否为 trivial move
-  bool CheckTrivialMove(const std::vector<CompactionInputFiles>& inputs);
+  // 判断是否为 trivial move：输入只有一层，文件两两不重叠，且都在输出层的
+  // path 上；lazy leveling 下移入最后一层的文件还不能与最后一层（包括正在
+  // 写入最后一层的 compaction）重叠
+  bool CheckTrivialMove(const std::vector<CompactionInputFiles>& inputs) const;
+
+  // Returns true if `f` overlaps any file of `level` in user key space.
+  bool OverlapsLevel(const FileMetaData* f, int level) const;
+
+  // Returns true if `f` overlaps a file of the last level, or the output range
+  // of a compaction still writing into it. Such a file cannot be moved into a
+  // lazy-leveled last level without breaking its single sorted run.
+  bool OverlapsLastLevel(const FileMetaData* f) const;
+
+  // add for tier compaction style
+  // Splits the files of `level` into key-range slices, i.e. groups of files
+  // whose ranges chain-overlap. Slices are disjoint in key space, so each one
+  // can be merged into the next level on its own and in parallel with the
+  // others. Files inside a slice keep their order in the level.
+  std::vector<std::vector<FileMetaData*>> PartitionTierIntoSlices(
+      int level) const;
+
+  // Picks one slice of `start_level_` without files being compacted into
+  // `compaction_inputs_`. With `prefer_marked` the slice must contain a file
+  // marked for compaction, otherwise the slice with the most files wins.
+  // Returns false if every candidate slice is busy.
+  bool PickTierSlice(bool prefer_marked);
+
+  // add for tier compaction style
+  // Lazy leveling: adds every file of the last level whose range overlaps the
+  // picked slice, directly or through another such file, to
+  // `compaction_inputs_`, so that the last level stays one sorted run. Files
+  // of `start_level_` that fall into the widened range join as well. Returns
+  // false if one of those files is being compacted, or if a running
+  // compaction into the last level overlaps the widened range.
+  bool SetupLastLevelInputs();
 
   const std::string& cf_name_;
   VersionStorageInfo* vstorage_;
@@ -165,6 +209,7 @@ class TierCompactionBuilder {
   int base_index_ = -1;
   double start_level_score_ = 0;
   bool is_l0_trivial_move_ = false;
+  bool is_trivial_move_ = false;
   CompactionInputFiles start_level_inputs_;
   // CompactionInputFiles 中存储了每个 level 的 filemetadata
   std::vector<CompactionInputFiles> compaction_inputs_;
@@ -189,23 +234,13 @@ class TierCompactionBuilder {
 // 构造 Compaction对象
 // add for tier compaction style
 Compaction* TierCompactionBuilder::PickCompaction() {
-    const int T = mutable_cf_options_.compaction_options_tier.files_per_tier;
-
     for (int level = 0; level < vstorage_->num_levels() - 1; ++level) {
         const auto& level_files = vstorage_->LevelFiles(level);
         bool triggered_by_size = false;
         bool triggered_by_mark = false;
-        // 检查文件数量是否达到阈值 T
-        if (T > 0) {
-            size_t num_non_compacting_files = 0;
-            for (const auto* f : level_files) {
-                if (!f->being_compacted) {
-                    num_non_compacting_files++;
-                }
-            }
-            if (num_non_compacting_files >= static_cast<size_t>(T)) {
-                triggered_by_size = true;
-            }
+        // 检查文件数量是否达到该层的阈值 T（或 size ratio 触发）
+        if (vstorage_->TierLevelScore(level, mutable_cf_options_) >= 1) {
+            triggered_by_size = true;
         }
         // 2. 检查是否有文件被标记
         if (!triggered_by_size) {
@@ -219,21 +254,22 @@ Compaction* TierCompactionBuilder::PickCompaction() {
         if (triggered_by_size || triggered_by_mark) {
             start_level_ = level;
             output_level_ = start_level_ + 1;
-            compaction_inputs_.resize(1);
-            compaction_inputs_[0].level = start_level_;
-
-            // 检查该层是否有任何文件正在被合并，如果有，则不能选择这一层
-            bool is_busy = false;
-            for (FileMetaData* file : level_files) {
-                if (file->being_compacted) {
-                    is_busy = true;
-                    break;
-                }
-                compaction_inputs_[0].files.emplace_back(file);
-            }
 
-            if (is_busy) {
-                compaction_inputs_.clear();
+            // 与其他文件都不重叠的文件直接移动到下一层，不需要重写
+            if (triggered_by_size && TryPickTrivialMove()) {
+                compaction_reason_ = CompactionReason::kLevelFilesNum;
+                Compaction* c = GetCompaction();
+                TEST_SYNC_POINT_CALLBACK("TierCompactionPicker::PickCompaction:Return", c);
+                return c;
+            }
+            // 只挑选不含正在合并文件的 key-range slice，忙碌的 slice 不再阻塞整层
+            if (!PickTierSlice(!triggered_by_size)) {
+                continue;
+            }
+            // lazy leveling: 最后一层保持为一个 sorted run
+            if (mutable_cf_options_.compaction_options_tier.lazy_leveling &&
+                output_level_ == vstorage_->num_levels() - 1 &&
+                !SetupLastLevelInputs()) {
                 continue;
             }
             // 设置一下原因
@@ -248,6 +284,258 @@ Compaction* TierCompactionBuilder::PickCompaction() {
     return nullptr;
 }
 
+std::vector<std::vector<FileMetaData*>>
+TierCompactionBuilder::PartitionTierIntoSlices(int level) const {
+  const std::vector<FileMetaData*>& level_files = vstorage_->LevelFiles(level);
+  const Comparator* ucmp = vstorage_->user_comparator();
+  const InternalKeyComparator* icmp = vstorage_->InternalComparator();
+
+  std::vector<size_t> by_key(level_files.size());
+  for (size_t i = 0; i < by_key.size(); i++) {
+    by_key[i] = i;
+  }
+  std::sort(by_key.begin(), by_key.end(), [&](size_t a, size_t b) {
+    return icmp->Compare(level_files[a]->smallest, level_files[b]->smallest) <
+           0;
+  });
+
+  // Sweep the files in key order; a new slice starts whenever a file begins
+  // after the largest user key seen so far. Files sharing a boundary user key
+  // stay in one slice so that no user key is split across compactions.
+  std::vector<size_t> slice_of(level_files.size());
+  size_t num_slices = 0;
+  Slice slice_largest;
+  for (size_t idx : by_key) {
+    const FileMetaData* f = level_files[idx];
+    if (num_slices == 0 ||
+        ucmp->CompareWithoutTimestamp(f->smallest.user_key(), slice_largest) >
+            0) {
+      num_slices++;
+      slice_largest = f->largest.user_key();
+    } else if (ucmp->CompareWithoutTimestamp(f->largest.user_key(),
+                                             slice_largest) > 0) {
+      slice_largest = f->largest.user_key();
+    }
+    slice_of[idx] = num_slices - 1;
+  }
+
+  std::vector<std::vector<FileMetaData*>> slices(num_slices);
+  for (size_t i = 0; i < level_files.size(); i++) {
+    slices[slice_of[i]].push_back(level_files[i]);
+  }
+  return slices;
+}
+
+bool TierCompactionBuilder::PickTierSlice(bool prefer_marked) {
+  std::vector<std::vector<FileMetaData*>> slices =
+      PartitionTierIntoSlices(start_level_);
+  const std::vector<FileMetaData*>* picked = nullptr;
+  for (const auto& slice : slices) {
+    bool is_busy = false;
+    bool has_marked = false;
+    for (const FileMetaData* f : slice) {
+      if (f->being_compacted) {
+        is_busy = true;
+        break;
+      }
+      has_marked = has_marked || f->marked_for_compaction;
+    }
+    if (is_busy || (prefer_marked && !has_marked)) {
+      continue;
+    }
+    if (picked == nullptr || slice.size() > picked->size()) {
+      picked = &slice;
+    }
+  }
+  if (picked == nullptr) {
+    ROCKS_LOG_BUFFER(log_buffer_,
+                     "[%s] Tier: every slice of level %d is being compacted\n",
+                     cf_name_.c_str(), start_level_);
+    return false;
+  }
+
+  compaction_inputs_.resize(1);
+  compaction_inputs_[0].level = start_level_;
+  compaction_inputs_[0].files = *picked;
+  ROCKS_LOG_BUFFER(log_buffer_,
+                   "[%s] Tier: picked slice of %" ROCKSDB_PRIszt
+                   " files out of %" ROCKSDB_PRIszt " slices in level %d\n",
+                   cf_name_.c_str(), picked->size(), slices.size(),
+                   start_level_);
+  return true;
+}
+
+bool TierCompactionBuilder::OverlapsLevel(const FileMetaData* f,
+                                          int level) const {
+  const Comparator* ucmp = vstorage_->user_comparator();
+  for (const FileMetaData* other : vstorage_->LevelFiles(level)) {
+    if (other != f &&
+        ucmp->CompareWithoutTimestamp(other->largest.user_key(),
+                                      f->smallest.user_key()) >= 0 &&
+        ucmp->CompareWithoutTimestamp(other->smallest.user_key(),
+                                      f->largest.user_key()) <= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TierCompactionBuilder::OverlapsLastLevel(const FileMetaData* f) const {
+  return OverlapsLevel(f, output_level_) ||
+         compaction_picker_->RangeOverlapWithCompaction(
+             f->smallest.user_key(), f->largest.user_key(), output_level_);
+}
+
+bool TierCompactionBuilder::CheckTrivialMove(
+    const std::vector<CompactionInputFiles>& inputs) const {
+  if (inputs.size() != 1 || inputs[0].empty()) {
+    return false;
+  }
+  const uint32_t output_path_id =
+      GetPathId(ioptions_, mutable_cf_options_, output_level_);
+  const bool into_leveled_last_level =
+      mutable_cf_options_.compaction_options_tier.lazy_leveling &&
+      output_level_ == vstorage_->num_levels() - 1;
+  for (const FileMetaData* f : inputs[0].files) {
+    if (f->fd.GetPathId() != output_path_id) {
+      return false;
+    }
+    if (OverlapsLevel(f, inputs[0].level)) {
+      return false;
+    }
+    if (into_leveled_last_level && OverlapsLastLevel(f)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TierCompactionBuilder::TryPickTrivialMove() {
+  const bool into_leveled_last_level =
+      mutable_cf_options_.compaction_options_tier.lazy_leveling &&
+      output_level_ == vstorage_->num_levels() - 1;
+
+  CompactionInputFiles inputs;
+  inputs.level = start_level_;
+  for (const auto& slice : PartitionTierIntoSlices(start_level_)) {
+    if (slice.size() != 1) {
+      continue;
+    }
+    FileMetaData* f = slice[0];
+    // 单文件的 slice 与本层其他文件都不重叠，移走后本层不会留下比它旧的
+    // 重叠 run；输出层中与它重叠的文件都更旧，它拿到新的 epoch 后排在最前
+    // 被标记的文件需要真正重写一遍
+    if (f->being_compacted || f->marked_for_compaction) {
+      continue;
+    }
+    if (into_leveled_last_level && OverlapsLastLevel(f)) {
+      continue;
+    }
+    inputs.files.push_back(f);
+  }
+  if (inputs.empty()) {
+    return false;
+  }
+
+  std::vector<CompactionInputFiles> candidate{inputs};
+  if (!CheckTrivialMove(candidate)) {
+    return false;
+  }
+  compaction_inputs_ = std::move(candidate);
+  is_trivial_move_ = true;
+  is_l0_trivial_move_ = start_level_ == 0;
+  ROCKS_LOG_BUFFER(log_buffer_,
+                   "[%s] Tier: trivially moving %" ROCKSDB_PRIszt
+                   " files from level %d to level %d\n",
+                   cf_name_.c_str(), compaction_inputs_[0].size(),
+                   start_level_, output_level_);
+  return true;
+}
+
+bool TierCompactionBuilder::SetupLastLevelInputs() {
+  assert(compaction_inputs_.size() == 1);
+  const Comparator* ucmp = vstorage_->user_comparator();
+  const std::vector<FileMetaData*>& slice = compaction_inputs_[0].files;
+  assert(!slice.empty());
+  Slice smallest = slice[0]->smallest.user_key();
+  Slice largest = slice[0]->largest.user_key();
+  for (const FileMetaData* f : slice) {
+    if (ucmp->CompareWithoutTimestamp(f->smallest.user_key(), smallest) < 0) {
+      smallest = f->smallest.user_key();
+    }
+    if (ucmp->CompareWithoutTimestamp(f->largest.user_key(), largest) > 0) {
+      largest = f->largest.user_key();
+    }
+  }
+
+  // 把与 [smallest, largest] 重叠的文件加入 inputs，并扩大范围。
+  // 范围扩大后可能又覆盖了起始层其他 slice 的文件，它们必须一起合并，
+  // 否则这些 key 的旧版本会以更大的 seqno 落到最后一层，读到旧值。
+  const int levels[2] = {start_level_, output_level_};
+  std::vector<bool> picked[2];
+  CompactionInputFiles inputs[2];
+  for (int i = 0; i < 2; i++) {
+    picked[i].assign(vstorage_->LevelFiles(levels[i]).size(), false);
+    inputs[i].level = levels[i];
+  }
+  bool expanded = true;
+  while (expanded) {
+    expanded = false;
+    for (int i = 0; i < 2; i++) {
+      const std::vector<FileMetaData*>& level_files =
+          vstorage_->LevelFiles(levels[i]);
+      for (size_t j = 0; j < level_files.size(); j++) {
+        FileMetaData* f = level_files[j];
+        if (picked[i][j] ||
+            ucmp->CompareWithoutTimestamp(f->largest.user_key(), smallest) <
+                0 ||
+            ucmp->CompareWithoutTimestamp(f->smallest.user_key(), largest) >
+                0) {
+          continue;
+        }
+        if (f->being_compacted) {
+          ROCKS_LOG_BUFFER(log_buffer_,
+                           "[%s] Tier: file %" PRIu64
+                           " of level %d overlapping the merge into the last "
+                           "level is being compacted\n",
+                           cf_name_.c_str(), f->fd.GetNumber(), levels[i]);
+          return false;
+        }
+        picked[i][j] = true;
+        inputs[i].files.push_back(f);
+        if (ucmp->CompareWithoutTimestamp(f->smallest.user_key(), smallest) <
+            0) {
+          smallest = f->smallest.user_key();
+          expanded = true;
+        }
+        if (ucmp->CompareWithoutTimestamp(f->largest.user_key(), largest) > 0) {
+          largest = f->largest.user_key();
+          expanded = true;
+        }
+      }
+    }
+  }
+
+  // 正在写入最后一层的 compaction（例如 CompactFiles 从别的层写过来的）
+  // 的输出文件还没安装，上面的 being_compacted 检查看不到它们，
+  // 范围重叠时合并出来的文件会和它的输出在最后一层互相重叠
+  if (compaction_picker_->RangeOverlapWithCompaction(smallest, largest,
+                                                     output_level_)) {
+    ROCKS_LOG_BUFFER(log_buffer_,
+                     "[%s] Tier: a running compaction into the last level "
+                     "overlaps the merge range\n",
+                     cf_name_.c_str());
+    return false;
+  }
+
+  compaction_inputs_.clear();
+  compaction_inputs_.push_back(std::move(inputs[0]));
+  if (!inputs[1].empty()) {
+    compaction_inputs_.push_back(std::move(inputs[1]));
+  }
+  return true;
+}
+
 Compaction* TierCompactionBuilder::GetCompaction() {
   assert(!compaction_inputs_.empty());
   bool l0_files_might_overlap =
@@ -270,6 +558,8 @@ Compaction* TierCompactionBuilder::GetCompaction() {
       compaction_reason_,
       /* trim_ts */ "", start_level_score_, l0_files_might_overlap);
 
+  c->set_is_trivial_move(is_trivial_move_);
+
   // If it's level 0 compaction, make sure we don't execute any other level 0
   // compactions in parallel
   compaction_picker_->RegisterCompaction(c);
@@ -22,6 +22,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -256,6 +257,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
   periodic_task_functions_.emplace(
       PeriodicTaskType::kTriggerCompaction,
       [this]() { this->TriggerPeriodicCompaction(); });
+  periodic_task_functions_.emplace(PeriodicTaskType::kAutoTune,
+                                   [this]() { this->AutoTune(); });
 
   versions_.reset(new VersionSet(
       dbname_, &immutable_db_options_, file_options_, table_cache_.get(),
@@ -874,6 +877,36 @@ Status DBImpl::RegisterRecordSeqnoTimeWorker() {
   return s;
 }
 
+Status DBImpl::RegisterAutoTuneWorker() {
+  options_mutex_.AssertHeld();
+  if (immutable_db_options_.auto_tune_period_sec == 0) {
+    return Status::OK();
+  }
+  {
+    InstrumentedMutexLock l(&mutex_);
+    const uint64_t write_buffer_size =
+        default_cf_handle_->cfd()->GetLatestMutableCFOptions().write_buffer_size;
+    int max_background_jobs =
+        immutable_db_options_.auto_tune_max_background_jobs;
+    if (max_background_jobs <= 0) {
+      max_background_jobs =
+          static_cast<int>(std::thread::hardware_concurrency());
+    }
+    uint64_t max_write_buffer_size =
+        immutable_db_options_.auto_tune_max_write_buffer_size;
+    if (max_write_buffer_size == 0) {
+      max_write_buffer_size = 8 * write_buffer_size;
+    }
+    auto_tuner_.reset(new AutoTuner(max_background_jobs, write_buffer_size,
+                                    max_write_buffer_size));
+  }
+  return periodic_task_scheduler_.Register(
+      PeriodicTaskType::kAutoTune,
+      periodic_task_functions_.at(PeriodicTaskType::kAutoTune),
+      immutable_db_options_.auto_tune_period_sec,
+      /*run_immediately=*/true);
+}
+
 Status DBImpl::CancelPeriodicTaskScheduler() {
   Status s = Status::OK();
   for (uint8_t task_type = 0;
@@ -6847,6 +6880,121 @@ void DBImpl::TriggerPeriodicCompaction() {
   }
 }
 
+void DBImpl::AutoTune() {
+  if (shutdown_initiated_ || auto_tuner_ == nullptr) {
+    return;
+  }
+  TEST_SYNC_POINT("DBImpl::AutoTune:StartRunning");
+  ColumnFamilyData* cfd = default_cf_handle_->cfd();
+  AutoTuneSample sample;
+  bool level_style = false;
+  int level0_file_num_compaction_trigger = 0;
+  int min_write_buffer_number_to_merge = 0;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    const MutableCFOptions& cf_options = cfd->GetLatestMutableCFOptions();
+    const InternalStats::CompactionStats& l0_stats =
+        cfd->internal_stats()->GetCompactionStats(0);
+    const VersionStorageInfo* vstorage = cfd->current()->storage_info();
+    sample.now_micros = immutable_db_options_.clock->NowMicros();
+    sample.bytes_written = default_cf_internal_stats_->GetDBStats(
+        InternalStats::kIntStatsBytesWritten);
+    sample.flush_count = static_cast<uint64_t>(
+        l0_stats.counts[static_cast<int>(CompactionReason::kFlush)]);
+    sample.flush_bytes = l0_stats.bytes_written;
+    sample.flush_micros = l0_stats.micros;
+    sample.num_immutable_memtables =
+        static_cast<int>(cfd->imm()->NumNotFlushed());
+    sample.num_l0_files = vstorage->NumLevelFiles(0);
+    sample.estimated_pending_compaction_bytes =
+        vstorage->estimated_compaction_needed_bytes();
+    sample.max_background_jobs = mutable_db_options_.max_background_jobs;
+    sample.write_buffer_size = cf_options.write_buffer_size;
+    sample.level0_slowdown_writes_trigger =
+        cf_options.level0_slowdown_writes_trigger;
+    sample.soft_pending_compaction_bytes_limit =
+        cf_options.soft_pending_compaction_bytes_limit;
+    level_style = cfd->ioptions().compaction_style == kCompactionStyleLevel;
+    level0_file_num_compaction_trigger =
+        cf_options.level0_file_num_compaction_trigger;
+    min_write_buffer_number_to_merge =
+        cfd->ioptions().min_write_buffer_number_to_merge;
+  }
+  TEST_SYNC_POINT_CALLBACK("DBImpl::AutoTune:Sample", &sample);
+
+  AutoTuner::Decision decision;
+  if (!auto_tuner_->Tick(sample, &decision)) {
+    return;
+  }
+  const AutoTuner::Scores& scores = auto_tuner_->last_scores();
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "[AutoTune] flush speed %.2f (max %.2f) B/us, %d immutable "
+                 "memtables, L0 ratio %.2f, pending bytes ratio %.2f: "
+                 "max_background_jobs %d -> %d, write_buffer_size %" PRIu64
+                 " -> %" PRIu64,
+                 scores.flush_speed, auto_tuner_->max_flush_speed(),
+                 scores.immutable_number, scores.l0_ratio,
+                 scores.pending_bytes_ratio, sample.max_background_jobs,
+                 decision.max_background_jobs, sample.write_buffer_size,
+                 decision.write_buffer_size);
+
+  Status s;
+  if (decision.max_background_jobs != sample.max_background_jobs) {
+    s = SetMaxBackgroundJobsForAutoTune(decision.max_background_jobs);
+  }
+  if (s.ok() && decision.write_buffer_size != sample.write_buffer_size) {
+    const uint64_t write_buffer_size = decision.write_buffer_size;
+    std::unordered_map<std::string, std::string> cf_options = {
+        {"write_buffer_size", std::to_string(write_buffer_size)}};
+    if (level_style) {
+      // SST 的大小与 memtable 保持一致，L1 容纳一轮 L0 compaction 的数据
+      cf_options.emplace("target_file_size_base",
+                         std::to_string(write_buffer_size));
+      cf_options.emplace(
+          "max_bytes_for_level_base",
+          std::to_string(static_cast<uint64_t>(
+                             std::max(level0_file_num_compaction_trigger, 1)) *
+                         std::max(min_write_buffer_number_to_merge, 1) *
+                         write_buffer_size));
+    }
+    s = SetOptions(default_cf_handle_, cf_options);
+  }
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "[AutoTune] failed to apply the new options: %s",
+                   s.ToString().c_str());
+  }
+}
+
+Status DBImpl::SetMaxBackgroundJobsForAutoTune(int max_background_jobs) {
+  InstrumentedMutexLock ol(&options_mutex_);
+  InstrumentedMutexLock l(&mutex_);
+  if (mutable_db_options_.max_background_jobs == max_background_jobs) {
+    return Status::OK();
+  }
+  const BGJobLimits current_bg_job_limits =
+      GetBGJobLimits(mutable_db_options_.max_background_flushes,
+                     mutable_db_options_.max_background_compactions,
+                     mutable_db_options_.max_background_jobs,
+                     /* parallelize_compactions */ true);
+  const BGJobLimits new_bg_job_limits =
+      GetBGJobLimits(mutable_db_options_.max_background_flushes,
+                     mutable_db_options_.max_background_compactions,
+                     max_background_jobs, /* parallelize_compactions */ true);
+  mutable_db_options_.max_background_jobs = max_background_jobs;
+  if (new_bg_job_limits.max_flushes > current_bg_job_limits.max_flushes) {
+    env_->IncBackgroundThreadsIfNeeded(new_bg_job_limits.max_flushes,
+                                       Env::Priority::HIGH);
+  }
+  if (new_bg_job_limits.max_compactions >
+      current_bg_job_limits.max_compactions) {
+    env_->IncBackgroundThreadsIfNeeded(new_bg_job_limits.max_compactions,
+                                       Env::Priority::LOW);
+  }
+  MaybeScheduleFlushOrCompaction();
+  return WriteOptionsFile(WriteOptions(), true /*db_mutex_already_held*/);
+}
+
 void DBImpl::TrackOrUntrackFiles(
     const std::vector<std::string>& existing_data_files, bool track) {
   auto sfm = static_cast_with_check<SstFileManagerImpl>(
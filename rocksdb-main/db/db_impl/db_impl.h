@@ -21,6 +21,7 @@
 #include <utility>
 #include <vector>
 
+#include "db/auto_tuner.h"
 #include "db/column_family.h"
 #include "db/compaction/compaction_iterator.h"
 #include "db/compaction/compaction_job.h"
@@ -1288,6 +1289,16 @@ class DBImpl : public DB {
   // periodically.
   void TriggerPeriodicCompaction();
 
+  // add for ADOC tuner
+  // Samples the write path of the default column family and applies what
+  // the AutoTuner decides. Runs every auto_tune_period_sec.
+  void AutoTune();
+
+  // Sets max_background_jobs without going through SetDBOptions(), which
+  // (un)registers periodic tasks and so must not be called from one.
+  // REQUIRES: options_mutex_ not held
+  Status SetMaxBackgroundJobsForAutoTune(int max_background_jobs);
+
   // REQUIRES: DB mutex held
   std::pair<SequenceNumber, uint64_t> GetSeqnoToTimeSample() const;
 
@@ -2494,6 +2505,9 @@ class DBImpl : public DB {
 
   Status RegisterRecordSeqnoTimeWorker();
 
+  // add for ADOC tuner
+  Status RegisterAutoTuneWorker();
+
   void PrintStatistics();
 
   size_t EstimateInMemoryStatsHistorySize() const;
@@ -3119,6 +3133,11 @@ class DBImpl : public DB {
   // It contains the implementations for each periodic task.
   std::map<PeriodicTaskType, const PeriodicTaskFunc> periodic_task_functions_;
 
+  // add for ADOC tuner
+  // Only used by the kAutoTune periodic task, which never runs concurrently
+  // with itself.
+  std::unique_ptr<AutoTuner> auto_tuner_;
+
   // When set, we use a separate queue for writes that don't write to memtable.
   // In 2PC these are the writes at Prepare phase.
   const bool two_write_queues_;
@@ -4083,16 +4083,26 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
       }
       for (size_t i = 0; i < c->num_input_files(l); i++) {
         FileMetaData* f = c->input(l, i);
+        // add for tier compaction style
+        // A moved file is ordered in its new tier level like a merged one
+        const uint64_t epoch_number =
+            c->immutable_options().compaction_style == kCompactionStyleTier
+                ? c->OutputEpochNumber()
+                : f->epoch_number;
         c->edit()->DeleteFile(c->level(l), f->fd.GetNumber());
         c->edit()->AddFile(
             c->output_level(), f->fd.GetNumber(), f->fd.GetPathId(),
             f->fd.GetFileSize(), f->smallest, f->largest, f->fd.smallest_seqno,
             f->fd.largest_seqno, f->marked_for_compaction, f->temperature,
             f->oldest_blob_file_number, f->oldest_ancester_time,
-            f->file_creation_time, f->epoch_number, f->file_checksum,
+            f->file_creation_time, epoch_number, f->file_checksum,
             f->file_checksum_func_name, f->unique_id,
             f->compensated_range_deletion_size, f->tail_size,
             f->user_defined_timestamps_persisted);
+        // add for tier compaction style
+        // A moved file keeps its key filter.
+        c->edit()->GetMutableNewFiles().back().second.tier_key_filter =
+            f->tier_key_filter;
 
         ROCKS_LOG_BUFFER(
             log_buffer,
@@ -2151,6 +2151,9 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
                   meta.file_checksum, meta.file_checksum_func_name,
                   meta.unique_id, meta.compensated_range_deletion_size,
                   meta.tail_size, meta.user_defined_timestamps_persisted);
+    // add for tier compaction style
+    edit->GetMutableNewFiles().back().second.tier_key_filter =
+        meta.tier_key_filter;
 
     for (const auto& blob : blob_file_additions) {
       edit->AddBlobFile(blob);
@@ -2693,6 +2696,9 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   if (s.ok()) {
     s = impl->RegisterRecordSeqnoTimeWorker();
   }
+  if (s.ok()) {
+    s = impl->RegisterAutoTuneWorker();
+  }
   impl->options_mutex_.Unlock();
   if (s.ok()) {
     *dbptr = std::move(impl);
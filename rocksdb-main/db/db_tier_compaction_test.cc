@@ -0,0 +1,400 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/compaction/compaction.h"
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// add for tier compaction style
+class DBTierCompactionTest : public DBTestBase {
+ public:
+  DBTierCompactionTest()
+      : DBTestBase("db_tier_compaction_test", /*env_do_fsync=*/false) {}
+
+  Options TierOptions() {
+    Options options = CurrentOptions();
+    options.compaction_style = kCompactionStyleTier;
+    options.num_levels = 4;
+    options.disable_auto_compactions = true;
+    return options;
+  }
+
+  // 按给定的每层 T（如 "3:2:100"）打开自动 compaction，等做完后再关掉，
+  // 这样每一步把哪些文件合并或移动到哪一层都是确定的
+  void CompactWithTiers(const std::string& files_per_tier_per_level) {
+    ASSERT_OK(dbfull()->SetOptions(
+        {{"disable_auto_compactions", "false"},
+         {"compaction_options_tier",
+          "{files_per_tier_per_level=" + files_per_tier_per_level + "}"}}));
+    ASSERT_OK(dbfull()->TEST_WaitForCompact());
+    ASSERT_OK(dbfull()->SetOptions({{"disable_auto_compactions", "true"}}));
+  }
+
+  // 在 L2 留下 slice 合并的输出 B[j@5, k@2]，它的最大 seqno 比 L0 中
+  // k 的两个新版本 k@3、k@4 都大。调用者负责释放返回的快照，快照让输出
+  // 保留 seqno，否则合并到空的 L2 时 seqno 会被清零
+  const Snapshot* BuildOlderMergeOutput() {
+    const Snapshot* snapshot = db_->GetSnapshot();
+    EXPECT_OK(Put("j", "j1"));
+    EXPECT_OK(Put("k", "k1"));
+    EXPECT_OK(Flush());
+    // C[j@1, k@2] 移到 L1
+    CompactWithTiers("1:100:100");
+    EXPECT_EQ(FilesPerLevel(), "0,1");
+
+    EXPECT_OK(Put("k", "k2"));
+    EXPECT_OK(Flush());
+    EXPECT_OK(Put("k", "k3"));
+    EXPECT_OK(Flush());
+    EXPECT_OK(Put("j", "j2"));
+    EXPECT_OK(Flush());
+    // L0 中只有 Y[j@5] 自成一个 slice，被移到 L1；L1 的 C、Y 合并成 B 到 L2，
+    // L0 中 k 的两个新版本留在原地
+    CompactWithTiers("3:2:100");
+    EXPECT_EQ(FilesPerLevel(), "2,0,1");
+    return snapshot;
+  }
+
+  static std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return std::string(buf);
+  }
+
+  // 把 memtable 刷成一个 run 并移到 L1，L1 上的 run 互相重叠
+  void FlushRunToL1() {
+    ASSERT_OK(Flush());
+    CompactWithTiers("1:100:100");
+  }
+
+  // L2 上一个 run，L1 上三个 run，新的 run 覆盖、删除或范围删除旧 run 中
+  // 的一部分 key。model 记录每个 key 应读到的值
+  void BuildOverlappingRuns(std::map<std::string, std::string>* model) {
+    for (int i = 0; i < 64; i++) {
+      ASSERT_OK(Put(Key(i), "r0"));
+      (*model)[Key(i)] = "r0";
+    }
+    FlushRunToL1();
+    for (int i = 0; i < 64; i += 2) {
+      ASSERT_OK(Put(Key(i), "r1"));
+      (*model)[Key(i)] = "r1";
+    }
+    FlushRunToL1();
+    // L1 的两个 run 合并到 L2
+    CompactWithTiers("100:1:100");
+    for (int i = 0; i < 64; i += 3) {
+      ASSERT_OK(Delete(Key(i)));
+      model->erase(Key(i));
+    }
+    FlushRunToL1();
+    for (int i = 0; i < 64; i += 5) {
+      ASSERT_OK(Put(Key(i), "r3"));
+      (*model)[Key(i)] = "r3";
+    }
+    FlushRunToL1();
+    ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                               Key(40), Key(48)));
+    for (int i = 40; i < 48; i++) {
+      model->erase(Key(i));
+    }
+    ASSERT_OK(Put(Key(44), "r4"));
+    (*model)[Key(44)] = "r4";
+    ASSERT_OK(Put(Key(70), "r4"));
+    (*model)[Key(70)] = "r4";
+    FlushRunToL1();
+    ASSERT_EQ(FilesPerLevel(), "0,3,1");
+  }
+
+  static std::string Expected(const std::map<std::string, std::string>& model,
+                              const std::string& key) {
+    auto it = model.find(key);
+    return it == model.end() ? "NOT_FOUND" : it->second;
+  }
+};
+
+// 测试：slice 合并的输出带着较大的 seqno 和某个 key 的旧版本先到达 L2，
+// 这个 key 的新版本后到达 L2，Get / MultiGet 仍然读到新版本
+TEST_F(DBTierCompactionTest, SliceMergeDoesNotShadowNewerRun) {
+  // 1. Arrange
+  Options options = TierOptions();
+  DestroyAndReopen(options);
+  const Snapshot* snapshot = BuildOlderMergeOutput();
+
+  // 2. Act
+  // L0 的 k@3、k@4 合并成 O[k@4] 到 L1，再移到 L2，排在 B 之前
+  CompactWithTiers("2:1:100");
+
+  // 3. Assert
+  ASSERT_EQ(FilesPerLevel(), "0,0,2");
+  ASSERT_EQ(Get("k"), "k3");
+  ASSERT_EQ(Get("j"), "j2");
+  ASSERT_EQ(MultiGet({"j", "k"}, nullptr), std::vector<std::string>(
+                                                {"j2", "k3"}));
+  // 顺序记在 manifest 里，重启后不变
+  db_->ReleaseSnapshot(snapshot);
+  Reopen(options);
+  ASSERT_EQ(FilesPerLevel(), "0,0,2");
+  ASSERT_EQ(Get("k"), "k3");
+  ASSERT_EQ(Get("j"), "j2");
+}
+
+// 测试：trivial move 移入的文件最大 seqno 比输出层中与它重叠的旧文件小，
+// 它仍然排在那个文件之前，读不到旧版本
+TEST_F(DBTierCompactionTest, TrivialMoveDoesNotShadowNewerRun) {
+  // 1. Arrange
+  Options options = TierOptions();
+  DestroyAndReopen(options);
+  const Snapshot* snapshot = BuildOlderMergeOutput();
+  // L0 的 k@3、k@4 合并成 O[k@4] 到 L1
+  CompactWithTiers("2:100:100");
+  ASSERT_EQ(FilesPerLevel(), "0,1,1");
+  int trivial_moves_into_l2 = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "TierCompactionPicker::PickCompaction:Return", [&](void* arg) {
+        Compaction* c = static_cast<Compaction*>(arg);
+        if (c->output_level() == 2 && c->is_trivial_move()) {
+          trivial_moves_into_l2++;
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // 2. Act
+  CompactWithTiers("100:1:100");
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // 3. Assert
+  ASSERT_EQ(trivial_moves_into_l2, 1);
+  ASSERT_EQ(FilesPerLevel(), "0,0,2");
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(files.size(), 2u);
+  const LiveFileMetaData& moved = files[0].largest_seqno == 4 ? files[0]
+                                                               : files[1];
+  const LiveFileMetaData& merged = files[0].largest_seqno == 4 ? files[1]
+                                                                : files[0];
+  ASSERT_EQ(moved.largest_seqno, 4u);
+  ASSERT_EQ(merged.largest_seqno, 5u);
+  ASSERT_GT(moved.epoch_number, merged.epoch_number);
+  ASSERT_EQ(Get("k"), "k3");
+  ASSERT_EQ(MultiGet({"j", "k"}, nullptr), std::vector<std::string>(
+                                                {"j2", "k3"}));
+  db_->ReleaseSnapshot(snapshot);
+}
+
+// 测试：L1、L2 上有多个重叠的 run 时，Get 取最新 run 中的版本，
+// 被删除和范围删除的 key 读不到
+TEST_F(DBTierCompactionTest, GetAcrossOverlappingRuns) {
+  for (int bits_per_key : {0, 10}) {
+    // 1. Arrange
+    Options options = TierOptions();
+    options.compaction_options_tier.filter_index_bits_per_key = bits_per_key;
+    DestroyAndReopen(options);
+    std::map<std::string, std::string> model;
+    BuildOverlappingRuns(&model);
+
+    // 2. Act & 3. Assert
+    for (int i = 0; i < 72; i++) {
+      ASSERT_EQ(Get(Key(i)), Expected(model, Key(i)))
+          << "key " << i << " bits " << bits_per_key;
+    }
+  }
+}
+
+// 测试：MultiGet 在 L1、L2 的多个重叠 run 上查同一批 key，结果与 Get 一致
+TEST_F(DBTierCompactionTest, MultiGetAcrossOverlappingRuns) {
+  for (bool async_io : {false, true}) {
+    for (int bits_per_key : {0, 10}) {
+      // 1. Arrange
+      Options options = TierOptions();
+      options.compaction_options_tier.filter_index_bits_per_key = bits_per_key;
+      DestroyAndReopen(options);
+      std::map<std::string, std::string> model;
+      BuildOverlappingRuns(&model);
+      std::vector<std::string> keys;
+      for (int i = 0; i < 72; i++) {
+        keys.push_back(Key(i));
+      }
+
+      // 2. Act
+      std::vector<std::string> values = MultiGet(keys, nullptr, async_io);
+
+      // 3. Assert
+      ASSERT_EQ(values.size(), keys.size());
+      for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(values[i], Expected(model, keys[i]))
+            << "key " << i << " async_io " << async_io << " bits "
+            << bits_per_key;
+      }
+    }
+  }
+}
+
+// 测试：迭代器在 L1、L2 的多个重叠 run 上正向、反向遍历和 Seek，
+// 结果与 model 一致
+TEST_F(DBTierCompactionTest, IteratorAcrossOverlappingRuns) {
+  // 1. Arrange
+  Options options = TierOptions();
+  DestroyAndReopen(options);
+  std::map<std::string, std::string> model;
+  BuildOverlappingRuns(&model);
+
+  // 2. Act & 3. Assert
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  auto expected = model.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected) {
+    ASSERT_TRUE(expected != model.end());
+    ASSERT_EQ(iter->key().ToString(), expected->first);
+    ASSERT_EQ(iter->value().ToString(), expected->second);
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(expected == model.end());
+
+  auto reverse_expected = model.rbegin();
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++reverse_expected) {
+    ASSERT_TRUE(reverse_expected != model.rend());
+    ASSERT_EQ(iter->key().ToString(), reverse_expected->first);
+    ASSERT_EQ(iter->value().ToString(), reverse_expected->second);
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(reverse_expected == model.rend());
+
+  for (int i = 0; i < 72; i++) {
+    iter->Seek(Key(i));
+    auto lower = model.lower_bound(Key(i));
+    ASSERT_EQ(iter->Valid(), lower != model.end()) << "key " << i;
+    if (iter->Valid()) {
+      ASSERT_EQ(iter->key().ToString(), lower->first) << "key " << i;
+    }
+    iter->SeekForPrev(Key(i));
+    auto upper = model.upper_bound(Key(i));
+    ASSERT_EQ(iter->Valid(), upper != model.begin()) << "key " << i;
+    if (iter->Valid()) {
+      ASSERT_EQ(iter->key().ToString(), std::prev(upper)->first)
+          << "key " << i;
+    }
+  }
+  ASSERT_OK(iter->status());
+}
+
+// 测试：整个落在 iterate_lower_bound / iterate_upper_bound 之外的 run
+// 不加入合并迭代器，范围内的结果不变
+TEST_F(DBTierCompactionTest, IteratorBoundsSkipRuns) {
+  // 1. Arrange：L1 上 A[0, 9]、B[50, 59]、C[55, 60]，C 比 B 新，分成
+  // {A, C}、{B} 两个 sorted run
+  Options options = TierOptions();
+  DestroyAndReopen(options);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "a"));
+  }
+  FlushRunToL1();
+  for (int i = 50; i < 60; i++) {
+    ASSERT_OK(Put(Key(i), "b"));
+  }
+  FlushRunToL1();
+  for (int i = 55; i <= 60; i++) {
+    ASSERT_OK(Put(Key(i), "c"));
+  }
+  FlushRunToL1();
+  ASSERT_EQ(FilesPerLevel(), "0,3");
+  int skipped_runs = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "Version::AddIteratorsForLevel:SkipTierRun",
+      [&](void* /*arg*/) { skipped_runs++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // 2. Act
+  // 返回 [lower, upper) 内的 key 和跳过的 run 数
+  auto scan = [&](int lower, int upper) {
+    std::string lower_key = Key(lower);
+    std::string upper_key = Key(upper);
+    Slice lower_bound(lower_key);
+    Slice upper_bound(upper_key);
+    ReadOptions read_options;
+    read_options.iterate_lower_bound = &lower_bound;
+    read_options.iterate_upper_bound = &upper_bound;
+    skipped_runs = 0;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    std::string result;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      result += iter->key().ToString().substr(3) + "=" +
+                iter->value().ToString() + " ";
+    }
+    EXPECT_OK(iter->status());
+    return std::make_pair(result, skipped_runs);
+  };
+  auto head = scan(0, 3);
+  auto middle = scan(53, 57);
+  auto tail = scan(61, 70);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // 3. Assert
+  ASSERT_EQ(head.first, "000000=a 000001=a 000002=a ");
+  ASSERT_EQ(head.second, 1);
+  ASSERT_EQ(middle.first, "000053=b 000054=b 000055=c 000056=c ");
+  ASSERT_EQ(middle.second, 0);
+  ASSERT_EQ(tail.first, "");
+  ASSERT_EQ(tail.second, 2);
+}
+
+// 测试：max_subcompactions 大于 1 时，tier 合并按所有输入文件的 anchor
+// 切成多个 subcompaction，合并后每个 key 仍是最新的版本
+TEST_F(DBTierCompactionTest, MergeSplitsIntoSubcompactions) {
+  // 1. Arrange：L1 上三个 key range 相同的 run
+  Options options = TierOptions();
+  options.max_subcompactions = 4;
+  options.target_file_size_base = 32 << 10;
+  DestroyAndReopen(options);
+  Random rnd(301);
+  std::map<std::string, std::string> model;
+  for (int run = 0; run < 3; run++) {
+    for (int i = run; i < 3000; i += 2) {
+      std::string value = rnd.RandomString(100);
+      ASSERT_OK(Put(Key(i), value));
+      model[Key(i)] = value;
+    }
+    FlushRunToL1();
+  }
+  ASSERT_EQ(FilesPerLevel(), "0,3");
+  uint64_t num_subcompactions = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::GenSubcompactionBoundaries:1", [&](void* arg) {
+        num_subcompactions = *static_cast<uint64_t*>(arg);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // 2. Act
+  CompactWithTiers("100:1:100");
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // 3. Assert
+  ASSERT_GT(num_subcompactions, 1u);
+  ASSERT_LE(num_subcompactions, 4u);
+  ASSERT_EQ(NumTableFilesAtLevel(1), 0);
+  ASSERT_GT(NumTableFilesAtLevel(2), 1);
+  for (const auto& entry : model) {
+    ASSERT_EQ(Get(entry.first), entry.second) << entry.first;
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -655,6 +655,13 @@ class InternalStats {
     return comp_stats_;
   }
 
+  // add for ADOC tuner
+  // Cumulative stats of the jobs (flushes included) that wrote to `level`.
+  // REQUIRES: DB mutex held
+  const CompactionStats& GetCompactionStats(int level) const {
+    return comp_stats_[level];
+  }
+
   const CompactionStats& TEST_GetPerKeyPlacementCompactionStats() const {
     return per_key_placement_comp_stats_;
   }
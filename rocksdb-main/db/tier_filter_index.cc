@@ -0,0 +1,293 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/tier_filter_index.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "db/dbformat.h"
+#include "db/version_edit.h"
+#include "util/bloom_impl.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Beyond this many segment entries per file (files spanning most of the
+// tier), the segment table costs more memory than it saves in comparisons.
+constexpr size_t kMaxSegmentEntriesPerFile = 64;
+constexpr uint32_t kCacheLineBytes = 64;
+// Number of probes and flags in front of the filter bits.
+constexpr size_t kFilterHeaderBytes = 2;
+constexpr char kRangeDeletionsFlag = 0x1;
+}  // anonymous namespace
+
+const std::string TierKeyFilter::kPropertyName = "rocksdb.tier.key.filter";
+
+uint64_t TierKeyFilter::HashKey(const Slice& user_key) {
+  return GetSliceHash64(user_key);
+}
+
+std::shared_ptr<const TierKeyFilter> TierKeyFilter::FromTableProperties(
+    const std::shared_ptr<const TableProperties>& props) {
+  if (props == nullptr) {
+    return nullptr;
+  }
+  auto it = props->user_collected_properties.find(kPropertyName);
+  if (it == props->user_collected_properties.end()) {
+    return nullptr;
+  }
+  const std::string& contents = it->second;
+  if (contents.size() < kFilterHeaderBytes + kCacheLineBytes ||
+      (contents.size() - kFilterHeaderBytes) % kCacheLineBytes != 0 ||
+      contents.size() - kFilterHeaderBytes > uint64_t{0xffffffff}) {
+    return nullptr;
+  }
+  std::shared_ptr<TierKeyFilter> filter(new TierKeyFilter());
+  filter->num_probes_ = static_cast<unsigned char>(contents[0]);
+  filter->has_range_deletions_ = (contents[1] & kRangeDeletionsFlag) != 0;
+  filter->len_bytes_ =
+      static_cast<uint32_t>(contents.size() - kFilterHeaderBytes);
+  // 和 props 共享内存，filter 活着 props 就不会被释放
+  filter->data_ = std::shared_ptr<const char>(
+      props, contents.data() + kFilterHeaderBytes);
+  return filter;
+}
+
+bool TierKeyFilter::HashMayMatch(uint64_t hash) const {
+  return FastLocalBloomImpl::HashMayMatch(Lower32of64(hash), Upper32of64(hash),
+                                          len_bytes_, num_probes_,
+                                          data_.get());
+}
+
+TierKeyFilterBuilder::TierKeyFilterBuilder(int bits_per_key)
+    : millibits_per_key_(bits_per_key * 1000) {}
+
+void TierKeyFilterBuilder::AddKey(const Slice& user_key) {
+  const uint64_t hash = TierKeyFilter::HashKey(user_key);
+  // 同一个 user key 的多个版本是相邻的，只加一次
+  if (hashes_.empty() || hashes_.back() != hash) {
+    hashes_.push_back(hash);
+  }
+}
+
+std::string TierKeyFilterBuilder::Finish() {
+  uint64_t len_bytes =
+      static_cast<uint64_t>(hashes_.size()) * millibits_per_key_ / 8000;
+  len_bytes = std::max<uint64_t>(
+      (len_bytes + kCacheLineBytes - 1) / kCacheLineBytes * kCacheLineBytes,
+      kCacheLineBytes);
+  len_bytes = std::min<uint64_t>(len_bytes, uint64_t{0xffffffff} /
+                                                kCacheLineBytes *
+                                                kCacheLineBytes);
+  const int num_probes =
+      FastLocalBloomImpl::ChooseNumProbes(millibits_per_key_);
+  std::string contents(kFilterHeaderBytes + len_bytes, '\0');
+  contents[0] = static_cast<char>(num_probes);
+  contents[1] = has_range_deletions_ ? kRangeDeletionsFlag : 0;
+  char* data = &contents[kFilterHeaderBytes];
+  for (uint64_t hash : hashes_) {
+    FastLocalBloomImpl::AddHash(Lower32of64(hash), Upper32of64(hash),
+                                static_cast<uint32_t>(len_bytes), num_probes,
+                                data);
+  }
+  hashes_.clear();
+  has_range_deletions_ = false;
+  return contents;
+}
+
+Status TierKeyFilterCollector::InternalAdd(const Slice& key,
+                                           const Slice& /* value */,
+                                           uint64_t /* file_size */) {
+  ParsedInternalKey ikey;
+  Status s = ParseInternalKey(key, &ikey, false /* log_err_key */);
+  if (!s.ok()) {
+    return s;
+  }
+  if (ikey.type == kTypeRangeDeletion) {
+    builder_.MarkRangeDeletion();
+  } else {
+    builder_.AddKey(ikey.user_key);
+  }
+  return Status::OK();
+}
+
+Status TierKeyFilterCollector::Finish(UserCollectedProperties* properties) {
+  std::string contents = builder_.Finish();
+  filter_size_ = contents.size();
+  properties->insert({TierKeyFilter::kPropertyName, std::move(contents)});
+  return Status::OK();
+}
+
+UserCollectedProperties TierKeyFilterCollector::GetReadableProperties() const {
+  return {{TierKeyFilter::kPropertyName,
+           std::to_string(filter_size_) + " bytes"}};
+}
+
+TierFilterIndex::TierFilterIndex(const std::vector<FileMetaData*>& files,
+                                 const Comparator* ucmp)
+    : files_(files), ucmp_(ucmp) {}
+
+std::unique_ptr<TierFilterIndex> TierFilterIndex::Build(
+    const std::vector<FileMetaData*>& files, const Comparator* ucmp) {
+  // 带时间戳的 user key 在写入和查找时不一致，不能按整个 key 做 hash
+  if (files.empty() || ucmp->timestamp_size() > 0) {
+    return nullptr;
+  }
+  bool any_filter = false;
+  for (const FileMetaData* f : files) {
+    if (f->tier_key_filter && !f->tier_key_filter->has_range_deletions()) {
+      any_filter = true;
+      break;
+    }
+  }
+  if (!any_filter) {
+    return nullptr;
+  }
+  std::unique_ptr<TierFilterIndex> index(new TierFilterIndex(files, ucmp));
+  index->BuildSegments();
+  return index;
+}
+
+bool TierFilterIndex::BuildSegments() {
+  std::vector<Slice> keys;
+  keys.reserve(files_.size() * 2);
+  for (const FileMetaData* f : files_) {
+    keys.push_back(f->smallest.user_key());
+    keys.push_back(f->largest.user_key());
+  }
+  std::sort(keys.begin(), keys.end(), [this](const Slice& a, const Slice& b) {
+    return ucmp_->Compare(a, b) < 0;
+  });
+  keys.erase(std::unique(keys.begin(), keys.end(),
+                         [this](const Slice& a, const Slice& b) {
+                           return ucmp_->Compare(a, b) == 0;
+                         }),
+             keys.end());
+
+  auto boundary_of = [&](const Slice& key) {
+    return static_cast<size_t>(
+        std::lower_bound(keys.begin(), keys.end(), key,
+                         [this](const Slice& a, const Slice& b) {
+                           return ucmp_->Compare(a, b) < 0;
+                         }) -
+        keys.begin());
+  };
+
+  // A file covers the contiguous segments [2 * lo, 2 * hi].
+  std::vector<std::pair<size_t, size_t>> file_segments;
+  file_segments.reserve(files_.size());
+  size_t total_entries = 0;
+  for (const FileMetaData* f : files_) {
+    const size_t lo = 2 * boundary_of(f->smallest.user_key());
+    const size_t hi = 2 * boundary_of(f->largest.user_key());
+    file_segments.emplace_back(lo, hi);
+    total_entries += hi - lo + 1;
+  }
+  if (total_entries > kMaxSegmentEntriesPerFile * files_.size()) {
+    return false;
+  }
+
+  const size_t num_segments = 2 * keys.size() - 1;
+  segment_offsets_.assign(num_segments + 1, 0);
+  for (const auto& range : file_segments) {
+    for (size_t s = range.first; s <= range.second; s++) {
+      segment_offsets_[s + 1]++;
+    }
+  }
+  for (size_t s = 0; s < num_segments; s++) {
+    segment_offsets_[s + 1] += segment_offsets_[s];
+  }
+  segment_files_.resize(total_entries);
+  std::vector<uint32_t> fill(segment_offsets_.begin(),
+                             segment_offsets_.end() - 1);
+  // Files are visited newest-first, so every segment lists them in that
+  // order too.
+  for (uint32_t i = 0; i < static_cast<uint32_t>(files_.size()); i++) {
+    for (size_t s = file_segments[i].first; s <= file_segments[i].second;
+         s++) {
+      segment_files_[fill[s]++] = i;
+    }
+  }
+  boundaries_.reserve(keys.size());
+  for (const Slice& key : keys) {
+    boundaries_.emplace_back(key.data(), key.size());
+  }
+  return true;
+}
+
+bool TierFilterIndex::FindSegment(const Slice& user_key,
+                                  size_t* segment) const {
+  auto it = std::upper_bound(boundaries_.begin(), boundaries_.end(), user_key,
+                             [this](const Slice& key, const std::string& b) {
+                               return ucmp_->Compare(key, b) < 0;
+                             });
+  if (it == boundaries_.begin()) {
+    return false;
+  }
+  const size_t j = static_cast<size_t>(it - boundaries_.begin()) - 1;
+  if (ucmp_->Compare(boundaries_[j], user_key) == 0) {
+    *segment = 2 * j;
+    return true;
+  }
+  if (j + 1 == boundaries_.size()) {
+    return false;
+  }
+  *segment = 2 * j + 1;
+  return true;
+}
+
+bool TierFilterIndex::FileMayMatch(uint32_t file, uint64_t hash) const {
+  const TierKeyFilter* filter = files_[file]->tier_key_filter.get();
+  return filter == nullptr || filter->has_range_deletions() ||
+         filter->HashMayMatch(hash);
+}
+
+size_t TierFilterIndex::GetCandidates(const Slice& user_key,
+                                      autovector<uint32_t>* candidates) const {
+  const uint64_t hash = TierKeyFilter::HashKey(user_key);
+  size_t filtered = 0;
+  if (!segment_offsets_.empty()) {
+    size_t segment = 0;
+    if (!FindSegment(user_key, &segment)) {
+      return 0;
+    }
+    for (uint32_t k = segment_offsets_[segment];
+         k < segment_offsets_[segment + 1]; k++) {
+      if (FileMayMatch(segment_files_[k], hash)) {
+        candidates->push_back(segment_files_[k]);
+      } else {
+        filtered++;
+      }
+    }
+    return filtered;
+  }
+  for (uint32_t i = 0; i < static_cast<uint32_t>(files_.size()); i++) {
+    const FileMetaData* f = files_[i];
+    if (ucmp_->Compare(user_key, f->smallest.user_key()) < 0 ||
+        ucmp_->Compare(user_key, f->largest.user_key()) > 0) {
+      continue;
+    }
+    if (FileMayMatch(i, hash)) {
+      candidates->push_back(i);
+    } else {
+      filtered++;
+    }
+  }
+  return filtered;
+}
+
+size_t TierFilterIndex::ApproximateMemoryUsage() const {
+  size_t usage = sizeof(*this) + files_.capacity() * sizeof(FileMetaData*) +
+                 segment_offsets_.capacity() * sizeof(uint32_t) +
+                 segment_files_.capacity() * sizeof(uint32_t);
+  for (const std::string& b : boundaries_) {
+    usage += sizeof(std::string) + b.capacity();
+  }
+  return usage;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
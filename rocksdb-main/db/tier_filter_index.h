@@ -0,0 +1,188 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// add for tier compaction style
+// A tier holds T overlapping sorted runs, so a point lookup that misses has
+// to go through TableCache::Get (table cache lookup + filter block fetch) for
+// every run whose key range covers the key. The structures here let the
+// lookup skip those runs from memory:
+//
+//  * TierKeyFilter: a cache-local Bloom filter of the user keys of one table
+//    file. TierKeyFilterCollector builds it while the file is written (by
+//    flush, compaction, or SstFileWriter) and stores it in the table
+//    properties, so it is read back with the table reader, no key is scanned.
+//  * TierFilterIndex: per tier, the key space cut into segments at the file
+//    boundaries. Each segment lists the files covering it in newest-first
+//    order, so one binary search plus one cache line per covering file tells
+//    which runs might hold a key.
+//
+// Flush and compaction attach the filter to the FileMetaData of their output
+// files. When VersionBuilder loads the table reader of a file (including the
+// files loaded from the MANIFEST and ingested files), it takes the filter
+// from the reader's table properties instead, sharing their memory. The
+// memory is charged to the block cache as file metadata
+// (CacheEntryRole::kFileMetadata). Files without one (written without the
+// collector, e.g. by an SstFileWriter with other options, or loaded while the
+// table cache was too small to load their reader) are always reported as
+// candidates.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/table_properties_collector.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "rocksdb/table_properties.h"
+#include "util/autovector.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct FileMetaData;
+
+class TierKeyFilter {
+ public:
+  // User collected table property holding the filter of a table file.
+  static const std::string kPropertyName;
+
+  static uint64_t HashKey(const Slice& user_key);
+
+  // Returns the filter stored in `props`, sharing its memory, or nullptr if
+  // the file has none (or it is malformed).
+  static std::shared_ptr<const TierKeyFilter> FromTableProperties(
+      const std::shared_ptr<const TableProperties>& props);
+
+  // False means no key with this hash was added to the file.
+  bool HashMayMatch(uint64_t hash) const;
+
+  // A file holding range tombstones must always be searched, the tombstones
+  // may cover the key without the key itself being in the file.
+  bool has_range_deletions() const { return has_range_deletions_; }
+
+  size_t ApproximateMemoryUsage() const { return len_bytes_; }
+
+ private:
+  TierKeyFilter() = default;
+
+  // Points into the property value, which it keeps alive.
+  std::shared_ptr<const char> data_;
+  uint32_t len_bytes_ = 0;
+  int num_probes_ = 0;
+  bool has_range_deletions_ = false;
+};
+
+class TierKeyFilterBuilder {
+ public:
+  explicit TierKeyFilterBuilder(int bits_per_key);
+
+  // REQUIRES: keys of one file, in sorted order (versions of the same user
+  // key are added once).
+  void AddKey(const Slice& user_key);
+  void MarkRangeDeletion() { has_range_deletions_ = true; }
+
+  // Returns the value of the TierKeyFilter::kPropertyName property: one byte
+  // with the number of probes, one byte of flags (bit 0: the file has range
+  // deletions), then the filter bits, a multiple of 64 bytes.
+  std::string Finish();
+
+ private:
+  int millibits_per_key_;
+  bool has_range_deletions_ = false;
+  std::vector<uint64_t> hashes_;
+};
+
+// Feeds the keys of a table file being written into a TierKeyFilterBuilder
+// and stores the filter as the TierKeyFilter::kPropertyName property.
+class TierKeyFilterCollector : public InternalTblPropColl {
+ public:
+  explicit TierKeyFilterCollector(int bits_per_key) : builder_(bits_per_key) {}
+
+  Status InternalAdd(const Slice& key, const Slice& value,
+                     uint64_t file_size) override;
+
+  void BlockAdd(uint64_t /* block_uncomp_bytes */,
+                uint64_t /* block_compressed_bytes_fast */,
+                uint64_t /* block_compressed_bytes_slow */) override {}
+
+  Status Finish(UserCollectedProperties* properties) override;
+
+  const char* Name() const override { return "TierKeyFilterCollector"; }
+
+  UserCollectedProperties GetReadableProperties() const override;
+
+ private:
+  TierKeyFilterBuilder builder_;
+  size_t filter_size_ = 0;
+};
+
+// Registered by tier column families and by SstFileWriter. The bits per key
+// follow compaction_options_tier.filter_index_bits_per_key, which can change
+// through SetOptions(); no collector is created while it is 0.
+class TierKeyFilterCollectorFactory : public InternalTblPropCollFactory {
+ public:
+  explicit TierKeyFilterCollectorFactory(int bits_per_key)
+      : bits_per_key_(bits_per_key) {}
+
+  void SetBitsPerKey(int bits_per_key) {
+    bits_per_key_.store(bits_per_key, std::memory_order_relaxed);
+  }
+
+  InternalTblPropColl* CreateInternalTblPropColl(
+      uint32_t /* column_family_id */, int /* level_at_creation */,
+      int /* num_levels */,
+      SequenceNumber /* last_level_inclusive_max_seqno_threshold */ =
+          kMaxSequenceNumber) override {
+    const int bits_per_key = bits_per_key_.load(std::memory_order_relaxed);
+    return bits_per_key > 0 ? new TierKeyFilterCollector(bits_per_key)
+                            : nullptr;
+  }
+
+  const char* Name() const override { return "TierKeyFilterCollectorFactory"; }
+
+ private:
+  std::atomic<int> bits_per_key_;
+};
+
+class TierFilterIndex {
+ public:
+  // `files` is one tier in newest-first order. Returns nullptr when no file
+  // carries a TierKeyFilter, the lookup then has nothing to gain.
+  static std::unique_ptr<TierFilterIndex> Build(
+      const std::vector<FileMetaData*>& files, const Comparator* ucmp);
+
+  // Appends to `candidates`, in increasing (= newest-first) order, the
+  // position of every file that might hold `user_key`. Returns the number of
+  // files whose key range covers `user_key` but whose filter ruled it out.
+  size_t GetCandidates(const Slice& user_key,
+                       autovector<uint32_t>* candidates) const;
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  TierFilterIndex(const std::vector<FileMetaData*>& files,
+                  const Comparator* ucmp);
+
+  // Boundary j is a point segment (id 2j), the keys strictly between
+  // boundary j and j+1 form the open segment 2j+1.
+  bool BuildSegments();
+  bool FindSegment(const Slice& user_key, size_t* segment) const;
+  bool FileMayMatch(uint32_t file, uint64_t hash) const;
+
+  const std::vector<FileMetaData*> files_;
+  const Comparator* ucmp_;
+  std::vector<std::string> boundaries_;
+  // Files of segment s are segment_files_[segment_offsets_[s],
+  // segment_offsets_[s + 1]). Empty when the segment table would be too
+  // large, every file's key range is then checked instead.
+  std::vector<uint32_t> segment_offsets_;
+  std::vector<uint32_t> segment_files_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
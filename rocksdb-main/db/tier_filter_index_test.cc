@@ -0,0 +1,483 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/tier_filter_index.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache/cache_reservation_manager.h"
+#include "db/db_test_util.h"
+#include "db/version_edit.h"
+#include "port/stack_trace.h"
+#include "rocksdb/sst_file_writer.h"
+#include "rocksdb/statistics.h"
+#include "test_util/testharness.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class TierFilterIndexTest : public testing::Test {
+ public:
+  ~TierFilterIndexTest() override {
+    for (FileMetaData* f : files_) {
+      delete f;
+    }
+  }
+
+  // 按 newest-first 的顺序追加一个文件，keys 为空时不建 filter
+  void Add(const std::string& smallest, const std::string& largest,
+           const std::vector<std::string>& keys, bool range_del = false) {
+    FileMetaData* f = new FileMetaData();
+    f->fd = FileDescriptor(files_.size() + 1, 0, 1);
+    f->smallest = InternalKey(smallest, 100, kTypeValue);
+    f->largest = InternalKey(largest, 100, kTypeValue);
+    if (!keys.empty()) {
+      TierKeyFilterBuilder builder(10);
+      for (const auto& k : keys) {
+        builder.AddKey(k);
+      }
+      if (range_del) {
+        builder.MarkRangeDeletion();
+      }
+      auto props = std::make_shared<TableProperties>();
+      props->user_collected_properties[TierKeyFilter::kPropertyName] =
+          builder.Finish();
+      f->tier_key_filter = TierKeyFilter::FromTableProperties(props);
+    }
+    files_.push_back(f);
+  }
+
+  static std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return std::string(buf);
+  }
+
+  std::vector<uint32_t> Candidates(const TierFilterIndex& index,
+                                   const std::string& key,
+                                   size_t* filtered = nullptr) {
+    autovector<uint32_t> candidates;
+    size_t n = index.GetCandidates(key, &candidates);
+    if (filtered != nullptr) {
+      *filtered = n;
+    }
+    return std::vector<uint32_t>(candidates.begin(), candidates.end());
+  }
+
+  std::vector<FileMetaData*> files_;
+};
+
+// 测试：没有任何文件带 filter 时不建索引
+TEST_F(TierFilterIndexTest, NoFilterNoIndex) {
+  // 1. Arrange
+  Add("a", "m", {});
+  Add("c", "z", {});
+
+  // 2. Act
+  auto index = TierFilterIndex::Build(files_, BytewiseComparator());
+
+  // 3. Assert
+  ASSERT_EQ(index, nullptr);
+}
+
+// 测试：只返回 key range 覆盖且 filter 命中的文件，顺序是 newest-first
+TEST_F(TierFilterIndexTest, CandidatesByRangeAndFilter) {
+  // 1. Arrange
+  Add("b", "f", {"b", "d", "f"});
+  Add("a", "z", {"a", "c", "z"});
+  Add("c", "c", {"c"});
+  Add("x", "y", {});  // 没有 filter，只能按 range 判断
+  auto index = TierFilterIndex::Build(files_, BytewiseComparator());
+  ASSERT_NE(index, nullptr);
+
+  // 2. Act & 3. Assert
+  ASSERT_EQ(Candidates(*index, "c"), std::vector<uint32_t>({1, 2}));
+  ASSERT_EQ(Candidates(*index, "d"), std::vector<uint32_t>({0}));
+  ASSERT_EQ(Candidates(*index, "z"), std::vector<uint32_t>({1}));
+  ASSERT_EQ(Candidates(*index, "xx"), std::vector<uint32_t>({3}));
+  // range 之外
+  ASSERT_TRUE(Candidates(*index, "0").empty());
+  ASSERT_TRUE(Candidates(*index, "zz").empty());
+  // range 覆盖但 key 不存在：两个文件都应被 filter 挡掉
+  size_t filtered = 0;
+  ASSERT_TRUE(Candidates(*index, "e", &filtered).empty());
+  ASSERT_EQ(filtered, 2u);
+}
+
+// 测试：带 range tombstone 的文件总是候选
+TEST_F(TierFilterIndexTest, RangeDeletionFileAlwaysCandidate) {
+  // 1. Arrange
+  Add("a", "z", {"a"}, /*range_del=*/true);
+  Add("a", "z", {"a", "z"});
+  auto index = TierFilterIndex::Build(files_, BytewiseComparator());
+  ASSERT_NE(index, nullptr);
+
+  // 2. Act
+  auto candidates = Candidates(*index, "m");
+
+  // 3. Assert
+  ASSERT_EQ(candidates, std::vector<uint32_t>({0}));
+}
+
+// 测试：filter 没有漏判（已加入的 key 一定是候选）
+TEST_F(TierFilterIndexTest, NoFalseNegatives) {
+  // 1. Arrange
+  std::vector<std::string> keys;
+  for (int i = 0; i < 10000; i++) {
+    keys.push_back(Key(i));
+  }
+  Add(keys.front(), keys.back(), keys);
+  auto index = TierFilterIndex::Build(files_, BytewiseComparator());
+  ASSERT_NE(index, nullptr);
+
+  // 2. Act
+  int found = 0;
+  int false_positives = 0;
+  for (int i = 0; i < 10000; i++) {
+    found += Candidates(*index, Key(i)).size() == 1 ? 1 : 0;
+    false_positives += Candidates(*index, Key(i) + "x").size();
+  }
+
+  // 3. Assert
+  ASSERT_EQ(found, 10000);
+  // 10 bits/key 的 cache-local bloom，误判率约 1%
+  ASSERT_LT(false_positives, 300);
+}
+
+// 测试：table properties 里没有 filter 或内容不完整时不返回 filter
+TEST_F(TierFilterIndexTest, MissingOrMalformedPropertyNoFilter) {
+  // 1. Arrange
+  TierKeyFilterBuilder builder(10);
+  builder.AddKey("a");
+  const std::string contents = builder.Finish();
+  auto missing = std::make_shared<TableProperties>();
+  auto truncated = std::make_shared<TableProperties>();
+  truncated->user_collected_properties[TierKeyFilter::kPropertyName] =
+      contents.substr(0, contents.size() - 1);
+  auto complete = std::make_shared<TableProperties>();
+  complete->user_collected_properties[TierKeyFilter::kPropertyName] = contents;
+
+  // 2. Act & 3. Assert
+  ASSERT_EQ(TierKeyFilter::FromTableProperties(nullptr), nullptr);
+  ASSERT_EQ(TierKeyFilter::FromTableProperties(missing), nullptr);
+  ASSERT_EQ(TierKeyFilter::FromTableProperties(truncated), nullptr);
+  auto filter = TierKeyFilter::FromTableProperties(complete);
+  ASSERT_NE(filter, nullptr);
+  ASSERT_TRUE(filter->HashMayMatch(TierKeyFilter::HashKey("a")));
+}
+
+class DBTierFilterIndexTest : public DBTestBase {
+ public:
+  DBTierFilterIndexTest()
+      : DBTestBase("db_tier_filter_index_test", /*env_do_fsync=*/false) {}
+
+  Options TierOptions() {
+    Options options = CurrentOptions();
+    options.compaction_style = kCompactionStyleTier;
+    options.compaction_options_tier.filter_index_bits_per_key = 10;
+    options.disable_auto_compactions = true;
+    options.statistics = CreateDBStatistics();
+    return options;
+  }
+};
+
+// 测试：负查询被索引挡掉，且 Get 的结果不变
+TEST_F(DBTierFilterIndexTest, SkipsRunsOnNegativeLookup) {
+  // 1. Arrange：L0 上 4 个 key range 相同、key 互不相交的 run
+  Options options = TierOptions();
+  Reopen(options);
+  for (int run = 0; run < 4; run++) {
+    for (int i = run; i < 400; i += 4) {
+      ASSERT_OK(Put(Key(i), "v" + std::to_string(i)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(NumTableFilesAtLevel(0), 4);
+  ASSERT_OK(options.statistics->Reset());
+
+  // 2. Act
+  for (int i = 0; i < 400; i++) {
+    ASSERT_EQ(Get(Key(i)), "v" + std::to_string(i));
+  }
+  const uint64_t useful_on_hits =
+      options.statistics->getTickerCount(BLOOM_FILTER_USEFUL);
+  ASSERT_EQ(Get(Key(200) + "x"), "NOT_FOUND");
+  const uint64_t useful_on_miss =
+      options.statistics->getTickerCount(BLOOM_FILTER_USEFUL) - useful_on_hits;
+
+  // 3. Assert
+  ASSERT_GT(useful_on_hits, 0u);
+  ASSERT_GE(useful_on_miss, 3u);
+}
+
+// 测试：新的 run 中的 range tombstone 仍然遮住旧 run 里的 key
+TEST_F(DBTierFilterIndexTest, RangeDeletionStillApplies) {
+  // 1. Arrange
+  Options options = TierOptions();
+  Reopen(options);
+  ASSERT_OK(Put(Key(1), "old"));
+  ASSERT_OK(Put(Key(9), "old"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(Key(0), "new"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(1), Key(5)));
+  ASSERT_OK(Put(Key(9), "new"));
+  ASSERT_OK(Flush());
+
+  // 2. Act & 3. Assert
+  ASSERT_EQ(Get(Key(1)), "NOT_FOUND");
+  ASSERT_EQ(Get(Key(9)), "new");
+
+  // 重启后 filter 从 table properties 读回来，结果不变
+  Reopen(options);
+  ASSERT_EQ(Get(Key(1)), "NOT_FOUND");
+  ASSERT_EQ(Get(Key(9)), "new");
+}
+
+// 测试：重启后从 table properties 读回 filter，负查询仍然被挡掉
+TEST_F(DBTierFilterIndexTest, FiltersRebuiltOnReopen) {
+  // 1. Arrange
+  Options options = TierOptions();
+  Reopen(options);
+  for (int run = 0; run < 4; run++) {
+    for (int i = run; i < 400; i += 4) {
+      ASSERT_OK(Put(Key(i), "v" + std::to_string(i)));
+    }
+    ASSERT_OK(Flush());
+  }
+  Reopen(options);
+  ASSERT_EQ(NumTableFilesAtLevel(0), 4);
+  ASSERT_OK(options.statistics->Reset());
+
+  // 2. Act
+  ASSERT_EQ(Get(Key(200) + "x"), "NOT_FOUND");
+  const uint64_t useful_on_miss =
+      options.statistics->getTickerCount(BLOOM_FILTER_USEFUL);
+  for (int i = 0; i < 400; i++) {
+    ASSERT_EQ(Get(Key(i)), "v" + std::to_string(i));
+  }
+
+  // 3. Assert
+  ASSERT_GE(useful_on_miss, 3u);
+}
+
+// 测试：flush 和 compaction 写出的文件都把 filter 存进 table properties
+TEST_F(DBTierFilterIndexTest, FilterStoredInTableProperties) {
+  // 1. Arrange
+  Options options = TierOptions();
+  options.compaction_options_tier.files_per_tier = 2;
+  Reopen(options);
+  for (int run = 0; run < 2; run++) {
+    for (int i = run; i < 400; i += 2) {
+      ASSERT_OK(Put(Key(i), "v"));
+    }
+    ASSERT_OK(Flush());
+  }
+
+  // 2. Act
+  TablePropertiesCollection flushed;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&flushed));
+  ASSERT_OK(dbfull()->SetOptions({{"disable_auto_compactions", "false"}}));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  TablePropertiesCollection compacted;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&compacted));
+
+  // 3. Assert
+  ASSERT_EQ(flushed.size(), 2u);
+  ASSERT_EQ(NumTableFilesAtLevel(0), 0);
+  ASSERT_FALSE(compacted.empty());
+  for (const auto* collection : {&flushed, &compacted}) {
+    for (const auto& file_props : *collection) {
+      ASSERT_NE(TierKeyFilter::FromTableProperties(file_props.second),
+                nullptr);
+    }
+  }
+}
+
+// 测试：ingest 进来的文件也有 filter
+TEST_F(DBTierFilterIndexTest, IngestedFileGetsFilter) {
+  // 1. Arrange：DB 里一个偶数 key 的 run，再 ingest 一个奇数 key 的文件
+  Options options = TierOptions();
+  Reopen(options);
+  for (int i = 0; i < 400; i += 2) {
+    ASSERT_OK(Put(Key(i), "db"));
+  }
+  ASSERT_OK(Flush());
+  const std::string sst_path = dbname_ + "_ingest.sst";
+  SstFileWriter writer(EnvOptions(), options);
+  ASSERT_OK(writer.Open(sst_path));
+  for (int i = 1; i < 400; i += 2) {
+    ASSERT_OK(writer.Put(Key(i), "ingested"));
+  }
+  ASSERT_OK(writer.Finish());
+  ASSERT_OK(db_->IngestExternalFile({sst_path}, IngestExternalFileOptions()));
+  ASSERT_OK(options.statistics->Reset());
+
+  // 2. Act
+  ASSERT_EQ(Get(Key(200) + "x"), "NOT_FOUND");
+  const uint64_t useful_on_miss =
+      options.statistics->getTickerCount(BLOOM_FILTER_USEFUL);
+
+  // 3. Assert：两个文件都覆盖这个 key，都被 filter 挡掉
+  ASSERT_EQ(useful_on_miss, 2u);
+  for (int i = 0; i < 400; i++) {
+    ASSERT_EQ(Get(Key(i)), i % 2 == 0 ? "db" : "ingested");
+  }
+  ASSERT_OK(env_->DeleteFile(sst_path));
+}
+
+// 测试：查找停在删除标记上时，被跳过的 run 也计入 BLOOM_FILTER_USEFUL
+TEST_F(DBTierFilterIndexTest, CountsUsefulWhenKeyIsDeleted) {
+  // 1. Arrange：run 0 写入 key，run 1 删除它，run 2、3 的 key range 覆盖它
+  // 但不包含它
+  Options options = TierOptions();
+  Reopen(options);
+  ASSERT_OK(Put(Key(0), "v"));
+  ASSERT_OK(Put(Key(5), "v"));
+  ASSERT_OK(Put(Key(9), "v"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(Key(0), "v"));
+  ASSERT_OK(Delete(Key(5)));
+  ASSERT_OK(Put(Key(9), "v"));
+  ASSERT_OK(Flush());
+  for (int run = 2; run < 4; run++) {
+    ASSERT_OK(Put(Key(0), "v"));
+    ASSERT_OK(Put(Key(9), "v"));
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(NumTableFilesAtLevel(0), 4);
+  ASSERT_OK(options.statistics->Reset());
+
+  // 2. Act
+  ASSERT_EQ(Get(Key(5)), "NOT_FOUND");
+
+  // 3. Assert
+  ASSERT_EQ(options.statistics->getTickerCount(BLOOM_FILTER_USEFUL), 2u);
+}
+
+// 测试：filter 的内存作为 file metadata 计入 block cache，重启后重建的
+// filter 也一样
+TEST_F(DBTierFilterIndexTest, FiltersChargedAsFileMetadata) {
+  // 1. Arrange：一个文件 80000 个 key，30 bits/key 的 filter 约 300KB，
+  // 超过一个 dummy entry
+  const size_t dummy_entry_size =
+      CacheReservationManagerImpl<
+          CacheEntryRole::kFileMetadata>::GetDummyEntrySize();
+  Options options = TierOptions();
+  options.compaction_options_tier.filter_index_bits_per_key = 30;
+  BlockBasedTableOptions table_options;
+  table_options.cache_usage_options.options_overrides.insert(
+      {CacheEntryRole::kFileMetadata,
+       {/*.charged = */ CacheEntryRoleOptions::Decision::kEnabled}});
+  std::shared_ptr<TargetCacheChargeTrackingCache<CacheEntryRole::kFileMetadata>>
+      cache = std::make_shared<
+          TargetCacheChargeTrackingCache<CacheEntryRole::kFileMetadata>>(
+          NewLRUCache(64 << 20));
+  table_options.block_cache = cache;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+  ASSERT_EQ(cache->GetCacheCharge(), 0u);
+  for (int i = 0; i < 80000; i++) {
+    ASSERT_OK(Put(Key(i), "v"));
+  }
+
+  // 2. Act & 3. Assert
+  ASSERT_OK(Flush());
+  ASSERT_EQ(cache->GetCacheCharge(), 2 * dummy_entry_size);
+
+  Reopen(options);
+  ASSERT_EQ(cache->GetCacheCharge(), 2 * dummy_entry_size);
+
+  // 不建 filter 时只剩文件元数据本身
+  options.compaction_options_tier.filter_index_bits_per_key = 0;
+  Reopen(options);
+  ASSERT_EQ(cache->GetCacheCharge(), dummy_entry_size);
+}
+
+// 测试：MultiGet 在多个 run 上查同一批 key，每个 key 仍然取最新的版本
+TEST_F(DBTierFilterIndexTest, MultiGetAcrossRuns) {
+  for (bool async_io : {false, true}) {
+    for (int bits_per_key : {0, 10}) {
+      // 1. Arrange：run 0 最旧，后面的 run 覆盖或删除其中一部分 key
+      Options options = TierOptions();
+      options.compaction_options_tier.filter_index_bits_per_key = bits_per_key;
+      DestroyAndReopen(options);
+      for (int i = 0; i < 64; i++) {
+        ASSERT_OK(Put(Key(i), "r0"));
+      }
+      ASSERT_OK(Flush());
+      for (int i = 0; i < 64; i += 2) {
+        ASSERT_OK(Put(Key(i), "r1"));
+      }
+      ASSERT_OK(Flush());
+      for (int i = 0; i < 64; i += 3) {
+        ASSERT_OK(Delete(Key(i)));
+      }
+      ASSERT_OK(Flush());
+
+      // 2. Act
+      std::vector<std::string> keys;
+      for (int i = 0; i < 70; i++) {
+        keys.push_back(Key(i));
+      }
+      std::vector<std::string> values = MultiGet(keys, nullptr, async_io);
+
+      // 3. Assert
+      ASSERT_EQ(values.size(), keys.size());
+      for (int i = 0; i < 70; i++) {
+        std::string expected =
+            i >= 64 ? "NOT_FOUND" : (i % 3 == 0 ? "NOT_FOUND"
+                                                : (i % 2 == 0 ? "r1" : "r0"));
+        ASSERT_EQ(values[i], expected) << "key " << i << " async_io "
+                                       << async_io << " bits "
+                                       << bits_per_key;
+      }
+    }
+  }
+}
+
+// 测试：不走 async_io（或者没有 coroutine）时 MultiGet 也用上索引，每个文件
+// 按 newest-first 的顺序读一次
+TEST_F(DBTierFilterIndexTest, MultiGetSkipsRunsWithoutAsyncIO) {
+  // 1. Arrange：L0 上 4 个 key range 相同、key 互不相交的 run
+  Options options = TierOptions();
+  Reopen(options);
+  for (int run = 0; run < 4; run++) {
+    for (int i = run; i < 400; i += 4) {
+      ASSERT_OK(Put(Key(i), "v" + std::to_string(i)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(NumTableFilesAtLevel(0), 4);
+  ASSERT_OK(options.statistics->Reset());
+
+  // 2. Act：一半存在、一半不存在的 key
+  std::vector<std::string> keys;
+  for (int i = 0; i < 40; i++) {
+    keys.push_back(Key(i));
+    keys.push_back(Key(i) + "x");
+  }
+  std::vector<std::string> values =
+      MultiGet(keys, nullptr, /*async_io=*/false);
+
+  // 3. Assert
+  ASSERT_EQ(values.size(), keys.size());
+  for (int i = 0; i < 40; i++) {
+    ASSERT_EQ(values[2 * i], "v" + std::to_string(i));
+    ASSERT_EQ(values[2 * i + 1], "NOT_FOUND");
+  }
+  // 不存在的 key 每个至少跳过 3 个 run
+  ASSERT_GE(options.statistics->getTickerCount(BLOOM_FILTER_USEFUL), 40u * 3);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1497,9 +1497,19 @@ class VersionBuilder::Rep {
     }
 
     // add for tier compaction style
+    // Files of a tier level are ordered like L0. Ordering them by largest
+    // seqno is not enough: a merge output can carry a large seqno of one key
+    // together with an older version of another key that a file of the same
+    // level shadows. The epoch numbers record the order files arrived in the
+    // level, see Compaction::OutputEpochNumber().
     if (cfd_->ioptions().compaction_style == kCompactionStyleTier) {
       for (int level = 1; level < num_levels_; ++level) {
-        SaveSSTFilesTo(vstorage, level, *level_zero_cmp_by_seqno_);
+        if (epoch_number_requirement ==
+            EpochNumberRequirement::kMightMissing) {
+          SaveSSTFilesTo(vstorage, level, *level_zero_cmp_by_seqno_);
+        } else {
+          SaveSSTFilesTo(vstorage, level, *level_zero_cmp_by_epochno_);
+        }
       }
     } else {
       for (int level = 1; level < num_levels_; ++level) {
@@ -1646,6 +1656,16 @@ class VersionBuilder::Rep {
     return s;
   }
 
+  // add for tier compaction style
+  bool UsesTierKeyFilter(const MutableCFOptions& mutable_cf_options) const {
+    return ioptions_->compaction_style == kCompactionStyleTier &&
+           mutable_cf_options.compaction_options_tier
+                   .filter_index_bits_per_key > 0 &&
+           base_vstorage_->InternalComparator()
+                   ->user_comparator()
+                   ->timestamp_size() == 0;
+  }
+
   Status LoadTableHandlers(InternalStats* internal_stats, int max_threads,
                            bool prefetch_index_and_filter_in_cache,
                            bool is_initial_load,
@@ -1734,6 +1754,27 @@ class VersionBuilder::Rep {
           file_meta->table_reader_handle = handle;
           // Load table_reader
           file_meta->fd.table_reader = table_cache_->get_cache().Value(handle);
+          // add for tier compaction style
+          // filter 在写文件时存进了 table properties，这里直接取出来，和
+          // table reader 共用一份内存（flush/compaction 先挂上的那份就被替换
+          // 掉）。此时这些 FileMetaData 还没进任何 Version，不会和读路径并发
+          if (statuses[file_idx].ok() && UsesTierKeyFilter(mutable_cf_options)) {
+            std::shared_ptr<const TierKeyFilter> filter =
+                TierKeyFilter::FromTableProperties(
+                    file_meta->fd.table_reader->GetTableProperties());
+            if (filter) {
+              const bool had_filter = file_meta->tier_key_filter != nullptr;
+              file_meta->tier_key_filter = std::move(filter);
+              // ApplyFileAddition 按不带 filter 的大小 reserve，释放时按
+              // ApproximateMemoryUsage() 整体释放，这里把差额补上
+              if (!had_filter && file_metadata_cache_res_mgr_) {
+                Status s = file_metadata_cache_res_mgr_->UpdateCacheReservation(
+                    file_meta->tier_key_filter->ApproximateMemoryUsage(),
+                    true /* increase */);
+                s.PermitUncheckedError();
+              }
+            }
+          }
         }
       }
     });
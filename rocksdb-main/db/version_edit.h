@@ -18,6 +18,7 @@
 #include "db/blob/blob_file_addition.h"
 #include "db/blob/blob_file_garbage.h"
 #include "db/dbformat.h"
+#include "db/tier_filter_index.h"
 #include "db/wal_edit.h"
 #include "memory/arena.h"
 #include "port/malloc.h"
@@ -276,6 +277,14 @@ struct FileMetaData {
   // false, it's explicitly written to Manifest.
   bool user_defined_timestamps_persisted = true;
 
+  // add for tier compaction style
+  // Filter of the user keys of this file, written into its table properties
+  // under tier compaction style with
+  // `compaction_options_tier.filter_index_bits_per_key` set. Attached by
+  // flush and compaction, and by VersionBuilder when it loads the table
+  // reader of a file loaded from the MANIFEST or ingested.
+  std::shared_ptr<const TierKeyFilter> tier_key_filter;
+
   FileMetaData() = default;
 
   FileMetaData(uint64_t file, uint32_t file_path_id, uint64_t file_size,
@@ -387,6 +396,10 @@ struct FileMetaData {
 #endif  // ROCKSDB_MALLOC_USABLE_SIZE
     usage += smallest.size() + largest.size() + file_checksum.size() +
              file_checksum_func_name.size();
+    // add for tier compaction style
+    if (tier_key_filter) {
+      usage += tier_key_filter->ApproximateMemoryUsage();
+    }
     return usage;
   }
 
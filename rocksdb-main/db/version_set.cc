@@ -74,6 +74,7 @@
 #include "util/cast_util.h"
 #include "util/coding.h"
 #include "util/coro_utils.h"
+#include "util/defer.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 #include "util/user_comparator_wrapper.h"
@@ -144,12 +145,23 @@ Status OverlapWithIterator(const Comparator* ucmp,
 // levels. Therefore we are guaranteed that if we find data
 // in a smaller level, later levels are irrelevant (unless we
 // are MergeInProgress).
+//
+// add for tier compaction style
+// With `tier_lookup` set, every level is treated like Level-0: the files of a
+// tier are overlapping sorted runs kept in newest-first order, so each file is
+// checked against the key range (no FileIndexer / binary search) and the
+// caller stops at the first file that yields a final result.
+// When a level has a TierFilterIndex in `tier_filter_indexes`, only the files
+// the index reports as candidates are returned.
 class FilePicker {
  public:
   FilePicker(const Slice& user_key, const Slice& ikey,
              autovector<LevelFilesBrief>* file_levels, unsigned int num_levels,
              FileIndexer* file_indexer, const Comparator* user_comparator,
-             const InternalKeyComparator* internal_comparator)
+             const InternalKeyComparator* internal_comparator,
+             bool tier_lookup = false,
+             const std::vector<std::unique_ptr<TierFilterIndex>>*
+                 tier_filter_indexes = nullptr)
       : num_levels_(num_levels),
         curr_level_(static_cast<unsigned int>(-1)),
         returned_file_level_(static_cast<unsigned int>(-1)),
@@ -163,10 +175,12 @@ class FilePicker {
         ikey_(ikey),
         file_indexer_(file_indexer),
         user_comparator_(user_comparator),
-        internal_comparator_(internal_comparator) {
+        internal_comparator_(internal_comparator),
+        tier_lookup_(tier_lookup),
+        tier_filter_indexes_(tier_filter_indexes) {
     // Setup member variables to search first level.
     search_ended_ = !PrepareNextLevel();
-    if (!search_ended_) {
+    if (!search_ended_ && !tier_lookup_) {
       // Prefetch Level 0 table data to avoid cache miss if possible.
       for (unsigned int i = 0; i < (*level_files_brief_)[0].num_files; ++i) {
         auto* r = (*level_files_brief_)[0].files[i].fd.table_reader;
@@ -181,6 +195,18 @@ class FilePicker {
 
   FdWithKeyRange* GetNextFile() {
     while (!search_ended_) {  // Loops over different levels.
+      // add for tier compaction style
+      if (use_tier_candidates_) {
+        if (curr_index_in_curr_level_ < tier_candidates_.size()) {
+          const uint32_t pos = tier_candidates_[curr_index_in_curr_level_++];
+          hit_file_level_ = curr_level_;
+          returned_file_level_ = curr_level_;
+          is_hit_file_last_in_level_ = pos == curr_file_level_->num_files - 1;
+          return &curr_file_level_->files[pos];
+        }
+        search_ended_ = !PrepareNextLevel();
+        continue;
+      }
       while (curr_index_in_curr_level_ < curr_file_level_->num_files) {
         // Loops over all files in current level.
         FdWithKeyRange* f = &curr_file_level_->files[curr_index_in_curr_level_];
@@ -201,7 +227,7 @@ class FilePicker {
           // Check if key is within a file's range. If search left bound and
           // right bound point to the same find, we are sure key falls in
           // range.
-          assert(curr_level_ == 0 ||
+          assert(CurrLevelMayOverlap() ||
                  curr_index_in_curr_level_ == start_index_in_curr_level_ ||
                  user_comparator_->CompareWithoutTimestamp(
                      user_key_, ExtractUserKey(f->smallest_key)) <= 0);
@@ -215,14 +241,14 @@ class FilePicker {
 
           // Setup file search bound for the next level based on the
           // comparison results
-          if (curr_level_ > 0) {
+          if (!CurrLevelMayOverlap()) {
             file_indexer_->GetNextLevelIndex(
                 curr_level_, curr_index_in_curr_level_, cmp_smallest,
                 cmp_largest, &search_left_bound_, &search_right_bound_);
           }
           // Key falls out of current file's range
           if (cmp_smallest < 0 || cmp_largest > 0) {
-            if (curr_level_ == 0) {
+            if (CurrLevelMayOverlap()) {
               ++curr_index_in_curr_level_;
               continue;
             } else {
@@ -233,7 +259,7 @@ class FilePicker {
         }
 
         returned_file_level_ = curr_level_;
-        if (curr_level_ > 0 && cmp_largest < 0) {
+        if (!CurrLevelMayOverlap() && cmp_largest < 0) {
           // No more files to search in this level.
           search_ended_ = !PrepareNextLevel();
         } else {
@@ -256,6 +282,11 @@ class FilePicker {
   // GetNextFile()) is at the last index in its level.
   bool IsHitFileLastInLevel() { return is_hit_file_last_in_level_; }
 
+  // add for tier compaction style
+  // Files whose key range covered the key but were skipped by a
+  // TierFilterIndex so far.
+  uint64_t GetTierFilteredFiles() const { return tier_filtered_files_; }
+
  private:
   unsigned int num_levels_;
   unsigned int curr_level_;
@@ -274,6 +305,65 @@ class FilePicker {
   FileIndexer* file_indexer_;
   const Comparator* user_comparator_;
   const InternalKeyComparator* internal_comparator_;
+  // add for tier compaction style
+  bool tier_lookup_;
+  const std::vector<std::unique_ptr<TierFilterIndex>>* tier_filter_indexes_;
+  // Whether the current level is searched through tier_candidates_, the
+  // positions of its candidate files in newest-first order.
+  bool use_tier_candidates_ = false;
+  autovector<uint32_t> tier_candidates_;
+  uint64_t tier_filtered_files_ = 0;
+
+  // Files in Level-0, and in every level under tier compaction style, may
+  // overlap each other and are kept in newest-first order.
+  bool CurrLevelMayOverlap() const { return curr_level_ == 0 || tier_lookup_; }
+
+  // add for tier compaction style
+  // Asks the TierFilterIndex of the current level, if any, which files might
+  // hold the key and prefetches their table data. Returns false if the level
+  // has no index.
+  bool PrepareTierCandidates() {
+    use_tier_candidates_ = false;
+    tier_candidates_.clear();
+    const TierFilterIndex* index =
+        (tier_filter_indexes_ != nullptr &&
+         curr_level_ < tier_filter_indexes_->size())
+            ? (*tier_filter_indexes_)[curr_level_].get()
+            : nullptr;
+    if (index == nullptr) {
+      return false;
+    }
+    const size_t filtered = index->GetCandidates(user_key_, &tier_candidates_);
+    if (filtered > 0) {
+      tier_filtered_files_ += filtered;
+      PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_useful, filtered, curr_level_);
+    }
+    for (uint32_t pos : tier_candidates_) {
+      auto* r = curr_file_level_->files[pos].fd.table_reader;
+      if (r != nullptr) {
+        r->Prepare(ikey_);
+      }
+    }
+    use_tier_candidates_ = true;
+    return true;
+  }
+
+  // add for tier compaction style
+  // Prefetch table data of the runs in the current tier whose key range
+  // covers the lookup key, before any of them is searched.
+  void PrepareTierRuns() {
+    for (unsigned int i = 0; i < curr_file_level_->num_files; ++i) {
+      const FdWithKeyRange& f = curr_file_level_->files[i];
+      auto* r = f.fd.table_reader;
+      if (r != nullptr &&
+          user_comparator_->CompareWithoutTimestamp(
+              user_key_, ExtractUserKey(f.smallest_key)) >= 0 &&
+          user_comparator_->CompareWithoutTimestamp(
+              user_key_, ExtractUserKey(f.largest_key)) <= 0) {
+        r->Prepare(ikey_);
+      }
+    }
+  }
 
   // Setup local variables to search next level.
   // Returns false if there are no more levels to search.
@@ -302,9 +392,18 @@ class FilePicker {
       // any level. Otherwise, it only occurs at Level-0 (since Put/Deletes
       // are always compacted into a single entry).
       int32_t start_index;
-      if (curr_level_ == 0) {
+      if (CurrLevelMayOverlap()) {
         // On Level-0, we read through all files to check for overlap.
         start_index = 0;
+        if (tier_lookup_) {
+          if (!PrepareTierCandidates()) {
+            PrepareTierRuns();
+          } else if (tier_candidates_.empty()) {
+            // No run of this tier can hold the key.
+            curr_level_++;
+            continue;
+          }
+        }
       } else {
         // On Level-n (n>=1), files are sorted. Binary search to find the
         // earliest file whose largest key >= ikey. Search left bound and
@@ -2153,6 +2252,33 @@ void Version::AddIterators(const ReadOptions& read_options,
   }
 }
 
+namespace {
+// add for tier compaction style
+// Returns false if the sorted run lies entirely outside
+// [iterate_lower_bound, iterate_upper_bound), so it can be left out of the
+// merging iterator.
+bool TierRunMayOverlapIterateBounds(const ReadOptions& read_options,
+                                    const Comparator* ucmp,
+                                    const LevelFilesBrief& run) {
+  assert(run.num_files > 0);
+  if (read_options.iterate_lower_bound != nullptr &&
+      ucmp->CompareWithoutTimestamp(
+          ExtractUserKey(run.files[run.num_files - 1].largest_key),
+          /*a_has_ts=*/true, *read_options.iterate_lower_bound,
+          /*b_has_ts=*/false) < 0) {
+    return false;
+  }
+  if (read_options.iterate_upper_bound != nullptr &&
+      ucmp->CompareWithoutTimestamp(ExtractUserKey(run.files[0].smallest_key),
+                                    /*a_has_ts=*/true,
+                                    *read_options.iterate_upper_bound,
+                                    /*b_has_ts=*/false) >= 0) {
+    return false;
+  }
+  return true;
+}
+}  // anonymous namespace
+
 void Version::AddIteratorsForLevel(const ReadOptions& read_options,
                                    const FileOptions& soptions,
                                    MergeIteratorBuilder* merge_iter_builder,
@@ -2170,8 +2296,35 @@ void Version::AddIteratorsForLevel(const ReadOptions& read_options,
 
   auto* arena = merge_iter_builder->GetArena();
   // add for tier compaction style
-  // TODO: 是否需要修改具体的逻辑？
-  if (cfd_->ioptions().compaction_style == kCompactionStyleTier || level == 0) {
+  if (cfd_->ioptions().compaction_style == kCompactionStyleTier) {
+    // Files of a tier may overlap, but they are grouped into non-overlapping
+    // sorted runs. Each run becomes one lazily opened LevelIterator, so the
+    // heap depth follows the number of overlapping runs rather than the
+    // number of files.
+    for (const auto& run : storage_info_.TierSortedRuns(level)) {
+      if (!TierRunMayOverlapIterateBounds(read_options, user_comparator(),
+                                          run)) {
+        TEST_SYNC_POINT("Version::AddIteratorsForLevel:SkipTierRun");
+        continue;
+      }
+      auto* mem = arena->AllocateAligned(sizeof(LevelIterator));
+      std::unique_ptr<TruncatedRangeDelIterator>** tombstone_iter_ptr = nullptr;
+      auto run_iter = new (mem) LevelIterator(
+          cfd_->table_cache(), read_options, soptions,
+          cfd_->internal_comparator(), &run, mutable_cf_options_,
+          should_sample, cfd_->internal_stats()->GetFileReadHist(level),
+          TableReaderCaller::kUserIterator, IsFilterSkipped(level), level,
+          /*range_del_agg=*/nullptr,
+          /*compaction_boundaries=*/nullptr, allow_unprepared_value,
+          &tombstone_iter_ptr);
+      if (read_options.ignore_range_deletions) {
+        merge_iter_builder->AddIterator(run_iter);
+      } else {
+        merge_iter_builder->AddPointAndTombstoneIterator(
+            run_iter, nullptr /* tombstone_iter */, tombstone_iter_ptr);
+      }
+    }
+  } else if (level == 0) {
     // Merge all level zero files together since they may overlap
     std::unique_ptr<TruncatedRangeDelIterator> tombstone_iter = nullptr;
     for (size_t i = 0; i < storage_info_.LevelFilesBrief(0).num_files; i++) {
@@ -2563,10 +2716,21 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
     pinned_iters_mgr->StartPinning();
   }
 
+  // add for tier compaction style
   FilePicker fp(user_key, ikey, &storage_info_.level_files_brief_,
                 storage_info_.num_non_empty_levels_,
                 &storage_info_.file_indexer_, user_comparator(),
-                internal_comparator());
+                internal_comparator(),
+                cfd_->ioptions().compaction_style == kCompactionStyleTier,
+                &storage_info_.tier_filter_indexes_);
+  // 不管查找停在哪个状态（找到、删除、corruption、出错），被 filter 跳过的
+  // 文件都要计入 BLOOM_FILTER_USEFUL
+  Defer record_tier_filtered_files([&]() {
+    if (fp.GetTierFilteredFiles() > 0) {
+      RecordTick(db_statistics_, BLOOM_FILTER_USEFUL,
+                 fp.GetTierFilteredFiles());
+    }
+  });
   FdWithKeyRange* f = fp.GetNextFile();
 
   while (f != nullptr) {
@@ -2760,13 +2924,17 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
   // blob_file => [[blob_idx, it], ...]
   std::unordered_map<uint64_t, BlobReadContexts> blob_ctxs;
   MultiGetRange keys_with_blobs_range(*range, range->begin(), range->end());
+  // add for tier compaction style
+  if (cfd_->ioptions().compaction_style == kCompactionStyleTier) {
+    s = MultiGetTier(read_options, range, &blob_ctxs);
+  }
 #if USE_COROUTINES
-  if (read_options.async_io && read_options.optimize_multiget_for_io &&
-      using_coroutines() && use_async_io_) {
+  else if (read_options.async_io && read_options.optimize_multiget_for_io &&
+           using_coroutines() && use_async_io_) {
     s = MultiGetAsync(read_options, range, &blob_ctxs);
-  } else
+  }
 #endif  // USE_COROUTINES
-  {
+  else {
     MultiGetRange file_picker_range(*range, range->begin(), range->end());
     FilePickerMultiGet fp(&file_picker_range, &storage_info_.level_files_brief_,
                           storage_info_.num_non_empty_levels_,
@@ -3202,7 +3370,170 @@ Status Version::MultiGetAsync(
 
   return s;
 }
-#endif
+
+#endif  // USE_COROUTINES
+
+// add for tier compaction style
+// 一个 tier 内的多个 run 互相重叠，FilePickerMultiGet 只能像 L0 一样一个文件
+// 一个文件地查。这里按轮次来查：每一轮里每个 key 只去它下一个（更旧的）候选
+// 文件，落在不同文件上的 key 由各自的 coroutine 并行去读。同一个 key 在一轮里
+// 只属于一个文件，所以它的 GetContext 不会被并发访问，而且访问顺序仍然是
+// newest-first。
+// 没有 coroutine（或者没开 async_io）时每一轮只读一个文件：所有 key 的下一个
+// 候选里最新的那个，这样每个文件最多读一次，TierFilterIndex 照样生效。
+Status Version::MultiGetTier(
+    const ReadOptions& read_options, MultiGetRange* range,
+    std::unordered_map<uint64_t, BlobReadContexts>* blob_ctxs) {
+  Status s;
+  uint64_t num_level_read = 0;
+  uint64_t tier_filtered_files = 0;
+  const bool parallel =
+      read_options.async_io && using_coroutines() && use_async_io_;
+  for (int level = 0; s.ok() && level < storage_info_.num_non_empty_levels_;
+       level++) {
+    MultiGetRange level_range(*range, range->begin(), range->end());
+    if (level_range.empty()) {
+      break;
+    }
+    const LevelFilesBrief& files = storage_info_.level_files_brief_[level];
+    if (files.num_files == 0) {
+      continue;
+    }
+
+    // Candidate files of every key, in newest-first order
+    std::array<autovector<uint32_t>, MultiGetContext::MAX_BATCH_SIZE>
+        candidates;
+    std::array<size_t, MultiGetContext::MAX_BATCH_SIZE> next_candidate{};
+    const TierFilterIndex* index = storage_info_.GetTierFilterIndex(level);
+    for (auto iter = level_range.begin(); iter != level_range.end(); ++iter) {
+      autovector<uint32_t>& key_candidates = candidates[iter.index()];
+      if (index != nullptr) {
+        tier_filtered_files +=
+            index->GetCandidates(iter->ukey_without_ts, &key_candidates);
+        continue;
+      }
+      for (uint32_t i = 0; i < files.num_files; i++) {
+        const FdWithKeyRange& f = files.files[i];
+        if (user_comparator()->CompareWithoutTimestamp(
+                iter->ukey_without_ts, false, ExtractUserKey(f.smallest_key),
+                true) >= 0 &&
+            user_comparator()->CompareWithoutTimestamp(
+                iter->ukey_without_ts, false, ExtractUserKey(f.largest_key),
+                true) <= 0) {
+          key_candidates.push_back(i);
+        }
+      }
+    }
+
+    uint64_t num_filter_read = 0;
+    uint64_t num_index_read = 0;
+    uint64_t num_sst_read = 0;
+    while (s.ok()) {
+      // file position => keys (bit per batch index) probed in it this round
+      autovector<std::pair<uint32_t, MultiGetContext::Mask>> round;
+      for (auto iter = level_range.begin(); iter != level_range.end();
+           ++iter) {
+        const size_t idx = iter.index();
+        // A covering range tombstone was found in a newer run, the older
+        // runs only hold covered keys.
+        if (iter->max_covering_tombstone_seq > 0 ||
+            next_candidate[idx] >= candidates[idx].size()) {
+          continue;
+        }
+        const uint32_t pos = candidates[idx][next_candidate[idx]];
+        if (!parallel && !round.empty() && round[0].first != pos) {
+          if (pos > round[0].first) {
+            continue;
+          }
+          round.clear();
+        }
+        auto it = std::find_if(
+            round.begin(), round.end(),
+            [pos](const std::pair<uint32_t, MultiGetContext::Mask>& p) {
+              return p.first == pos;
+            });
+        if (it == round.end()) {
+          round.emplace_back(pos, MultiGetContext::Mask{1} << idx);
+        } else {
+          it->second |= MultiGetContext::Mask{1} << idx;
+        }
+      }
+      if (round.empty()) {
+        break;
+      }
+
+#if USE_COROUTINES
+      std::vector<folly::coro::Task<Status>> mget_tasks;
+#endif  // USE_COROUTINES
+      for (const auto& file_keys : round) {
+        MultiGetRange file_range(level_range, level_range.begin(),
+                                 level_range.end());
+        for (auto iter = file_range.begin(); iter != file_range.end();
+             ++iter) {
+          const MultiGetContext::Mask bit = MultiGetContext::Mask{1}
+                                            << iter.index();
+          if (!(file_keys.second & bit)) {
+            file_range.SkipKey(iter);
+          } else {
+            next_candidate[iter.index()]++;
+          }
+        }
+        FdWithKeyRange* f = &files.files[file_keys.first];
+        const bool skip_filters = IsFilterSkipped(
+            level, file_keys.first == files.num_files - 1);
+#if USE_COROUTINES
+        if (round.size() > 1) {
+          mget_tasks.emplace_back(MultiGetFromSSTCoroutine(
+              read_options, file_range, level, skip_filters,
+              /*skip_range_deletions=*/false, f, *blob_ctxs,
+              /*table_handle=*/nullptr, num_filter_read, num_index_read,
+              num_sst_read));
+          continue;
+        }
+#endif  // USE_COROUTINES
+        assert(round.size() == 1);
+        s = MultiGetFromSST(read_options, file_range, level, skip_filters,
+                            /*skip_range_deletions=*/false, f, *blob_ctxs,
+                            /*table_handle=*/nullptr, num_filter_read,
+                            num_index_read, num_sst_read);
+      }
+#if USE_COROUTINES
+      if (!mget_tasks.empty()) {
+        RecordTick(db_statistics_, MULTIGET_COROUTINE_COUNT,
+                   mget_tasks.size());
+        std::vector<Status> statuses =
+            folly::coro::blockingWait(co_withExecutor(
+                &range->context()->executor(),
+                folly::coro::collectAllRange(std::move(mget_tasks))));
+        for (Status& stat : statuses) {
+          if (!stat.ok()) {
+            s = std::move(stat);
+            break;
+          }
+        }
+      }
+#endif  // USE_COROUTINES
+    }
+
+    if (num_filter_read + num_index_read) {
+      RecordInHistogram(db_statistics_,
+                        NUM_INDEX_AND_FILTER_BLOCKS_READ_PER_LEVEL,
+                        num_index_read + num_filter_read);
+    }
+    if (num_sst_read) {
+      RecordInHistogram(db_statistics_, NUM_SST_READ_PER_LEVEL, num_sst_read);
+      num_level_read++;
+    }
+  }
+  if (num_level_read) {
+    RecordInHistogram(db_statistics_, NUM_LEVEL_READ_PER_MULTIGET,
+                      num_level_read);
+  }
+  if (tier_filtered_files > 0) {
+    RecordTick(db_statistics_, BLOOM_FILTER_USEFUL, tier_filtered_files);
+  }
+  return s;
+}
 
 bool Version::IsFilterSkipped(int level, bool is_file_last_in_level) {
   // Reaching the bottom level implies misses at all upper levels, so we'll
@@ -3220,6 +3551,67 @@ void VersionStorageInfo::GenerateLevelFilesBrief() {
   }
 }
 
+// add for tier compaction style
+void VersionStorageInfo::GenerateTierSortedRuns() {
+  tier_sorted_runs_.clear();
+  if (compaction_style_ != kCompactionStyleTier) {
+    return;
+  }
+  tier_sorted_runs_.resize(num_non_empty_levels_);
+  for (int level = 0; level < num_non_empty_levels_; level++) {
+    // MergingIterator applies the range tombstones of a child only to the
+    // children after it, so of two overlapping files the newer one must sit
+    // in an earlier run. Files are taken newest-first (files_ order) and each
+    // one goes into the run right after the last run holding a newer file it
+    // overlaps. Files that overlap nothing newer still share the first runs.
+    const std::vector<FileMetaData*>& files = files_[level];
+    std::vector<size_t> run_of(files.size());
+    std::vector<std::vector<FileMetaData*>> runs;
+    for (size_t i = 0; i < files.size(); i++) {
+      size_t target = 0;
+      for (size_t j = 0; j < i; j++) {
+        if (run_of[j] >= target &&
+            user_comparator_->Compare(files[j]->largest.user_key(),
+                                      files[i]->smallest.user_key()) >= 0 &&
+            user_comparator_->Compare(files[i]->largest.user_key(),
+                                      files[j]->smallest.user_key()) >= 0) {
+          target = run_of[j] + 1;
+        }
+      }
+      run_of[i] = target;
+      if (target == runs.size()) {
+        runs.emplace_back();
+      }
+      runs[target].push_back(files[i]);
+    }
+    for (auto& run : runs) {
+      std::sort(run.begin(), run.end(),
+                [this](const FileMetaData* f1, const FileMetaData* f2) {
+                  return internal_comparator_->Compare(f1->smallest,
+                                                       f2->smallest) < 0;
+                });
+      tier_sorted_runs_[level].emplace_back();
+      DoGenerateLevelFilesBrief(&tier_sorted_runs_[level].back(), run,
+                                &arena_);
+    }
+  }
+}
+
+// add for tier compaction style
+void VersionStorageInfo::GenerateTierFilterIndexes() {
+  tier_filter_indexes_.clear();
+  if (compaction_style_ != kCompactionStyleTier) {
+    return;
+  }
+  tier_filter_indexes_.resize(num_non_empty_levels_);
+  for (int level = 0; level < num_non_empty_levels_; level++) {
+    // Same newest-first order as level_files_brief_, so a candidate position
+    // is also an index into level_files_brief_[level].
+    tier_filter_indexes_[level] =
+        TierFilterIndex::Build(files_[level], user_comparator_);
+  }
+}
+
 void VersionStorageInfo::PrepareForVersionAppend(
     const ImmutableOptions& immutable_options,
     const MutableCFOptions& mutable_cf_options) {
@@ -3229,6 +3621,8 @@ void VersionStorageInfo::PrepareForVersionAppend(
   UpdateFilesByCompactionPri(immutable_options, mutable_cf_options);
   GenerateFileIndexer();
   GenerateLevelFilesBrief();
+  GenerateTierSortedRuns();
+  GenerateTierFilterIndexes();
   GenerateLevel0NonOverlapping();
   GenerateBottommostFiles();
   GenerateFileLocationIndex();
@@ -3412,6 +3806,12 @@ int VersionStorageInfo::MaxOutputLevel(bool allow_ingest_behind) const {
 
 void VersionStorageInfo::EstimateCompactionBytesNeeded(
     const MutableCFOptions& mutable_cf_options) {
+  // add for tier compaction style
+  if (compaction_style_ == kCompactionStyleTier) {
+    EstimateTierCompactionBytesNeeded(mutable_cf_options);
+    return;
+  }
+
   // Only implemented for level-based compaction
   if (compaction_style_ != kCompactionStyleLevel) {
     estimated_compaction_needed_bytes_ = 0;
@@ -3495,6 +3895,64 @@ void VersionStorageInfo::EstimateCompactionBytesNeeded(
   }
 }
 
+// add for tier compaction style
+// Tier 的 compaction 债务估计：从 Level 0 开始，如果某层文件数（加上上一层
+// 合并下来的新 run）达到该层的 T，或者满足 size ratio 触发条件，那么整层都会被
+// 重写一次并作为一个新的 sorted run 落到下一层。下一层因此可能也被触发，如此
+// 级联下去。累加每次被触发时整层的字节数，就得到了 "满的 tier 字节数 × 预期
+// 重写扇出"。lazy leveling 下合并进最后一层时，最后一层也要被重写。
+void VersionStorageInfo::EstimateTierCompactionBytesNeeded(
+    const MutableCFOptions& mutable_cf_options) {
+  estimated_compaction_needed_bytes_ = 0;
+
+  const CompactionOptionsTier& tier_options =
+      mutable_cf_options.compaction_options_tier;
+  uint64_t bytes_compact_to_next_level = 0;
+  size_t files_compact_to_next_level = 0;
+  for (int level = 0; level <= MaxInputLevel(); level++) {
+    uint64_t level_size = bytes_compact_to_next_level;
+    for (auto* f : files_[level]) {
+      level_size += f->fd.GetFileSize();
+    }
+    const size_t level_files =
+        files_[level].size() + files_compact_to_next_level;
+    uint64_t next_level_size = 0;
+    for (auto* f : files_[level + 1]) {
+      next_level_size += f->fd.GetFileSize();
+    }
+
+    bytes_compact_to_next_level = 0;
+    files_compact_to_next_level = 0;
+    const int T = mutable_cf_options.FilesPerTier(level);
+    bool triggered = T > 0 && level_files >= static_cast<size_t>(T);
+    if (!triggered && tier_options.size_ratio > 0 && next_level_size > 0) {
+      triggered = level_size * static_cast<uint64_t>(tier_options.size_ratio) >=
+                  next_level_size;
+    }
+    if (!triggered) {
+      continue;
+    }
+
+    // The whole tier is rewritten into the next level.
+    estimated_compaction_needed_bytes_ += level_size;
+    bytes_compact_to_next_level = level_size;
+    if (tier_options.lazy_leveling && level + 1 == num_levels_ - 1) {
+      // The last level is merged together with the incoming run.
+      estimated_compaction_needed_bytes_ += next_level_size;
+    }
+
+    // The output is cut into files of the next level's target size.
+    uint64_t target_file_size = MaxFileSizeForLevel(
+        mutable_cf_options, level + 1, compaction_style_);
+    if (target_file_size == 0) {
+      files_compact_to_next_level = 1;
+    } else {
+      files_compact_to_next_level = static_cast<size_t>(std::max<uint64_t>(
+          1, (level_size + target_file_size - 1) / target_file_size));
+    }
+  }
+}
+
 namespace {
 uint32_t GetExpiredTtlFilesCount(const ImmutableOptions& ioptions,
                                  const MutableCFOptions& mutable_cf_options,
@@ -3568,6 +4026,41 @@ bool ShouldChangeFileTemperature(const ImmutableOptions& ioptions,
 }
 }  // anonymous namespace
 
+// add for tier compaction style
+double VersionStorageInfo::TierLevelScore(
+    int level, const MutableCFOptions& mutable_cf_options) const {
+  size_t num_files = 0;
+  uint64_t level_bytes_no_compacting = 0;
+  for (auto* f : files_[level]) {
+    if (!f->being_compacted) {
+      num_files++;
+      level_bytes_no_compacting += f->fd.GetFileSize();
+    }
+  }
+
+  // max T files in one level
+  const int T = mutable_cf_options.FilesPerTier(level);
+  double score = 0;
+  if (T > 0) {
+    score = static_cast<double>(num_files) / T;
+  }
+
+  // 可选的 size ratio 触发：本层达到下一层大小的 1/size_ratio 时也需要合并
+  const int size_ratio = mutable_cf_options.compaction_options_tier.size_ratio;
+  if (size_ratio > 0 && level + 1 < num_levels_) {
+    uint64_t next_level_bytes = 0;
+    for (auto* f : files_[level + 1]) {
+      next_level_bytes += f->fd.GetFileSize();
+    }
+    if (next_level_bytes > 0) {
+      score = std::max(score, static_cast<double>(level_bytes_no_compacting) *
+                                  size_ratio /
+                                  static_cast<double>(next_level_bytes));
+    }
+  }
+  return score;
+}
+
 void VersionStorageInfo::ComputeCompactionScore(
     const ImmutableOptions& immutable_options,
     const MutableCFOptions& mutable_cf_options) {
@@ -3707,19 +4200,7 @@ void VersionStorageInfo::ComputeCompactionScore(
         // add for tier compaction style
         // level = 0
         if (compaction_style_ == kCompactionStyleTier) {
-          // max T files in one level
-          const int T = mutable_cf_options.compaction_options_tier.files_per_tier;
-          if (T <= 0) {
-            score = 0;
-          }
-
-          size_t num_files = 0;
-          for (auto* f : files_[level]) {
-            if (!f->being_compacted) {
-              num_files++;
-            }
-          }
-          score = static_cast<double>(num_files) / T;
+          score = TierLevelScore(level, mutable_cf_options);
         }
       }
     } else {  // level > 0
@@ -3769,19 +4250,7 @@ void VersionStorageInfo::ComputeCompactionScore(
       // add for tier compaction style
       // level != 0
       if (compaction_style_ == kCompactionStyleTier) {
-        // max T files in one level
-        const int T = mutable_cf_options.compaction_options_tier.files_per_tier;
-        if (T <= 0) {
-          score = 0;
-        }
-
-        size_t num_files = 0;
-        for (auto* f : files_[level]) {
-          if (!f->being_compacted) {
-            num_files++;
-          }
-        }
-        score = static_cast<double>(num_files) / T;
+        score = TierLevelScore(level, mutable_cf_options);
       }
     }
     compaction_level_[level] = level;
@@ -4482,7 +4951,11 @@ bool VersionStorageInfo::OverlapInLevel(int level,
     // empty level, no overlap
     return false;
   }
-  return SomeFileOverlapsRange(*internal_comparator_, (level > 0),
+  // add for tier compaction style
+  // Files of a tier level overlap each other like the ones of L0
+  const bool disjoint_sorted_files =
+      level > 0 && compaction_style_ != kCompactionStyleTier;
+  return SomeFileOverlapsRange(*internal_comparator_, disjoint_sorted_files,
                                level_files_brief_[level], smallest_user_key,
                                largest_user_key);
 }
@@ -4505,7 +4978,8 @@ void VersionStorageInfo::GetOverlappingInputs(
     *file_index = -1;
   }
   const Comparator* user_cmp = user_comparator_;
-  if (level > 0) {
+  // add for tier compaction style
+  if (level > 0 && compaction_style_ != kCompactionStyleTier) {
     GetOverlappingInputsRangeBinarySearch(level, begin, end, inputs, hint_index,
                                           file_index, false, next_smallest);
     return;
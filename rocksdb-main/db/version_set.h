@@ -44,6 +44,7 @@
 #include "db/range_del_aggregator.h"
 #include "db/read_callback.h"
 #include "db/table_cache.h"
+#include "db/tier_filter_index.h"
 #include "db/version_builder.h"
 #include "db/version_edit.h"
 #include "db/write_controller.h"
@@ -310,6 +311,9 @@ class VersionStorageInfo {
 
   int num_levels() const { return num_levels_; }
 
+  // add for tier compaction style
+  CompactionStyle compaction_style() const { return compaction_style_; }
+
   // REQUIRES: PrepareForVersionAppend has been called
   int num_non_empty_levels() const {
     assert(finalized_);
@@ -463,6 +467,39 @@ class VersionStorageInfo {
     return level_files_brief_[level];
   }
 
+  // add for tier compaction style
+  // Compaction score of `level` under tier compaction style: the number of
+  // files not being compacted over the level's T, or, with
+  // compaction_options_tier.size_ratio set, the size of the level relative to
+  // 1/size_ratio of the next level, whichever is larger. >= 1 means the level
+  // should be merged into the next one.
+  double TierLevelScore(int level,
+                        const MutableCFOptions& mutable_cf_options) const;
+
+  // add for tier compaction style
+  // REQUIRES: PrepareForVersionAppend has been called
+  // The files of a tier partitioned into non-overlapping groups, newest
+  // first: of two overlapping files the newer one is in an earlier group.
+  // Files inside one group are sorted by key so the group can be scanned
+  // like a regular level. Empty unless compaction style is tier.
+  const autovector<ROCKSDB_NAMESPACE::LevelFilesBrief>& TierSortedRuns(
+      int level) const {
+    assert(finalized_);
+    assert(level < static_cast<int>(tier_sorted_runs_.size()));
+    return tier_sorted_runs_[level];
+  }
+
+  // add for tier compaction style
+  // REQUIRES: PrepareForVersionAppend has been called
+  // Index over the key filters of the files of a tier, nullptr when the
+  // level has no file with a TierKeyFilter.
+  const TierFilterIndex* GetTierFilterIndex(int level) const {
+    assert(finalized_);
+    return level < static_cast<int>(tier_filter_indexes_.size())
+               ? tier_filter_indexes_[level].get()
+               : nullptr;
+  }
+
   // REQUIRES: PrepareForVersionAppend has been called
   const std::vector<int>& FilesByCompactionPri(int level) const {
     assert(finalized_);
@@ -653,6 +690,13 @@ class VersionStorageInfo {
   }
 
   void GenerateLevelFilesBrief();
+  // add for tier compaction style
+  void GenerateTierSortedRuns();
+  // add for tier compaction style
+  void GenerateTierFilterIndexes();
+  // add for tier compaction style
+  void EstimateTierCompactionBytesNeeded(
+      const MutableCFOptions& mutable_cf_options);
   void GenerateLevel0NonOverlapping();
   void GenerateBottommostFiles();
   void GenerateFileLocationIndex();
@@ -667,6 +711,13 @@ class VersionStorageInfo {
 
   // A short brief metadata of files per level
   autovector<ROCKSDB_NAMESPACE::LevelFilesBrief> level_files_brief_;
+  // add for tier compaction style
+  // Per level, the non-overlapping sorted runs of a tier
+  std::vector<autovector<ROCKSDB_NAMESPACE::LevelFilesBrief>>
+      tier_sorted_runs_;
+  // add for tier compaction style
+  // Per level, see GetTierFilterIndex()
+  std::vector<std::unique_ptr<TierFilterIndex>> tier_filter_indexes_;
   FileIndexer file_indexer_;
   Arena arena_;  // Used to allocate space for file_levels_
 
@@ -1126,6 +1177,15 @@ class Version {
           mget_stats);
 #endif
 
+  // add for tier compaction style
+  // MultiGet under tier compaction style. Every key visits the runs of a
+  // tier in newest-first order, skipping the runs its TierFilterIndex rules
+  // out. With async_io and coroutines the lookups of a batch in different
+  // files are issued in parallel, otherwise the files are read one at a time.
+  Status MultiGetTier(
+      const ReadOptions& read_options, MultiGetRange* range,
+      std::unordered_map<uint64_t, BlobReadContexts>* blob_ctxs);
+
   ColumnFamilyData* cfd_;  // ColumnFamilyData to which this Version belongs
   Logger* info_log_;
   Statistics* db_statistics_;
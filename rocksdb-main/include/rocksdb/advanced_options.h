@@ -77,6 +77,40 @@ struct CompactionOptionsTier {
   // T
   int files_per_tier = 5;
 
+  // Per-level T. files_per_tier_per_level[i] is the number of files that
+  // triggers a merge of level i. Levels past the end of the vector, or with a
+  // non-positive entry, fall back to files_per_tier. A small T on the upper
+  // levels favours reads, a large one favours writes.
+  //
+  // Dynamically changeable through SetOptions() API, e.g.,
+  //   SetOptions("compaction_options_tier",
+  //   "{files_per_tier_per_level=8:8:4:4}")
+  std::vector<int> files_per_tier_per_level;
+
+  // Size-ratio trigger. When > 0, a level other than the last one is also
+  // merged once size(level) * size_ratio >= size(level + 1), i.e. once it has
+  // grown to 1/size_ratio of the level below, regardless of its file count.
+  // The trigger is ignored while the next level is empty.
+  // 0 disables it.
+  int size_ratio = 0;
+
+  // Lazy leveling (Dostoevsky): the upper levels are tiered, but the last
+  // level is kept as a single sorted run. A merge into the last level also
+  // takes the overlapping files of the last level as inputs.
+  bool lazy_leveling = false;
+
+  // Bits per key of the in-memory key filter kept for every table file. The
+  // filter is stored in the table properties of the files written by flush,
+  // compaction and SstFileWriter (when it is given these options), and is
+  // read back with the table reader on open. The filters of a tier are
+  // aggregated into a per-level index, so a point lookup skips the runs that
+  // cannot hold the key without going through the table cache and their
+  // filter blocks. Files without a stored filter, and files whose table
+  // reader is not loaded on open (limited max_open_files), are always
+  // searched. Costs about bits_per_key / 8 bytes of memory per key, charged
+  // to the block cache as CacheEntryRole::kFileMetadata. 0 disables it.
+  int filter_index_bits_per_key = 0;
+
   bool operator==(const CompactionOptionsTier& rhs) const = default;
 };
 
@@ -634,6 +668,8 @@ struct AdvancedColumnFamilyOptions {
   // The options for tier compaction style
   //
   // Dynamically changeable through SetOptions() API
+  // Dynamic change example:
+  // SetOptions("compaction_options_tier", "{files_per_tier=4;size_ratio=10;}")
   // add for tier compaction style
   CompactionOptionsTier compaction_options_tier;
 
@@ -1622,6 +1622,34 @@ struct DBOptions {
   // this field blank. Default: Empty string (no offpeak).
   std::string daily_offpeak_time_utc = "";
 
+  // add for ADOC tuner
+  // If non-zero, every `auto_tune_period_sec` seconds the DB scores how its
+  // write path did during the last period (user bytes written, flush
+  // bandwidth, immutable memtables, L0 files and pending compaction bytes of
+  // the default column family) and adjusts max_background_jobs and the
+  // default column family's write_buffer_size to head off write stalls:
+  // more background jobs when flushes queue up or L0 / pending compaction
+  // bytes reach their slowdown triggers, fewer when the flush bandwidth
+  // collapses; larger memtables when flushes are slow or queue up, smaller
+  // ones when pending compaction bytes reach the soft limit. Under level
+  // compaction target_file_size_base and max_bytes_for_level_base follow the
+  // memtable size.
+  //
+  // The new values are written to the OPTIONS file like the ones set through
+  // SetDBOptions() / SetOptions(). max_background_jobs has no effect when the
+  // legacy max_background_flushes / max_background_compactions are set.
+  //
+  // Default: 0 (disabled)
+  uint64_t auto_tune_period_sec = 0;
+
+  // Upper bound of max_background_jobs for the tuner. 0 means the number of
+  // hardware threads.
+  int auto_tune_max_background_jobs = 0;
+
+  // Upper bound of write_buffer_size for the tuner. 0 means 8 times the
+  // write_buffer_size the default column family was opened with.
+  uint64_t auto_tune_max_write_buffer_size = 0;
+
   // EXPERIMENTAL
 
   // When a RocksDB database is opened in follower mode, this option
@@ -453,7 +453,8 @@ static void ManualCompaction(benchmark::State& state) {
 }
 
 static void ManualCompactionArguments(benchmark::internal::Benchmark* b) {
-  for (int comp_style : {kCompactionStyleLevel, kCompactionStyleUniversal}) {
+  for (int comp_style : {kCompactionStyleLevel, kCompactionStyleUniversal,
+                         kCompactionStyleTier}) {
     for (int64_t max_data : {32l << 20, 128l << 20}) {
       for (int64_t per_key_size : {256, 1024}) {
         for (bool enable_statistics : {false, true}) {
@@ -619,10 +620,22 @@ static void DBGet(benchmark::State& state) {
       }
     }
 
-    // Compact whole DB into one level, so each iteration will consider the same
-    // number of files (one).
-    Status s = db->CompactRange(CompactRangeOptions(), nullptr /* begin */,
-                                nullptr /* end */);
+    Status s;
+    if (compaction_style == kCompactionStyleTier) {
+      // add for tier compaction style
+      // tier 不支持 CompactRange，这里只等自动 compaction 收敛，
+      // 测的是 tier 在稳态下多个 sorted run 的读放大。
+      s = db->Flush(FlushOptions());
+      if (s.ok()) {
+        auto db_full = static_cast_with_check<DBImpl>(db.get());
+        s = db_full->WaitForCompact(WaitForCompactOptions());
+      }
+    } else {
+      // Compact whole DB into one level, so each iteration will consider the
+      // same number of files (one).
+      s = db->CompactRange(CompactRangeOptions(), nullptr /* begin */,
+                           nullptr /* end */);
+    }
     if (!s.ok()) {
       state.SkipWithError(s.ToString().c_str());
     }
@@ -670,7 +683,7 @@ static void DBGet(benchmark::State& state) {
 
 static void DBGetArguments(benchmark::internal::Benchmark* b) {
   for (int comp_style : {kCompactionStyleLevel, kCompactionStyleUniversal,
-                         kCompactionStyleFIFO}) {
+                         kCompactionStyleFIFO, kCompactionStyleTier}) {
     for (int64_t max_data : {1l << 20, 128l << 20, 512l << 20}) {
       for (int64_t per_key_size : {256, 1024}) {
         for (bool enable_statistics : {false, true}) {
@@ -1182,7 +1195,7 @@ static void IteratorSeek(benchmark::State& state) {
 
 static void IteratorSeekArguments(benchmark::internal::Benchmark* b) {
   for (int comp_style : {kCompactionStyleLevel, kCompactionStyleUniversal,
-                         kCompactionStyleFIFO}) {
+                         kCompactionStyleFIFO, kCompactionStyleTier}) {
     for (int64_t max_data : {128l << 20, 512l << 20}) {
       for (int64_t per_key_size : {256, 1024}) {
         for (bool enable_statistics : {false, true}) {
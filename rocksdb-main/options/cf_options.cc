@@ -356,6 +356,30 @@ static std::unordered_map<std::string, OptionTypeInfo>
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}}};
 
+// add for tier compaction style
+static std::unordered_map<std::string, OptionTypeInfo>
+    tier_compaction_options_type_info = {
+        {"files_per_tier",
+         {offsetof(struct CompactionOptionsTier, files_per_tier),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"files_per_tier_per_level",
+         OptionTypeInfo::Vector<int>(
+             offsetof(struct CompactionOptionsTier, files_per_tier_per_level),
+             OptionVerificationType::kNormal, OptionTypeFlags::kMutable,
+             {0, OptionType::kInt})},
+        {"size_ratio",
+         {offsetof(struct CompactionOptionsTier, size_ratio), OptionType::kInt,
+          OptionVerificationType::kNormal, OptionTypeFlags::kMutable}},
+        {"lazy_leveling",
+         {offsetof(struct CompactionOptionsTier, lazy_leveling),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"filter_index_bits_per_key",
+         {offsetof(struct CompactionOptionsTier, filter_index_bits_per_key),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}}};
+
 static std::unordered_map<std::string, OptionTypeInfo>
     cf_mutable_options_type_info = {
         {"report_bg_io_stats",
@@ -558,6 +582,12 @@ static std::unordered_map<std::string, OptionTypeInfo>
              &universal_compaction_options_type_info,
              offsetof(struct MutableCFOptions, compaction_options_universal),
              OptionVerificationType::kNormal, OptionTypeFlags::kMutable)},
+        // add for tier compaction style
+        {"compaction_options_tier",
+         OptionTypeInfo::Struct(
+             "compaction_options_tier", &tier_compaction_options_type_info,
+             offsetof(struct MutableCFOptions, compaction_options_tier),
+             OptionVerificationType::kNormal, OptionTypeFlags::kMutable)},
         {"ttl",
          {offsetof(struct MutableCFOptions, ttl), OptionType::kUInt64T,
           OptionVerificationType::kNormal, OptionTypeFlags::kMutable}},
@@ -1248,6 +1278,27 @@ void MutableCFOptions::Dump(Logger* log) const {
   ROCKS_LOG_INFO(log, "compaction_options_fifo.allow_compaction : %d",
                  compaction_options_fifo.allow_compaction);
 
+  // Tier Compaction Options
+  // add for tier compaction style
+  ROCKS_LOG_INFO(log, "compaction_options_tier.files_per_tier : %d",
+                 compaction_options_tier.files_per_tier);
+  result.clear();
+  for (const auto t : compaction_options_tier.files_per_tier_per_level) {
+    snprintf(buf, sizeof(buf), "%d, ", t);
+    result += buf;
+  }
+  if (result.size() >= 2) {
+    result.resize(result.size() - 2);
+  }
+  ROCKS_LOG_INFO(log, "compaction_options_tier.files_per_tier_per_level : %s",
+                 result.c_str());
+  ROCKS_LOG_INFO(log, "compaction_options_tier.size_ratio : %d",
+                 compaction_options_tier.size_ratio);
+  ROCKS_LOG_INFO(log, "compaction_options_tier.lazy_leveling : %d",
+                 static_cast<int>(compaction_options_tier.lazy_leveling));
+  ROCKS_LOG_INFO(log, "compaction_options_tier.filter_index_bits_per_key : %d",
+                 compaction_options_tier.filter_index_bits_per_key);
+
   // Blob file related options
   ROCKS_LOG_INFO(log, "                        enable_blob_files: %s",
                  enable_blob_files ? "true" : "false");
@@ -259,6 +259,16 @@ struct MutableCFOptions {
     return max_bytes_for_level_multiplier_additional[level];
   }
 
+  // add for tier compaction style
+  // T of the given level under tier compaction style.
+  int FilesPerTier(int level) const {
+    const auto& per_level = compaction_options_tier.files_per_tier_per_level;
+    if (level < static_cast<int>(per_level.size()) && per_level[level] > 0) {
+      return per_level[level];
+    }
+    return compaction_options_tier.files_per_tier;
+  }
+
   void Dump(Logger* log) const;
 
   bool operator==(const MutableCFOptions& rhs) const = default;
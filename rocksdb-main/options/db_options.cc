@@ -574,6 +574,19 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, enforce_single_del_contracts),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        // add for ADOC tuner
+        {"auto_tune_period_sec",
+         {offsetof(struct ImmutableDBOptions, auto_tune_period_sec),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"auto_tune_max_background_jobs",
+         {offsetof(struct ImmutableDBOptions, auto_tune_max_background_jobs),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"auto_tune_max_write_buffer_size",
+         {offsetof(struct ImmutableDBOptions, auto_tune_max_write_buffer_size),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"follower_refresh_catchup_period_ms",
          {offsetof(struct ImmutableDBOptions,
                    follower_refresh_catchup_period_ms),
@@ -795,6 +808,9 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       lowest_used_cache_tier(options.lowest_used_cache_tier),
       compaction_service(options.compaction_service),
       enforce_single_del_contracts(options.enforce_single_del_contracts),
+      auto_tune_period_sec(options.auto_tune_period_sec),
+      auto_tune_max_background_jobs(options.auto_tune_max_background_jobs),
+      auto_tune_max_write_buffer_size(options.auto_tune_max_write_buffer_size),
       follower_refresh_catchup_period_ms(
           options.follower_refresh_catchup_period_ms),
       follower_catchup_retry_count(options.follower_catchup_retry_count),
@@ -984,6 +1000,14 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    db_host_id.c_str());
   ROCKS_LOG_HEADER(log, "            Options.enforce_single_del_contracts: %s",
                    enforce_single_del_contracts ? "true" : "false");
+  ROCKS_LOG_HEADER(log,
+                   "                   Options.auto_tune_period_sec: %" PRIu64,
+                   auto_tune_period_sec);
+  ROCKS_LOG_HEADER(log, "          Options.auto_tune_max_background_jobs: %d",
+                   auto_tune_max_background_jobs);
+  ROCKS_LOG_HEADER(log,
+                   "        Options.auto_tune_max_write_buffer_size: %" PRIu64,
+                   auto_tune_max_write_buffer_size);
   ROCKS_LOG_HEADER(log, "            Options.metadata_write_temperature: %s",
                    temperature_to_string[metadata_write_temperature].c_str());
   ROCKS_LOG_HEADER(log, "            Options.wal_write_temperature: %s",
@@ -101,6 +101,10 @@ struct ImmutableDBOptions {
   CacheTier lowest_used_cache_tier;
   std::shared_ptr<CompactionService> compaction_service;
   bool enforce_single_del_contracts;
+  // add for ADOC tuner
+  uint64_t auto_tune_period_sec;
+  int auto_tune_max_background_jobs;
+  uint64_t auto_tune_max_write_buffer_size;
   uint64_t follower_refresh_catchup_period_ms;
   uint64_t follower_catchup_retry_count;
   uint64_t follower_catchup_retry_wait_ms;
@@ -77,6 +77,7 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       compaction_pri(options.compaction_pri),
       compaction_options_universal(options.compaction_options_universal),
       compaction_options_fifo(options.compaction_options_fifo),
+      compaction_options_tier(options.compaction_options_tier),  // add for tier compaction style
       max_sequential_skip_in_iterations(
           options.max_sequential_skip_in_iterations),
       memtable_factory(options.memtable_factory),
@@ -366,6 +367,24 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
       compaction_options_fifo.max_table_files_size);
   ROCKS_LOG_HEADER(log, "Options.compaction_options_fifo.allow_compaction: %d",
                    compaction_options_fifo.allow_compaction);
+  // add for tier compaction style
+  ROCKS_LOG_HEADER(log, "Options.compaction_options_tier.files_per_tier: %d",
+                   compaction_options_tier.files_per_tier);
+  for (size_t i = 0;
+       i < compaction_options_tier.files_per_tier_per_level.size(); i++) {
+    ROCKS_LOG_HEADER(log,
+                     "Options.compaction_options_tier.files_per_tier_per_level"
+                     "[%" ROCKSDB_PRIszt "]: %d",
+                     i, compaction_options_tier.files_per_tier_per_level[i]);
+  }
+  ROCKS_LOG_HEADER(log, "Options.compaction_options_tier.size_ratio: %d",
+                   compaction_options_tier.size_ratio);
+  ROCKS_LOG_HEADER(log, "Options.compaction_options_tier.lazy_leveling: %d",
+                   compaction_options_tier.lazy_leveling);
+  ROCKS_LOG_HEADER(log,
+                   "Options.compaction_options_tier.filter_index_bits_per_key: "
+                   "%d",
+                   compaction_options_tier.filter_index_bits_per_key);
   std::ostringstream collector_info;
   for (const auto& collector_factory : table_properties_collector_factories) {
     collector_info << collector_factory->ToString() << ';';
@@ -186,6 +186,12 @@ void BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.lowest_used_cache_tier = immutable_db_options.lowest_used_cache_tier;
   options.enforce_single_del_contracts =
       immutable_db_options.enforce_single_del_contracts;
+  // add for ADOC tuner
+  options.auto_tune_period_sec = immutable_db_options.auto_tune_period_sec;
+  options.auto_tune_max_background_jobs =
+      immutable_db_options.auto_tune_max_background_jobs;
+  options.auto_tune_max_write_buffer_size =
+      immutable_db_options.auto_tune_max_write_buffer_size;
   options.daily_offpeak_time_utc = mutable_db_options.daily_offpeak_time_utc;
   options.follower_refresh_catchup_period_ms =
       immutable_db_options.follower_refresh_catchup_period_ms;
@@ -269,6 +275,8 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
 
   cf_opts->compaction_options_fifo = moptions.compaction_options_fifo;
   cf_opts->compaction_options_universal = moptions.compaction_options_universal;
+  // add for tier compaction style
+  cf_opts->compaction_options_tier = moptions.compaction_options_tier;
 
   // Blob file related options
   cf_opts->enable_blob_files = moptions.enable_blob_files;
@@ -467,6 +467,9 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "lowest_used_cache_tier=kNonVolatileBlockTier;"
                              "allow_data_in_errors=false;"
                              "enforce_single_del_contracts=false;"
+                             "auto_tune_period_sec=5;"
+                             "auto_tune_max_background_jobs=16;"
+                             "auto_tune_max_write_buffer_size=536870912;"
                              "daily_offpeak_time_utc=08:30-19:00;"
                              "follower_refresh_catchup_period_ms=123;"
                              "follower_catchup_retry_count=456;"
@@ -516,6 +519,8 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
        sizeof(std::vector<int>)},
       {offsetof(struct ColumnFamilyOptions, compaction_options_fifo),
        sizeof(struct CompactionOptionsFIFO)},
+      {offsetof(struct ColumnFamilyOptions, compaction_options_tier),
+       sizeof(struct CompactionOptionsTier)},
       {offsetof(struct ColumnFamilyOptions, memtable_factory),
        sizeof(std::shared_ptr<MemTableRepFactory>)},
       {offsetof(struct ColumnFamilyOptions,
@@ -674,6 +679,9 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "compaction_options_fifo={max_table_files_size=3;allow_"
       "compaction=true;age_for_warm=0;file_temperature_age_thresholds={{"
       "temperature=kCold;age=12345}};};"
+      "compaction_options_tier={files_per_tier=6;files_per_tier_per_level="
+      "8:4;size_ratio=10;lazy_leveling=true;filter_index_bits_per_key=10;"
+      "};"
       "blob_cache=1M;"
       "memtable_protection_bytes_per_key=2;"
       "persist_user_defined_timestamps=true;"
@@ -709,6 +717,15 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       new_options->compaction_options_fifo.file_temperature_age_thresholds[0]
           .age,
       12345);
+  // Custom verification since compaction_options_tier was in
+  // kColumnFamilyOptionsExcluded
+  ASSERT_EQ(new_options->compaction_options_tier.files_per_tier, 6);
+  ASSERT_EQ(new_options->compaction_options_tier.files_per_tier_per_level,
+            std::vector<int>({8, 4}));
+  ASSERT_EQ(new_options->compaction_options_tier.size_ratio, 10);
+  ASSERT_EQ(new_options->compaction_options_tier.lazy_leveling, true);
+  ASSERT_EQ(new_options->compaction_options_tier.filter_index_bits_per_key,
+            10);
   // TODO: try to enhance ObjectLibrary to support singletons
   // ASSERT_EQ(new_options->compression_manager,
   //           GetBuiltinV2CompressionManager());
@@ -733,6 +750,8 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
        sizeof(std::vector<int>)},
       {offsetof(struct MutableCFOptions, compaction_options_fifo),
        sizeof(struct CompactionOptionsFIFO)},
+      {offsetof(struct MutableCFOptions, compaction_options_tier),
+       sizeof(struct CompactionOptionsTier)},
       {offsetof(struct MutableCFOptions, compression_manager),
        sizeof(std::shared_ptr<CompressionManager>)},
       {offsetof(struct MutableCFOptions, compression_per_level),
@@ -9,6 +9,7 @@
 
 #include "db/db_impl/db_impl.h"
 #include "db/dbformat.h"
+#include "db/tier_filter_index.h"
 #include "db/wide/wide_column_serialization.h"
 #include "db/wide/wide_columns_helper.h"
 #include "file/writable_file_writer.h"
@@ -374,6 +375,17 @@ Status SstFileWriter::Open(const std::string& file_path, Temperature temp) {
         new UserKeyTablePropertiesCollectorFactory(
             user_collector_factories[i]));
   }
+  // add for tier compaction style
+  // 和 DB 自己写出的文件一样带上 TierKeyFilter，ingest 后不用再扫一遍
+  if (r->ioptions.compaction_style == kCompactionStyleTier &&
+      r->mutable_cf_options.compaction_options_tier.filter_index_bits_per_key >
+          0 &&
+      r->internal_comparator.user_comparator()->timestamp_size() == 0) {
+    internal_tbl_prop_coll_factories.emplace_back(
+        new TierKeyFilterCollectorFactory(
+            r->mutable_cf_options.compaction_options_tier
+                .filter_index_bits_per_key));
+  }
   int unknown_level = -1;
   uint32_t cf_id;
 
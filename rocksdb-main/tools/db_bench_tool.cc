@@ -235,6 +235,9 @@ DEFINE_string(
     "\tlevelstats  -- Print the number of files and bytes per level\n"
     "\tmemstats  -- Print memtable stats\n"
     "\tsstables    -- Print sstable info\n"
+    "\ttieredcompare -- Run fillrandom and readrandom on a fresh DB under "
+    "level, universal and tier compaction style and report write, read and "
+    "space amplification of each\n"
     "\theapprofile -- Dump a heap profile (if supported by this port)\n"
     "\treplay      -- replay the trace file specified with trace_file\n"
     "\tgetmergeoperands -- Insert lots of merge records which are a list of "
@@ -256,7 +259,12 @@ DEFINE_string(
     "after fillrandom, where actual answer is batch_size");
 
 // add for tier compaction style
-DEFINE_int32(files_per_tier, 4, "Number of tier files per level");  
+DEFINE_int32(files_per_tier, 4, "Number of tier files per level");
+
+// add for tier compaction style
+DEFINE_string(tiered_compare_styles, "0,1,4",
+              "Comma-separated compaction styles (as in --compaction_style) "
+              "run by the tieredcompare benchmark");
 
 DEFINE_int64(num, 1000000, "Number of key/values to place in database");
 
@@ -3761,6 +3769,8 @@ class Benchmark {
         method = &Benchmark::Compact;
       } else if (name == "compactall") {
         CompactAll();
+      } else if (name == "tieredcompare") {
+        TieredCompare(hooks);
       } else if (name == "compact0") {
         CompactLevel(0);
       } else if (name == "compact1") {
@@ -4809,6 +4819,8 @@ class Benchmark {
         FLAGS_universal_incremental;
     options.compaction_options_universal.stop_style =
         static_cast<CompactionStopStyle>(FLAGS_universal_stop_style);
+    // add for tier compaction style
+    options.compaction_options_tier.files_per_tier = FLAGS_files_per_tier;
     if (FLAGS_thread_status_per_interval > 0) {
       options.enable_thread_tracking = true;
     }
@@ -8506,6 +8518,141 @@ class Benchmark {
     }
   }
 
+  // add for tier compaction style
+  struct AmplificationReport {
+    std::string style;
+    double write_amp = 0;
+    // Data blocks touched per Get, -1 without --statistics
+    double read_amp = -1;
+    double space_amp = 0;
+    uint64_t sst_bytes = 0;
+  };
+
+  static const char* CompactionStyleName(CompactionStyle style) {
+    switch (style) {
+      case kCompactionStyleLevel:
+        return "level";
+      case kCompactionStyleUniversal:
+        return "universal";
+      case kCompactionStyleFIFO:
+        return "fifo";
+      case kCompactionStyleNone:
+        return "none";
+      case kCompactionStyleTier:
+        return "tier";
+    }
+    return "unknown";
+  }
+
+  AmplificationReport ReportAmplification(CompactionStyle style,
+                                          uint64_t keys_read) {
+    AmplificationReport report;
+    report.style = CompactionStyleName(style);
+    DB* db = db_.db;
+
+    std::map<std::string, std::string> cf_stats;
+    if (db->GetMapProperty(DB::Properties::kCFStats, &cf_stats)) {
+      auto it = cf_stats.find("compaction.Sum.WriteAmp");
+      if (it != cf_stats.end()) {
+        report.write_amp = std::stod(it->second);
+      }
+    }
+
+    uint64_t live_data_size = 0;
+    db->GetIntProperty(DB::Properties::kLiveSstFilesSize, &report.sst_bytes);
+    db->GetIntProperty(DB::Properties::kEstimateLiveDataSize, &live_data_size);
+    if (live_data_size > 0) {
+      report.space_amp = static_cast<double>(report.sst_bytes) /
+                         static_cast<double>(live_data_size);
+    }
+
+    if (dbstats && keys_read > 0) {
+      uint64_t data_blocks =
+          dbstats->getTickerCount(BLOCK_CACHE_DATA_HIT) +
+          dbstats->getTickerCount(BLOCK_CACHE_DATA_MISS);
+      report.read_amp =
+          static_cast<double>(data_blocks) / static_cast<double>(keys_read);
+    }
+    return report;
+  }
+
+  // Runs the same fillrandom + readrandom load on a fresh DB for every style
+  // in --tiered_compare_styles, and prints write amplification (compaction
+  // stats of InternalStats), data blocks read per Get (statistics tickers) and
+  // space amplification (live SST size over estimated live data size).
+  void TieredCompare(ToolHooks& hooks) {
+    if (FLAGS_use_existing_db) {
+      fprintf(stdout, "%-12s : skipped (--use_existing_db is true)\n",
+              "tieredcompare");
+      return;
+    }
+    if (FLAGS_num_multi_db > 1) {
+      fprintf(stderr, "tieredcompare does not support --num_multi_db\n");
+      ErrorExit();
+    }
+
+    const CompactionStyle saved_style = FLAGS_compaction_style_e;
+    std::vector<AmplificationReport> reports;
+    std::stringstream styles_stream(FLAGS_tiered_compare_styles);
+    std::string style_str;
+    while (std::getline(styles_stream, style_str, ',')) {
+      if (style_str.empty()) {
+        continue;
+      }
+      const CompactionStyle style =
+          static_cast<CompactionStyle>(std::stoi(style_str));
+      fprintf(stdout, "tieredcompare: compaction_style=%s\n",
+              CompactionStyleName(style));
+
+      if (db_.db != nullptr) {
+        db_.DeleteDBs();
+      }
+      DestroyDB(FLAGS_db, open_options_);
+      FLAGS_compaction_style_e = style;
+      Open(&open_options_, hooks);
+
+      num_ = FLAGS_num;
+      writes_ = (FLAGS_writes < 0 ? FLAGS_num : FLAGS_writes);
+      RunBenchmark(FLAGS_threads, "fillrandom", &Benchmark::WriteRandom)
+          .Report("fillrandom");
+      Status s = db_.db->Flush(FlushOptions());
+      if (s.ok()) {
+        s = db_.db->WaitForCompact(WaitForCompactOptions());
+      }
+      if (!s.ok()) {
+        fprintf(stderr, "tieredcompare: %s\n", s.ToString().c_str());
+        ErrorExit();
+      }
+
+      if (dbstats) {
+        dbstats->Reset().PermitUncheckedError();
+      }
+      reads_ = (FLAGS_reads < 0 ? FLAGS_num : FLAGS_reads);
+      Stats read_stats =
+          RunBenchmark(FLAGS_threads, "readrandom", &Benchmark::ReadRandom);
+      read_stats.Report("readrandom");
+      reports.push_back(ReportAmplification(
+          style, dbstats ? dbstats->getTickerCount(NUMBER_KEYS_READ) : 0));
+    }
+    FLAGS_compaction_style_e = saved_style;
+
+    fprintf(stdout, "\n%-10s %10s %12s %10s %14s\n", "style", "W-Amp",
+            "Blocks/Get", "S-Amp", "SST(bytes)");
+    for (const auto& r : reports) {
+      if (r.read_amp < 0) {
+        fprintf(stdout, "%-10s %10.2f %12s %10.2f %14" PRIu64 "\n",
+                r.style.c_str(), r.write_amp, "n/a", r.space_amp, r.sst_bytes);
+      } else {
+        fprintf(stdout, "%-10s %10.2f %12.2f %10.2f %14" PRIu64 "\n",
+                r.style.c_str(), r.write_amp, r.read_amp, r.space_amp,
+                r.sst_bytes);
+      }
+    }
+    if (!dbstats) {
+      fprintf(stdout, "(Blocks/Get needs --statistics)\n");
+    }
+  }
+
   void WaitForCompactionHelper(DBWithColumnFamilies& db) {
     fprintf(stdout, "waitforcompaction(%s): started\n",
             db.db->GetName().c_str());